@@ -3,13 +3,18 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <memory>
 #include <sstream>
 #include <string>
 
 #include "Nester/Nester.hpp"
 #include "Nester/DXFWriter.hpp"
+#include "Nester/Geometry.hpp"
 #include "Nester/SVGWriter.hpp"
+#include "Nester/Nurbs.hpp"
+#include "Nester/Stitching.hpp"
+#include "Nester/Units.hpp"
 
 using namespace adsk::core;
 using namespace adsk::fusion;
@@ -23,20 +28,35 @@ const char* BUTTON_NAME = "FlatpackButton";
 const char* PANEL_TO_USE = "MakePanel";
 const char* COMMAND_ID = "FlatpackCmdId";
 const char* FACES_INPUT = "facesSelection";
-//const char* BIN_INPUT = "binSelection";
+const char* BIN_INPUT = "binSelection";
 const char* TOLERANCE_INPUT = "toleranceInput";
+const char* CURVES_AS_LINES_INPUT = "curvesAsLinesInput";
+const char* STRATEGY_INPUT = "strategyInput";
+const char* OPTIMIZATION_TIME_INPUT = "optimizationTimeInput";
+const char* RANDOM_SEED_INPUT = "randomSeedInput";
+const char* STOCK_INPUT = "stockInput";
+const char* CHECK_LAYOUT_INPUT = "checkLayoutInput";
 const char* OUTPUT_FILE_TEXT_BOX_INPUT = "outputFileTextBoxInput";
 const char* OUTPUT_FILE_INPUT = "fileInput";
 const char* ATTRIBUTE_GROUP = "MH-Flatpack";
 const char* ATTRIBUTE_SELECTED_FACES = "ExportedFace";
-//const char* ATTRIBUTE_BIN = "Bin";
+const char* ATTRIBUTE_BIN = "Bin";
 const char* ATTRIBUTE_TOLERANCE = "Tolerance";
+const char* ATTRIBUTE_CURVES_AS_LINES = "CurvesAsLines";
+const char* ATTRIBUTE_STRATEGY = "Strategy";
+const char* ATTRIBUTE_OPTIMIZATION_TIME = "OptimizationTime";
+const char* ATTRIBUTE_RANDOM_SEED = "RandomSeed";
+const char* ATTRIBUTE_STOCK = "Stock";
+const char* ATTRIBUTE_CHECK_LAYOUT = "CheckLayout";
 const char* ATTRIBUTE_OUTPUT_FILE = "OutputFile";
+// the outlines the parts are nested by may be this many conversion tolerances coarser than the output
+const double NESTING_TOLERANCE_FACTOR = 5.0;
+const char* STRATEGY_NAMES[] = { "Bottom-left (genetic order)", "Overlap annealing", "Raster preview (fast)", "Shelves of bounding boxes (fastest)" };
 
 template<typename T>
 Ptr<T> getSelection(Ptr<Selection> selection) {
 	Ptr<T> result;
-	if (selection->entity()->objectType() == BRepFace::classType()) {
+	if (selection->entity()->objectType() == T::classType()) {
 		result = selection->entity();
 	}
 	return result;
@@ -54,6 +74,229 @@ bool hasEndingCaseInsensitive(std::string const &fullString, std::string const &
 	}
 }
 
+// reads stock sizes in mm like "2440x1220x3; 1000x500", a missing quantity means any number of sheets
+bool parseStockSheets(const string& text, vector<StockSheet>& stock) {
+	stringstream entries(text);
+	string entry;
+	while (getline(entries, entry, ';')) {
+		if (all_of(entry.begin(), entry.end(), [](char c) { return isspace((unsigned char)c) != 0; })) {
+			continue;
+		}
+		replace(entry.begin(), entry.end(), 'x', ' ');
+		replace(entry.begin(), entry.end(), 'X', ' ');
+		stringstream fields(entry);
+		StockSheet sheet;
+		sheet.quantity = -1;
+		if (!(fields >> sheet.width >> sheet.height) || sheet.width <= 0.0 || sheet.height <= 0.0) {
+			return false;
+		}
+		int quantity;
+		if (fields >> quantity) {
+			string rest;
+			if (quantity <= 0 || fields >> rest) {
+				return false;
+			}
+			sheet.quantity = quantity;
+		}
+		else if (!fields.eof()) {
+			return false;
+		}
+		sheet.width /= mm;
+		sheet.height /= mm;
+		stock.push_back(sheet);
+	}
+	return true;
+}
+
+// "parts.dxf" becomes "parts-1.dxf" for the first sheet
+string sheetFilename(const string& filename, size_t sheet) {
+	size_t dot = filename.find_last_of('.');
+	size_t slash = filename.find_last_of("/\\");
+	if (dot == string::npos || (slash != string::npos && dot < slash)) {
+		dot = filename.length();
+	}
+	return filename.substr(0, dot) + "-" + to_string(sheet + 1) + filename.substr(dot);
+}
+
+// the stitched strokes as one loop: arcs and splines stay as they are, the other strokes become lines which join up exactly
+shared_ptr<NesterLoop> stitchedLoop(const vector<polygon_t>& strokes, const vector<shared_ptr<NesterArc> >& arcs,
+	const vector<shared_ptr<NesterNurbs> >& splines, const StitchedRing& stitched, double tolerance, const Arena_p& arena) {
+	shared_ptr<NesterLoop> nesterLoop = makeShared<NesterLoop>(arena, arena);
+	auto addLine = [&](point_t from, point_t to) {
+		if (glm::distance(from, to) > 0.0) {
+			nesterLoop->addLine(from, to);
+		}
+	};
+	auto arcOf = [&](size_t k) -> shared_ptr<NesterArc> {
+		const StitchedStroke& s = stitched.order[k % stitched.order.size()];
+		if (s.stroke >= arcs.size() || !arcs[s.stroke]) {
+			return nullptr;
+		}
+		return s.reversed ? arcs[s.stroke]->reversed() : arcs[s.stroke];
+	};
+	auto splineOf = [&](size_t k) -> shared_ptr<NesterNurbs> {
+		const StitchedStroke& s = stitched.order[k % stitched.order.size()];
+		if (s.stroke >= splines.size() || !splines[s.stroke]) {
+			return nullptr;
+		}
+		return s.reversed ? splines[s.stroke]->reversed() : splines[s.stroke];
+	};
+	// where the piece starts when it is a curve, the lines before it end there
+	auto curveStart = [&](size_t k, point_t& start) {
+		if (shared_ptr<NesterArc> arc = arcOf(k)) {
+			start = arc->getStartPoint();
+			return true;
+		}
+		if (shared_ptr<NesterNurbs> spline = splineOf(k)) {
+			start = spline->getStartPoint();
+			return true;
+		}
+		return false;
+	};
+	if (stitched.order.empty()) {
+		return nesterLoop;
+	}
+
+	// each piece starts where the one before ended, unless there is a gap
+	const StitchedStroke& lastStroke = stitched.order.back();
+	point_t last = lastStroke.reversed ? strokes[lastStroke.stroke].front() : strokes[lastStroke.stroke].back();
+	for (size_t k = 0; k < stitched.order.size(); k++) {
+		shared_ptr<NesterArc> arc = arcOf(k);
+		if (arc) {
+			if (glm::distance(last, arc->getStartPoint()) > tolerance) {
+				addLine(last, arc->getStartPoint());
+			}
+			nesterLoop->addArc(*arc);
+			last = arc->getEndPoint();
+			continue;
+		}
+		shared_ptr<NesterNurbs> spline = splineOf(k);
+		if (spline) {
+			if (glm::distance(last, spline->getStartPoint()) > tolerance) {
+				addLine(last, spline->getStartPoint());
+			}
+			nesterLoop->addNurbs(spline);
+			last = spline->getEndPoint();
+			continue;
+		}
+
+		polygon_t stroke = strokes[stitched.order[k].stroke];
+		if (stitched.order[k].reversed) {
+			reverse(stroke.begin(), stroke.end());
+		}
+		point_t next;
+		if (curveStart(k + 1, next) && glm::distance(stroke.back(), next) <= tolerance) {
+			stroke.back() = next;
+		}
+		if (glm::distance(last, stroke.front()) > tolerance) {
+			addLine(last, stroke.front());
+			last = stroke.front();
+		}
+		for (size_t i = 1; i < stroke.size(); i++) {
+			addLine(last, stroke[i]);
+			last = stroke[i];
+		}
+	}
+	return nesterLoop;
+}
+
+// arcs are kept as arcs, running the same way as the curve
+shared_ptr<NesterArc> arcEdge(Ptr<Curve2D> curve, double tolerance, const Arena_p& arena) {
+	Ptr<Arc2D> arc = curve;
+	if (!arc) {
+		return nullptr;
+	}
+	point_t center(arc->center()->x(), arc->center()->y());
+	point_t start(arc->startPoint()->x(), arc->startPoint()->y());
+	point_t end(arc->endPoint()->x(), arc->endPoint()->y());
+	double from = glm::degrees(atan2(start.y - center.y, start.x - center.x));
+	double sweep = fmod(glm::degrees(atan2(end.y - center.y, end.x - center.x)) - from, 360.0);
+	if (arc->isClockwise()) {
+		sweep = sweep < 0.0 ? sweep : sweep - 360.0;
+	}
+	else {
+		sweep = sweep > 0.0 ? sweep : sweep + 360.0;
+	}
+
+	shared_ptr<NesterArc> nesterArc = makeShared<NesterArc>(arena);
+	nesterArc->setCenter(center);
+	nesterArc->setRadius(arc->radius());
+	nesterArc->setAngles(from, sweep);
+	nesterArc->setTolerance(tolerance);
+	return nesterArc;
+}
+
+// splines are kept as splines, except periodic ones, and tessellated by the nester when their points are needed
+shared_ptr<NesterNurbs> nurbsEdge(Ptr<Curve2D> curve, double tolerance, const Arena_p& arena) {
+	Ptr<NurbsCurve2D> nurbs = curve;
+	if (!nurbs || nurbs->isPeriodic()) {
+		return nullptr;
+	}
+	vector<Ptr<Point2D> > controlPoints;
+	int degree;
+	bool isRational;
+	bool isPeriodic;
+	NurbsCurve spline;
+	if (!nurbs->getData(controlPoints, degree, spline.knots, isRational, spline.weights, isPeriodic)) {
+		return nullptr;
+	}
+	for (Ptr<Point2D> point : controlPoints) {
+		spline.controlPoints.push_back(point_t(point->x(), point->y()));
+	}
+	if (!isRational) {
+		spline.weights.clear();
+	}
+	if (spline.degree() != degree || !spline.isValid()) {
+		return nullptr;
+	}
+
+	shared_ptr<NesterNurbs> nesterNurbs = makeShared<NesterNurbs>(arena);
+	for (size_t k = 0; k < spline.controlPoints.size(); k++) {
+		nesterNurbs->addControlPoint(spline.controlPoints[k].x, spline.controlPoints[k].y, spline.weights.empty() ? 1.0 : spline.weights[k]);
+	}
+	nesterNurbs->addKnots(spline.knots);
+	nesterNurbs->setTolerance(tolerance);
+	return nesterNurbs;
+}
+
+// the outline of a sketch profile and its inner loops as a part, with curves turned into line segments
+shared_ptr<NesterPart> profileToPart(Ptr<Profile> profile, double tolerance, vector<StitchGap>& gaps, const Arena_p& arena) {
+	shared_ptr<NesterPart> part = makeShared<NesterPart>(arena);
+	for (Ptr<ProfileLoop> loop : profile->profileLoops()) {
+		vector<polygon_t> strokes;
+		for (Ptr<ProfileCurve> profileCurve : loop->profileCurves()) {
+			Ptr<Curve3D> curve = profileCurve->geometry();
+			Ptr<CurveEvaluator3D> curveEvaluator = curve ? curve->evaluator() : nullptr;
+			double startParameter;
+			double endParameter;
+			vector<Ptr<Point3D> > vertexCoordinates;
+			if (!curveEvaluator || !curveEvaluator->getParameterExtents(startParameter, endParameter) ||
+				!curveEvaluator->getStrokes(startParameter, endParameter, tolerance, vertexCoordinates) || vertexCoordinates.empty()) {
+				return nullptr;
+			}
+
+			polygon_t stroke;
+			for (Ptr<Point3D> point : vertexCoordinates) {
+				stroke.push_back(point_t(point->x(), point->y()));
+			}
+			strokes.push_back(stroke);
+		}
+
+		// the curves of a loop follow each other, but each may run either way
+		StitchedRing stitched = stitchStrokes(strokes, tolerance);
+		gaps.insert(gaps.end(), stitched.gaps.begin(), stitched.gaps.end());
+		shared_ptr<NesterLoop> nesterLoop = stitchedLoop(strokes, vector<shared_ptr<NesterArc> >(), vector<shared_ptr<NesterNurbs> >(), stitched,
+			tolerance, arena);
+		if (loop->isOuter()) {
+			part->setOuterRing(nesterLoop);
+		}
+		else {
+			part->addInnerRing(nesterLoop);
+		}
+	}
+	return part;
+}
+
 // CommandExecuted event handler.
 class OnExecuteEventHander : public adsk::core::CommandEventHandler
 {
@@ -63,6 +306,8 @@ public:
 		Ptr<Command> cmd = eventArgs->command();
 
 		if (cmd) {
+			// all the geometry of the job, given back in one go once the last part is gone
+			Arena_p arena = make_shared<Arena>();
 			Nester nester;
 
 			Ptr<Design> design = app->activeProduct();
@@ -74,8 +319,14 @@ public:
 			Ptr<CommandInputs> inputs = cmd->commandInputs();
 
 			Ptr<SelectionCommandInput> selectionInput = inputs->itemById(FACES_INPUT);
-			//Ptr<SelectionCommandInput> binInput = inputs->itemById(BIN_INPUT);
+			Ptr<SelectionCommandInput> binInput = inputs->itemById(BIN_INPUT);
 			Ptr<ValueCommandInput> toleranceInput = inputs->itemById(TOLERANCE_INPUT);
+			Ptr<BoolValueCommandInput> curvesAsLinesInput = inputs->itemById(CURVES_AS_LINES_INPUT);
+			Ptr<DropDownCommandInput> strategyInput = inputs->itemById(STRATEGY_INPUT);
+			Ptr<IntegerSpinnerCommandInput> optimizationTimeInput = inputs->itemById(OPTIMIZATION_TIME_INPUT);
+			Ptr<IntegerSpinnerCommandInput> randomSeedInput = inputs->itemById(RANDOM_SEED_INPUT);
+			Ptr<StringValueCommandInput> stockInput = inputs->itemById(STOCK_INPUT);
+			Ptr<BoolValueCommandInput> checkLayoutInput = inputs->itemById(CHECK_LAYOUT_INPUT);
 			Ptr<TextBoxCommandInput> filenameInput = inputs->itemById(OUTPUT_FILE_TEXT_BOX_INPUT);
 
 			// Check that a valid tolerance was entered.
@@ -89,6 +340,13 @@ public:
 			}
 			double tolerance = toleranceInput->value();
 
+			vector<StockSheet> stock;
+			if (!parseStockSheets(stockInput->value(), stock)) {
+				ui->messageBox(stockInput->value() + " is not a valid list of stock sheets.", "Invalid entry",
+					OKButtonType, CriticalIconType);
+				return;
+			}
+
 			if (selectionInput == nullptr || !selectionInput->isValid()) {
 				// to enter a value again.
 				ui->messageBox("Face selection is not valid.", "Invalid entry",
@@ -119,25 +377,49 @@ public:
 				}
 				faces[i] = face;
 			}
+			vector<Ptr<Profile> > profiles(binInput->selectionCount());
+			for (size_t i = 0; i < binInput->selectionCount(); i++) {
+				Ptr<Profile> profile = binInput->selection(i)->entity();
+				if (!profile) {
+					ui->messageBox("Selection is not a profile!");
+					return;
+				}
+				profiles[i] = profile;
+			}
 
 			// iterate over the selected faces
+			vector<StitchGap> gaps;
 			for(Ptr<BRepFace> face : faces) {
 				face->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_SELECTED_FACES, "1");
 
 
-				shared_ptr<NesterPart> part = make_shared<NesterPart>();
+				shared_ptr<NesterPart> part = makeShared<NesterPart>(arena);
 				nester.addPart(part);
 
 				for (Ptr<BRepLoop> loop : face->loops()) {
-					shared_ptr<NesterLoop> nesterLoop = make_shared<NesterLoop>();
-
-					if (loop->isOuter()) {
-						part->setOuterRing(nesterLoop);
+					// a hole drilled through is one circle
+					Ptr<Circle2D> circle;
+					if (loop->coEdges()->count() == 1 && loop->coEdges()->item(0)) {
+						circle = loop->coEdges()->item(0)->geometry();
 					}
-					else {
-						part->addInnerRing(nesterLoop);
+					if (circle) {
+						shared_ptr<NesterCircle> nesterCircle = makeShared<NesterCircle>(arena);
+						nesterCircle->setCenter(point_t(circle->center()->x(), circle->center()->y()));
+						nesterCircle->setRadius(circle->radius());
+						nesterCircle->setTolerance(tolerance / 2.0);
+						nesterCircle->simplify(tolerance / 2.0);
+						if (loop->isOuter()) {
+							part->setOuterRing(nesterCircle);
+						}
+						else {
+							part->addInnerRing(nesterCircle);
+						}
+						continue;
 					}
 
+					vector<polygon_t> strokes;
+					vector<shared_ptr<NesterArc> > arcs;
+					vector<shared_ptr<NesterNurbs> > splines;
 					for (Ptr<BRepCoEdge> edge : loop->coEdges()) {
 						if (!edge) {
 							ui->messageBox("No edge!");
@@ -145,6 +427,21 @@ public:
 						}
 
 						Ptr<Curve2D> curve = edge->geometry();
+						polygon_t stroke;
+						// half the tolerance for the strokes, the other half for simplifying them
+						shared_ptr<NesterArc> arc = arcEdge(curve, tolerance / 2.0, arena);
+						arcs.push_back(arc);
+						shared_ptr<NesterNurbs> spline = arc ? nullptr : nurbsEdge(curve, tolerance / 2.0, arena);
+						splines.push_back(spline);
+						if (arc) {
+							strokes.push_back(arcPoints(arc->getCenter(), arc->getRadius(), arc->getStartAngle(), arc->getSweep(), tolerance / 2.0));
+							continue;
+						}
+						// only the ends are stitched, the spline is tessellated later on the nester's threads
+						if (spline) {
+							strokes.push_back({ spline->getStartPoint(), spline->getEndPoint() });
+							continue;
+						}
 						Ptr<CurveEvaluator2D> curveEvaluator = curve->evaluator();
 
 						// get range of curve parameters
@@ -157,76 +454,126 @@ public:
 						}
 
 						vector<Ptr<Point2D> > vertexCoordinates;
-
-						ok = curveEvaluator->getStrokes(startParameter, endParameter, tolerance, vertexCoordinates);
+						ok = curveEvaluator->getStrokes(startParameter, endParameter, tolerance / 2.0, vertexCoordinates);
 
 						if (!ok) {
 							ui->messageBox("Failed to get approximation of curve!");
 							return;
 						}
 
-						Ptr<Point2D> previousPoint;
 						for (Ptr<Point2D> point : vertexCoordinates) {
-							if (previousPoint != nullptr) {
-								shared_ptr<NesterLine> line = make_shared<NesterLine>();
-								
-								line->setStartPoint(point_t(previousPoint->x(), previousPoint->y()));
-								line->setEndPoint(point_t(point->x(), point->y()));
-
-								nesterLoop->addEdge(line);
-							}
-							previousPoint = point;
+							stroke.push_back(point_t(point->x(), point->y()));
 						}
+						strokes.push_back(stroke);
+					}
 
+					// the coedges come in any order and direction, with their shared ends repeated
+					StitchedRing stitched = stitchStrokes(strokes, tolerance / 2.0);
+					gaps.insert(gaps.end(), stitched.gaps.begin(), stitched.gaps.end());
+					shared_ptr<NesterLoop> nesterLoop = stitchedLoop(strokes, arcs, splines, stitched, tolerance / 2.0, arena);
+					nesterLoop->simplify(tolerance / 2.0);
+					if (loop->isOuter()) {
+						part->setOuterRing(nesterLoop);
+					}
+					else {
+						part->addInnerRing(nesterLoop);
 					}
 				}
 			}
 
-			// bin
-			/*
-			if (binInput->selectionCount() == 1) {
-
-			ui->messageBox(binInput->selection(0)->entity()->classType());
-			*/
-			/*
-			if (!face) {
-			ui->messageBox("Selection is not a face!");
-			return;
-			}
-			
-
+			// bins: each selected profile is one piece of stock, used before the stock sheet sizes
 			vector<Ptr<Attribute> > selectedBins = design->findAttributes(ATTRIBUTE_GROUP, ATTRIBUTE_BIN);
 			for (Ptr<Attribute> a : selectedBins) {
-			if (a->parent() != nullptr) {
-			a->deleteMe();
+				if (a->parent() != nullptr) {
+					a->deleteMe();
+				}
 			}
+			for (Ptr<Profile> profile : profiles) {
+				shared_ptr<NesterPart> bin = profileToPart(profile, tolerance, gaps, arena);
+				if (!bin) {
+					ui->messageBox("Failed to get approximation of the bin profile!");
+					return;
+				}
+				profile->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_BIN, "1");
+				nester.addStockProfile(bin, 1);
 			}
 
-
-			Ptr<SketchProfile>
-			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_BIN, "1");
-			*/
-			/*
+			// loops that did not close were joined with straight lines, the cut may be off there
+			if (!gaps.empty()) {
+				double widest = 0.0;
+				for (const StitchGap& gap : gaps) {
+					widest = max(widest, glm::distance(gap.from, gap.to));
+				}
+				ui->messageBox(to_string(gaps.size()) + " gaps in the outlines were closed with straight lines, the widest is " +
+					to_string(widest * mm) + " mm.", "Open outlines",
+					OKButtonType, WarningIconType);
 			}
-			*/
 
 			// remember the tolerance setting for next time
 			// we have to do this after the selection above
 			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_TOLERANCE, toleranceInput->expression());
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_CURVES_AS_LINES, curvesAsLinesInput->value() ? "1" : "0");
+			NestingStrategy strategy = STRATEGY_BOTTOM_LEFT;
+			for (int i = STRATEGY_BOTTOM_LEFT; i <= STRATEGY_SHELF; i++) {
+				if (strategyInput->selectedItem() != nullptr && strategyInput->selectedItem()->name() == STRATEGY_NAMES[i]) {
+					strategy = (NestingStrategy)i;
+				}
+			}
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_STRATEGY, to_string(strategy));
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_OPTIMIZATION_TIME, to_string(optimizationTimeInput->value()));
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_RANDOM_SEED, to_string(randomSeedInput->value()));
+			nester.setStrategy(strategy);
+			nester.setNestingTolerance(NESTING_TOLERANCE_FACTOR * tolerance);
+			nester.setSearch(optimizationTimeInput->value(), (unsigned)randomSeedInput->value());
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_STOCK, stockInput->value());
+			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_CHECK_LAYOUT, checkLayoutInput->value() ? "1" : "0");
+			for (const StockSheet& sheet : stock) {
+				nester.addStockSheet(sheet.width, sheet.height, sheet.quantity);
+			}
 
 			// write output files
 			string outputFilename = filenameInput->text();
 			design->attributes()->add(ATTRIBUTE_GROUP, ATTRIBUTE_OUTPUT_FILE, outputFilename);
 
-			shared_ptr<FileWriter> writer;
-			if (hasEndingCaseInsensitive(outputFilename, ".svg")) {
-				writer = make_shared<SVGWriter>(outputFilename);
+			bool curvesAsLines = curvesAsLinesInput->value();
+			auto openWriter = [curvesAsLines, tolerance](const string& filename) -> shared_ptr<FileWriter> {
+				shared_ptr<FileWriter> writer;
+				if (hasEndingCaseInsensitive(filename, ".svg")) {
+					writer = make_shared<SVGWriter>(filename);
+				}
+				else {
+					writer = make_shared<DXFWriter>(filename);
+				}
+				if (curvesAsLines) {
+					return make_shared<SegmentWriter>(writer, tolerance);
+				}
+				return writer;
+			};
+
+			nester.run();
+			// the sheet is too dear to cut a layout with overlapping parts unknowingly
+			if (checkLayoutInput->value()) {
+				vector<LayoutViolation> violations = nester.verify();
+				if (!violations.empty() && ui->messageBox(to_string(violations.size()) + " pairs of parts overlap in the layout. Write it anyway?",
+					"Layout check", YesNoButtonType, WarningIconType) != DialogYes) {
+					return;
+				}
+			}
+			// parts which fit on no stock sheet are missing from the files, they have to be cut from something else
+			size_t unplaced = nester.getUnplaced().size();
+			if (unplaced > 0) {
+				ui->messageBox(to_string(unplaced) + " parts could not be placed and were left out of the layout.", "Parts left over",
+					OKButtonType, WarningIconType);
+			}
+			if (stock.empty() && profiles.empty()) {
+				nester.write(openWriter(outputFilename));
 			}
 			else {
-				writer = make_shared<DXFWriter>(outputFilename);
+				// one file per sheet
+				for (size_t sheet = 0; sheet < nester.getSheets().size(); sheet++) {
+					nester.writeSheet(openWriter(sheetFilename(outputFilename, sheet)), sheet);
+				}
 			}
-			
-			nester.write(writer);
 		}
 	}
 };
@@ -242,8 +589,8 @@ public:
 			return;
 
 		Ptr<SelectionCommandInput> selectionInput = inputs->itemById(FACES_INPUT);
-		//Ptr<SelectionCommandInput> binInput = inputs->itemById(BIN_INPUT);
 		Ptr<ValueCommandInput> toleranceInput = inputs->itemById(TOLERANCE_INPUT);
+		Ptr<StringValueCommandInput> stockInput = inputs->itemById(STOCK_INPUT);
 		Ptr<TextBoxCommandInput> filenameInput = inputs->itemById(OUTPUT_FILE_TEXT_BOX_INPUT);
 
 		if (selectionInput->selectionCount() == 0) {
@@ -254,6 +601,11 @@ public:
 			eventArgs->areInputsValid(false);
 		}
 
+		vector<StockSheet> stock;
+		if (!parseStockSheets(stockInput->value(), stock)) {
+			eventArgs->areInputsValid(false);
+		}
+
 		if (filenameInput->text().length() <= 0) {
 			eventArgs->areInputsValid(false);
 		}
@@ -328,8 +680,14 @@ public:
 			Ptr<CommandInputs> inputs = cmd->commandInputs();
 
 			Ptr<SelectionCommandInput> selectionInput = inputs->itemById(FACES_INPUT);
-			//Ptr<SelectionCommandInput> binInput = inputs->itemById(BIN_INPUT);
+			Ptr<SelectionCommandInput> binInput = inputs->itemById(BIN_INPUT);
 			Ptr<ValueCommandInput> toleranceInput = inputs->itemById(TOLERANCE_INPUT);
+			Ptr<BoolValueCommandInput> curvesAsLinesInput = inputs->itemById(CURVES_AS_LINES_INPUT);
+			Ptr<DropDownCommandInput> strategyInput = inputs->itemById(STRATEGY_INPUT);
+			Ptr<IntegerSpinnerCommandInput> optimizationTimeInput = inputs->itemById(OPTIMIZATION_TIME_INPUT);
+			Ptr<IntegerSpinnerCommandInput> randomSeedInput = inputs->itemById(RANDOM_SEED_INPUT);
+			Ptr<StringValueCommandInput> stockInput = inputs->itemById(STOCK_INPUT);
+			Ptr<BoolValueCommandInput> checkLayoutInput = inputs->itemById(CHECK_LAYOUT_INPUT);
 			Ptr<TextBoxCommandInput> filenameInput = inputs->itemById(OUTPUT_FILE_TEXT_BOX_INPUT);
 
 			// find already selected faces
@@ -340,20 +698,51 @@ public:
 				}
 			}
 
-			/*
-			vector<Ptr<Attribute> > selectedBin = design->findAttributes(ATTRIBUTE_GROUP, ATTRIBUTE_BIN);
-			for (Ptr<Attribute> a : selectedBin) {
+			vector<Ptr<Attribute> > selectedBins = design->findAttributes(ATTRIBUTE_GROUP, ATTRIBUTE_BIN);
+			for (Ptr<Attribute> a : selectedBins) {
 				if (a->parent() != nullptr) {
 					binInput->addSelection(a->parent());
-					break;
 				}
 			}
-			*/
+
 			Ptr<Attribute> toleranceAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_TOLERANCE);
 			if (toleranceAttribute != nullptr) {
 				toleranceInput->expression(toleranceAttribute->value());
 			}
 
+			Ptr<Attribute> curvesAsLinesAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_CURVES_AS_LINES);
+			if (curvesAsLinesAttribute != nullptr) {
+				curvesAsLinesInput->value(curvesAsLinesAttribute->value() == "1");
+			}
+
+			Ptr<Attribute> strategyAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_STRATEGY);
+			if (strategyAttribute != nullptr) {
+				int strategy = stoi(strategyAttribute->value());
+				if (strategy >= 0 && strategy < (int)strategyInput->listItems()->count()) {
+					strategyInput->listItems()->item(strategy)->isSelected(true);
+				}
+			}
+
+			Ptr<Attribute> optimizationTimeAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_OPTIMIZATION_TIME);
+			if (optimizationTimeAttribute != nullptr) {
+				optimizationTimeInput->value(stoi(optimizationTimeAttribute->value()));
+			}
+
+			Ptr<Attribute> randomSeedAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_RANDOM_SEED);
+			if (randomSeedAttribute != nullptr) {
+				randomSeedInput->value(stoi(randomSeedAttribute->value()));
+			}
+
+			Ptr<Attribute> stockAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_STOCK);
+			if (stockAttribute != nullptr) {
+				stockInput->value(stockAttribute->value());
+			}
+
+			Ptr<Attribute> checkLayoutAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_CHECK_LAYOUT);
+			if (checkLayoutAttribute != nullptr) {
+				checkLayoutInput->value(checkLayoutAttribute->value() == "1");
+			}
+
 			Ptr<Attribute> filenameAttribute = design->attributes()->itemByName(ATTRIBUTE_GROUP, ATTRIBUTE_OUTPUT_FILE);
 			if (filenameAttribute != nullptr) {
 				filenameInput->text(filenameAttribute->value());
@@ -445,26 +834,74 @@ public:
 				facesSelectionInput->tooltip("The faces to be exported.");
 				facesSelectionInput->tooltipDescription("The selected faces have to be planar.");
 
-				/*
 				Ptr<SelectionCommandInput> binSelectionInput = inputs->addSelectionInput(BIN_INPUT, "Bin", "Sketch lines forming the outline of the stock material to fit the parts into.");
 				if (!binSelectionInput)
 					return;
 				binSelectionInput->addSelectionFilter("Profiles");
-				binSelectionInput->setSelectionLimits(0, 1);
-				binSelectionInput->tooltip("Sketch profile describing the bin for the nesting process.");
-				binSelectionInput->tooltipDescription("The nesting process tries to fit parts into the bounds of the material to be cut to produce the parts. Select a sketch profile that "
-					"describes the size and shape of the material that the parts should be cut from. If a clearance to the edge of the material is wanted, draw this profile a little smaller.");
-				//binSelectionInput->isVisible(false);
-				*/
+				binSelectionInput->setSelectionLimits(0);
+				binSelectionInput->tooltip("Sketch profiles describing the bins for the nesting process.");
+				binSelectionInput->tooltipDescription("The nesting process tries to fit parts into the bounds of the material to be cut to produce the parts. Select sketch profiles that "
+					"describe the size and shape of offcuts that the parts should be cut from. Holes in a profile are defects which stay free. If a clearance to the edge of the "
+					"material is wanted, draw this profile a little smaller. The profiles are filled with the bottom-left strategy before any stock sheets.");
 
 				Ptr<ValueCommandInput> toleranceInput = inputs->addValueInput(TOLERANCE_INPUT, "Conversion tolerance", "mm", ValueInput::createByReal(0.01));
 				if (!toleranceInput)
 					return;
 				toleranceInput->tooltip("Accuracy of conversion to line segments.");
-				toleranceInput->tooltipDescription("During the export process, the circles, arcs, ellipses, and splines are exported as straight line segments. This setting specifies the "
+				toleranceInput->tooltipDescription("During the export process, ellipses and splines are exported as straight line segments, and so are circles "
+					"and arcs when curves are output as line segments. Otherwise those are written as true circles and arcs. This setting specifies the "
 					"maximum distance tolerance between the ideal curve and the exported line segments. Choosing a smaller size results in more smooth "
 					"curves, but at the expense of a larger output file and a longer run time.");
 
+				Ptr<BoolValueCommandInput> curvesAsLinesInput = inputs->addBoolValueInput(CURVES_AS_LINES_INPUT, "Output curves as line segments", true, "", false);
+				if (!curvesAsLinesInput)
+					return;
+				curvesAsLinesInput->tooltip("Write circles and arcs as straight line segments.");
+				curvesAsLinesInput->tooltipDescription("Some laser software does not understand curves. With this option the circles and arcs are "
+					"written as short line segments within the conversion tolerance, like the other curves.");
+
+				Ptr<DropDownCommandInput> strategyInput = inputs->addDropDownCommandInput(STRATEGY_INPUT, "Nesting strategy", TextListDropDownStyle);
+				if (!strategyInput)
+					return;
+				strategyInput->listItems()->add(STRATEGY_NAMES[STRATEGY_BOTTOM_LEFT], true);
+				strategyInput->listItems()->add(STRATEGY_NAMES[STRATEGY_ANNEALING], false);
+				strategyInput->listItems()->add(STRATEGY_NAMES[STRATEGY_RASTER], false);
+				strategyInput->listItems()->add(STRATEGY_NAMES[STRATEGY_SHELF], false);
+				strategyInput->tooltip("How the optimization time is spent.");
+				strategyInput->tooltipDescription("Bottom-left tries different part orders and rotations. Overlap annealing starts from the bottom-left layout "
+					"and repeatedly shortens it, moving parts around until they no longer overlap. It is usually denser for many similar parts. "
+					"Raster preview places the parts on a grid of 1024 cells across the sheet, which is less dense but takes well under a second "
+					"for large jobs. Shelves only look at the bounding boxes and fill the sheet row by row, tallest parts first. "
+					"Both ignore the optimization time.");
+
+				Ptr<IntegerSpinnerCommandInput> optimizationTimeInput = inputs->addIntegerSpinnerCommandInput(OPTIMIZATION_TIME_INPUT, "Optimization time (s)", 0, 3600, 1, 0);
+				if (!optimizationTimeInput)
+					return;
+				optimizationTimeInput->tooltip("Time spent searching for a denser layout.");
+				optimizationTimeInput->tooltipDescription("With 0 the parts are placed once, largest first. Otherwise the selected strategy searches "
+					"for this many seconds and keeps the shortest layout it finds.");
+
+				Ptr<IntegerSpinnerCommandInput> randomSeedInput = inputs->addIntegerSpinnerCommandInput(RANDOM_SEED_INPUT, "Random seed", 0, 1000000, 1, 0);
+				if (!randomSeedInput)
+					return;
+				randomSeedInput->tooltip("Seed for the layout optimization.");
+				randomSeedInput->tooltipDescription("Different seeds explore different layouts during optimization.");
+
+				Ptr<StringValueCommandInput> stockInput = inputs->addStringValueInput(STOCK_INPUT, "Stock sheets", "");
+				if (!stockInput)
+					return;
+				stockInput->tooltip("Sizes of the sheets to cut the parts from, in mm.");
+				stockInput->tooltipDescription("Leave empty to nest all parts on one sheet of unbounded length. Otherwise list the sheet sizes "
+					"as width x height x quantity, separated by semicolons, for example 2440x1220x3; 1000x500. Without a quantity there are as many "
+					"sheets of that size as needed. Sheets are filled in the order given and each one is written to its own numbered file.");
+
+				Ptr<BoolValueCommandInput> checkLayoutInput = inputs->addBoolValueInput(CHECK_LAYOUT_INPUT, "Check layout for overlaps", true, "", true);
+				if (!checkLayoutInput)
+					return;
+				checkLayoutInput->tooltip("Look for overlapping parts before writing.");
+				checkLayoutInput->tooltipDescription("Checks the finished layout for parts which overlap. If any do, you are asked whether to write "
+					"the files anyway. Large layouts take a moment longer to export with the check.");
+
 				// Create bool value input with button style that can be clicked.				
 				Ptr<BoolValueCommandInput> button = inputs->addBoolValueInput(OUTPUT_FILE_INPUT, "Output file", false, "", true);
 				button->text("Select file...");
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// keeps what it is asked to write, arcs only when told to take them
+	class RecordingWriter : public FileWriter {
+		bool takesArcs;
+	public:
+		struct Arc {
+			point_t center;
+			double radius, startAngle, endAngle;
+		};
+		vector<pair<point_t, point_t> > lines;
+		vector<Arc> arcs;
+
+		explicit RecordingWriter(bool takesArcs) : takesArcs(takesArcs) {}
+
+		virtual void line(point_t p1, point_t p2, int) {
+			lines.push_back(make_pair(p1, p2));
+		}
+
+		virtual void arc(point_t center, double radius, double startAngle, double endAngle, int color) {
+			if (!takesArcs) {
+				FileWriter::arc(center, radius, startAngle, endAngle, color);
+				return;
+			}
+			Arc a = { center, radius, startAngle, endAngle };
+			arcs.push_back(a);
+		}
+	};
+
+	shared_ptr<NesterArc> makeArc(point_t center, double radius, double start, double sweep) {
+		shared_ptr<NesterArc> arc = make_shared<NesterArc>();
+		arc->setCenter(center);
+		arc->setRadius(radius);
+		arc->setAngles(start, sweep);
+		return arc;
+	}
+
+	TEST_CASE("arc_bounding_box", "[arc]") {
+		shared_ptr<NesterArc> arc = makeArc(point_t(1, 2), 2.0, 45.0, 180.0);
+		BoundingBox bb = arc->getBoundingBox();
+		REQUIRE(fabs((double)bb.minX - -1.0) < 1e-12);
+		REQUIRE(fabs((double)bb.maxY - 4.0) < 1e-12);
+		REQUIRE(fabs((double)bb.maxX - (1.0 + sqrt(2.0))) < 1e-12);
+		REQUIRE(fabs((double)bb.minY - (2.0 - sqrt(2.0))) < 1e-12);
+
+		// against a fine tessellation, either way round
+		mt19937 random(5);
+		uniform_real_distribution<double> angle(-720.0, 720.0);
+		for (int i = 0; i < 1000; i++) {
+			arc = makeArc(point_t(3, -1), 1.5, angle(random), angle(random) / 2.0);
+			BoundingBox fine = getBoundingBox(arcPoints(point_t(3, -1), 1.5, arc->getStartAngle(), arc->getSweep(), 1e-9));
+			for (shared_ptr<NesterArc> a : { arc, arc->reversed() }) {
+				bb = a->getBoundingBox();
+				REQUIRE(fabs((double)(bb.minX - fine.minX)) < 1e-8);
+				REQUIRE(fabs((double)(bb.maxX - fine.maxX)) < 1e-8);
+				REQUIRE(fabs((double)(bb.minY - fine.minY)) < 1e-8);
+				REQUIRE(fabs((double)(bb.maxY - fine.maxY)) < 1e-8);
+			}
+		}
+	}
+
+	TEST_CASE("arc_points", "[arc]") {
+		// a half disc, clockwise over the top and back along the diameter
+		shared_ptr<NesterArc> arc = makeArc(point_t(0, 0), 10.0, 180.0, -180.0);
+		arc->setTolerance(1e-3);
+		shared_ptr<NesterLine> diameter = make_shared<NesterLine>();
+		diameter->setStartPoint(arc->getEndPoint());
+		diameter->setEndPoint(arc->getStartPoint());
+		NesterLoop loop;
+		loop.addEdge(arc);
+		loop.addEdge(diameter);
+
+		polygon_p polygon = loop.toPolygon();
+		REQUIRE(glm::distance(polygon->front(), point_t(-10, 0)) < 1e-12);
+		REQUIRE(glm::distance(polygon->back(), point_t(10, 0)) < 1e-12);
+		for (size_t k = 0; k + 1 < polygon->size(); k++) {
+			point_t middle = ((*polygon)[k] + (*polygon)[k + 1]) / 2.0;
+			REQUIRE(fabs(glm::length((*polygon)[k]) - 10.0) < 1e-12);
+			REQUIRE(10.0 - glm::length(middle) <= 1e-3);
+		}
+		double halfDisc = 3.14159265358979323846 * 50.0;
+		REQUIRE(signedArea(*polygon) < 0.0);
+		REQUIRE(fabs(-signedArea(*polygon) - halfDisc) < 0.1);
+	}
+
+	TEST_CASE("arc_points_degenerate", "[arc]") {
+		// no radius: both ends, at the center
+		for (double radius : { 0.0, -1.0 }) {
+			polygon_t points = arcPoints(point_t(1, 2), radius, 0.0, 90.0, 1e-3);
+			REQUIRE(points == polygon_t({ point_t(1, 2), point_t(1, 2) }));
+		}
+
+		// no tolerance is taken as a tiny one, with a bounded number of chords
+		for (double tolerance : { 0.0, -1.0 }) {
+			polygon_t points = arcPoints(point_t(0, 0), 1.0, 0.0, 90.0, tolerance);
+			REQUIRE(points.size() > 2);
+			REQUIRE(points.size() <= (1 << 20) + 1);
+			REQUIRE(glm::distance(points.back(), point_t(0, 1)) < 1e-12);
+			for (const point_t& p : points) {
+				REQUIRE(!std::isnan(p.x));
+			}
+		}
+	}
+
+	TEST_CASE("arc_writing", "[arc]") {
+		transformer_t transformer = makeTransformation(30.0, 5.0, 0.0);
+		shared_ptr<NesterArc> arc = makeArc(point_t(1, 0), 2.0, 100.0, -60.0);
+
+		shared_ptr<RecordingWriter> native = make_shared<RecordingWriter>(true);
+		arc->write(native, DXF_OUTER_CUT_COLOR, transformer);
+		REQUIRE(native->lines.empty());
+		REQUIRE(native->arcs.size() == 1);
+		REQUIRE(glm::distance(native->arcs[0].center, transformPoint(transformer, point_t(1, 0))) < 1e-12);
+		REQUIRE(native->arcs[0].radius == 2.0);
+		REQUIRE(fabs(native->arcs[0].startAngle - 70.0) < 1e-9);
+		REQUIRE(fabs(native->arcs[0].endAngle - 130.0) < 1e-9);
+
+		// writers without arcs get them as lines, from the same start to the same end
+		shared_ptr<RecordingWriter> lines = make_shared<RecordingWriter>(false);
+		arc->write(lines, DXF_OUTER_CUT_COLOR, transformer);
+		REQUIRE(lines->lines.size() > 1);
+		REQUIRE(glm::distance(lines->lines.front().first, transformPoint(transformer, arc->getEndPoint())) < 1e-9);
+		REQUIRE(glm::distance(lines->lines.back().second, transformPoint(transformer, arc->getStartPoint())) < 1e-9);
+		for (size_t k = 0; k + 1 < lines->lines.size(); k++) {
+			REQUIRE(lines->lines[k].second == lines->lines[k + 1].first);
+		}
+	}
+
+	TEST_CASE("curves_as_segments", "[arc]") {
+		// a writer which takes arcs gets lines within the tolerance instead, and the lines unchanged
+		shared_ptr<RecordingWriter> target = make_shared<RecordingWriter>(true);
+		shared_ptr<FileWriter> writer = make_shared<SegmentWriter>(target, 0.01);
+		writer->line(point_t(0, 0), point_t(1, 0));
+		writer->arc(point_t(0, 0), 5.0, 0.0, 90.0);
+		REQUIRE(target->arcs.empty());
+		REQUIRE(target->lines.size() > 2);
+		REQUIRE(target->lines[0] == make_pair(point_t(0, 0), point_t(1, 0)));
+		REQUIRE(glm::distance(target->lines[1].first, point_t(5, 0)) < 1e-12);
+		REQUIRE(glm::distance(target->lines.back().second, point_t(0, 5)) < 1e-12);
+		for (size_t k = 1; k < target->lines.size(); k++) {
+			REQUIRE(5.0 - glm::length((target->lines[k].first + target->lines[k].second) / 2.0) <= 0.01);
+		}
+
+		// a coarser tolerance takes fewer lines, a circle goes all the way round
+		size_t fine = target->lines.size();
+		target->lines.clear();
+		make_shared<SegmentWriter>(target, 0.1)->arc(point_t(0, 0), 5.0, 0.0, 90.0);
+		REQUIRE(target->lines.size() < fine - 1);
+		target->lines.clear();
+		writer->circle(point_t(2, 3), 1.0);
+		REQUIRE(target->arcs.empty());
+		REQUIRE(glm::distance(target->lines.front().first, target->lines.back().second) < 1e-12);
+	}
+
+	TEST_CASE("circle_ring", "[arc]") {
+		NesterCircle circle;
+		circle.setCenter(point_t(2, 3));
+		circle.setRadius(4.0);
+		BoundingBox bb = circle.getBoundingBox();
+		REQUIRE(bb.minX == -2.0);
+		REQUIRE(bb.maxY == 7.0);
+
+		polygon_p polygon = circle.toPolygon();
+		REQUIRE(signedArea(*polygon) > 0.0);
+		REQUIRE(fabs(signedArea(*polygon) - 3.14159265358979323846 * 16.0) < 0.05);
+		REQUIRE(glm::distance(polygon->front(), point_t(6, 3)) < 1e-12);
+		REQUIRE(polygon->front() != polygon->back());
+
+		// simplifying allows a coarser tessellation
+		size_t fine = polygon->size();
+		circle.simplify(0.1);
+		REQUIRE(circle.toPolygon()->size() < fine / 4);
+
+		shared_ptr<RecordingWriter> writer = make_shared<RecordingWriter>(false);
+		transformer_t identity = makeTransformation(0.0, 0.0, 0.0);
+		circle.write(writer, DXF_INNER_CUT_COLOR, identity);
+		REQUIRE(writer->lines.size() >= fine - 1);
+	}
+
+}
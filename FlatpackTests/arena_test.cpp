@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "catch.hpp"
+#include "../Nester/Arena.hpp"
+#include "../Nester/Nester.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// a square part built entirely in the arena
+	NesterPart_p arenaSquare(const Arena_p& arena, double side) {
+		shared_ptr<NesterLoop> loop = makeShared<NesterLoop>(arena, arena);
+		loop->addLines({ point_t(0, 0), point_t(side, 0), point_t(side, side), point_t(0, side), point_t(0, 0) });
+		NesterPart_p part = makeShared<NesterPart>(arena);
+		part->setOuterRing(loop);
+		return part;
+	}
+
+	TEST_CASE("arena_allocation", "[arena]") {
+		Arena arena;
+		char* previous = nullptr;
+		for (size_t bytes : { 1, 3, 8, 24, 5, 16, 100 }) {
+			for (size_t alignment : { 1, 2, 8, 16 }) {
+				char* p = static_cast<char*>(arena.allocate(bytes, alignment));
+				REQUIRE((uintptr_t)p % alignment == 0);
+				REQUIRE(p >= previous);
+				memset(p, 0xAB, bytes);
+				previous = p + bytes;
+			}
+		}
+		REQUIRE(arena.bytesReserved() == ARENA_BLOCK_SIZE);
+
+		// large requests get their own block and the small ones go on where they were
+		char* large = static_cast<char*>(arena.allocate(ARENA_BLOCK_SIZE, 64));
+		REQUIRE((uintptr_t)large % 64 == 0);
+		REQUIRE(static_cast<char*>(arena.allocate(8, 8)) >= previous);
+		REQUIRE(arena.bytesReserved() > 2 * ARENA_BLOCK_SIZE);
+		REQUIRE(arena.bytesUsed() >= ARENA_BLOCK_SIZE);
+	}
+
+	TEST_CASE("arena_geometry", "[arena]") {
+		Arena_p arena = make_shared<Arena>();
+		weak_ptr<Arena> watch = arena;
+		vector<NesterPart_p> parts;
+		for (int i = 1; i <= 100; i++) {
+			parts.push_back(arenaSquare(arena, i));
+		}
+		REQUIRE(arena->bytesUsed() > 0);
+
+		// the parts keep the arena alive
+		arena.reset();
+		REQUIRE(!watch.expired());
+		for (int i = 1; i <= 100; i++) {
+			BoundingBox bb = parts[i - 1]->getBoundingBox();
+			REQUIRE(bb.maxX == i);
+			REQUIRE(parts[i - 1]->toPolygon()->size() == 4);
+		}
+		parts.clear();
+		REQUIRE(watch.expired());
+
+		// nesting does not care where the parts live
+		Arena_p jobArena = make_shared<Arena>();
+		Nester nester;
+		nester.setSheetWidth(25.0);
+		for (int i = 0; i < 6; i++) {
+			nester.addPart(arenaSquare(jobArena, 10.0));
+		}
+		nester.run();
+		REQUIRE(nester.getPlacements().size() == 6);
+		REQUIRE(nester.verify().empty());
+	}
+
+	TEST_CASE("arena_benchmark", "[.][benchmark]") {
+		const int count = 1000000;
+		double heap = 0.0, arena = 0.0;
+		// the first round pays for touching fresh pages, the second is timed
+		for (int round = 0; round < 2; round++) {
+			auto started = chrono::steady_clock::now();
+			{
+				vector<shared_ptr<NesterArc> > arcs;
+				for (int i = 0; i < count; i++) {
+					arcs.push_back(make_shared<NesterArc>());
+				}
+			}
+			heap = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+			started = chrono::steady_clock::now();
+			{
+				Arena_p edges = make_shared<Arena>();
+				vector<shared_ptr<NesterArc> > arcs;
+				for (int i = 0; i < count; i++) {
+					arcs.push_back(makeShared<NesterArc>(edges));
+				}
+			}
+			arena = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		}
+		cout << count << " edges made and freed: heap " << heap << " ms, arena " << arena << " ms" << endl;
+	}
+
+}
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/NoFitPolygon.hpp"
+#include "../Nester/PartShape.hpp"
+#include "../Nester/PolygonBoolean.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	double totalArea(const vector<polygon_t>& rings) {
+		double area = 0.0;
+		for (const polygon_t& ring : rings) {
+			area += signedArea(ring);
+		}
+		return area;
+	}
+
+	TEST_CASE("boolean_operations", "[boolean]") {
+		vector<polygon_t> a = { square(0, 0, 2) };
+		vector<polygon_t> b = { square(1, 1, 2) };
+		vector<polygon_t> both = booleanOperation(a, b, BOOLEAN_UNION);
+		REQUIRE(both.size() == 1);
+		REQUIRE(both[0].size() == 8);
+		REQUIRE(totalArea(both) == Approx(7.0));
+		REQUIRE(totalArea(booleanOperation(a, b, BOOLEAN_INTERSECTION)) == Approx(1.0));
+		REQUIRE(totalArea(booleanOperation(a, b, BOOLEAN_DIFFERENCE)) == Approx(3.0));
+		REQUIRE(overlapArea(a, b) == Approx(1.0));
+
+		// a frame with a clockwise hole, and a square inside the hole which touches the frame at a corner
+		polygon_t hole = square(1, 1, 2);
+		makeClockwise(hole);
+		vector<polygon_t> frame = { square(0, 0, 4), hole };
+		vector<polygon_t> filled = booleanOperation(frame, { square(1, 1, 1) }, BOOLEAN_UNION);
+		REQUIRE(filled.size() == 2);
+		REQUIRE(totalArea(filled) == Approx(13.0));
+		REQUIRE(overlapArea(frame, { square(1.5, 1.5, 1) }) == Approx(0.0));
+
+		// squares touching at a corner stay separate rings, shared edges disappear
+		REQUIRE(booleanOperation({ square(0, 0, 1) }, { square(1, 1, 1) }, BOOLEAN_UNION).size() == 2);
+		vector<polygon_t> joined = booleanOperation({ square(0, 0, 1) }, { square(1, 0, 1) }, BOOLEAN_UNION);
+		REQUIRE(joined.size() == 1);
+		REQUIRE(joined[0].size() == 4);
+	}
+
+	TEST_CASE("boolean_random", "[boolean]") {
+		mt19937 random(3);
+		uniform_real_distribution<double> unit(0.0, 1.0);
+		for (int trial = 0; trial < 100; trial++) {
+			vector<polygon_t> a, b;
+			for (vector<polygon_t>* operand : { &a, &b }) {
+				// a star shaped ring, which is seldom convex. Rounding to the grid changes areas slightly.
+				polygon_t ring;
+				point_t center(unit(random) * 4.0, unit(random) * 4.0);
+				int n = 3 + trial % 11;
+				for (int k = 0; k < n; k++) {
+					double angle = 6.283185307179586 * (k + 0.8 * unit(random)) / n;
+					double radius = 1.0 + 3.0 * unit(random);
+					ring.push_back(center + radius * point_t(cos(angle), sin(angle)));
+				}
+				operand->push_back(ring);
+			}
+			double areaA = totalArea(booleanOperation(a, {}, BOOLEAN_UNION));
+			double areaB = totalArea(booleanOperation(b, {}, BOOLEAN_UNION));
+			REQUIRE(areaA == Approx(signedArea(a[0])).margin(1e-3));
+			double united = totalArea(booleanOperation(a, b, BOOLEAN_UNION));
+			double common = totalArea(booleanOperation(a, b, BOOLEAN_INTERSECTION));
+			double difference = totalArea(booleanOperation(a, b, BOOLEAN_DIFFERENCE));
+			REQUIRE(united + common == Approx(areaA + areaB).margin(1e-3));
+			REQUIRE(difference + common == Approx(areaA).margin(1e-3));
+		}
+	}
+
+	TEST_CASE("nfp_region", "[boolean]") {
+		// the pieces of an L overlap along their shared edges, their union is the L again
+		polygon_t l = { point_t(0, 0), point_t(3, 0), point_t(3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) };
+		NoFitPolygon nfp;
+		for (const polygon_t& piece : convexDecomposition(l)) {
+			nfp.addPiece(piece);
+		}
+		vector<polygon_t> region = nfp.region();
+		REQUIRE(region.size() == 1);
+		REQUIRE(region[0].size() == 6);
+		REQUIRE(signedArea(region[0]) == Approx(5.0));
+	}
+
+	TEST_CASE("boolean_range", "[boolean]") {
+		// beyond the range the grid points are clamped and reported, and the operations refuse the rings
+		double edge = (BOOLEAN_RANGE - 1) / BOOLEAN_SCALE;
+		IntPoint fixed;
+		REQUIRE(toFixed(point_t(edge, -edge), fixed));
+		REQUIRE(!toFixed(point_t(2.0 * edge, 1.0), fixed));
+		REQUIRE(fixed.x == BOOLEAN_RANGE - 1);
+		REQUIRE(fixed.y == (long long)BOOLEAN_SCALE);
+
+		REQUIRE(booleanOperation({ square(0, 0, 2) }, { square(edge, 0, 2) }, BOOLEAN_UNION).empty());
+		REQUIRE(booleanOperation({ square(0, 0, 2) }, { square(edge - 2.0, 0, 2) }, BOOLEAN_UNION).size() == 2);
+	}
+}
@@ -0,0 +1,172 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/EdgeTree.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/Predicates.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// a star with the given number of points around the centre, counter clockwise
+	polygon_t starRing(point_t centre, double outer, double inner, size_t points) {
+		polygon_t ring;
+		for (size_t k = 0; k < 2 * points; k++) {
+			double a = 3.14159265358979323846 * k / points;
+			double r = k % 2 == 0 ? outer : inner;
+			ring.push_back(centre + point_t(r * cos(a), r * sin(a)));
+		}
+		return ring;
+	}
+
+	// a star with a star shaped hole
+	NesterPart_p edgePart(size_t points) {
+		shared_ptr<NesterLoop> outer = make_shared<NesterLoop>();
+		polygon_t ring = starRing(point_t(0, 0), 10.0, 6.0, points);
+		ring.push_back(ring.front());
+		outer->addLines(ring);
+		shared_ptr<NesterLoop> hole = make_shared<NesterLoop>();
+		ring = starRing(point_t(0, 0), 4.0, 2.0, points);
+		ring.push_back(ring.front());
+		hole->addLines(ring);
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(outer);
+		part->addInnerRing(hole);
+		return part;
+	}
+
+	TEST_CASE("edge_tree_queries", "[edgetree]") {
+		NesterPart_p part = edgePart(50);
+		EdgeTree_p tree = part->getEdgeTree();
+		REQUIRE(tree->size() == 200);
+		REQUIRE(part->getEdgeTree() == tree);
+
+		polygon_t outer = *part->toPolygon();
+		polygon_t hole = *part->toHolePolygons()[0];
+		mt19937 random(11);
+		uniform_real_distribution<double> coordinate(-12.0, 12.0);
+		for (int i = 0; i < 2000; i++) {
+			point_t p(coordinate(random), coordinate(random));
+			REQUIRE(tree->contains(p) == (pointInPolygon(p, outer) && !pointInPolygon(p, hole)));
+
+			double nearest = numeric_limits<double>::infinity();
+			for (const polygon_t* ring : { &outer, &hole }) {
+				for (size_t k = 0; k < ring->size(); k++) {
+					point_t a = (*ring)[k], b = (*ring)[(k + 1) % ring->size()];
+					double t = min(1.0, max(0.0, glm::dot(p - a, b - a) / glm::dot(b - a, b - a)));
+					nearest = min(nearest, glm::distance(p, a + (b - a) * t));
+				}
+			}
+			REQUIRE(fabs(tree->distance(p) - nearest) < 1e-12);
+
+			point_t q(coordinate(random), coordinate(random));
+			bool crossing = false;
+			for (const polygon_t* ring : { &outer, &hole }) {
+				for (size_t k = 0; k < ring->size(); k++) {
+					crossing = crossing || segmentsCross((*ring)[k], (*ring)[(k + 1) % ring->size()], p, q);
+				}
+			}
+			REQUIRE(tree->crosses(p, q) == crossing);
+		}
+
+		REQUIRE(!EdgeTree().contains(point_t(0, 0)));
+		REQUIRE(!EdgeTree().crosses(point_t(0, 0), point_t(1, 1)));
+	}
+
+	TEST_CASE("edge_tree_collision", "[edgetree]") {
+		NesterPart_p part = edgePart(20);
+		EdgeTree_p tree = part->getEdgeTree();
+		polygon_t outer = *part->toPolygon();
+		polygon_t hole = *part->toHolePolygons()[0];
+
+		mt19937 random(13);
+		uniform_real_distribution<double> offset(-25.0, 25.0);
+		uniform_real_distribution<double> angle(0.0, 360.0);
+		int crossing = 0;
+		for (int i = 0; i < 300; i++) {
+			transformer_t transformer = makeTransformation(angle(random), offset(random), offset(random));
+			bool expected = false;
+			for (const polygon_t* a : { &outer, &hole }) {
+				for (const polygon_t* b : { &outer, &hole }) {
+					polygon_t moved = transformPolygon(*b, transformer);
+					for (size_t k = 0; k < a->size() && !expected; k++) {
+						for (size_t l = 0; l < moved.size() && !expected; l++) {
+							expected = segmentsCross((*a)[k], (*a)[(k + 1) % a->size()], moved[l], moved[(l + 1) % moved.size()]);
+						}
+					}
+				}
+			}
+			REQUIRE(tree->crosses(*tree, transformer) == expected);
+			crossing += expected ? 1 : 0;
+		}
+		REQUIRE(crossing > 0);
+		REQUIRE(crossing < 300);
+	}
+
+	TEST_CASE("cached_bounding_boxes", "[edgetree]") {
+		shared_ptr<NesterLoop> loop = make_shared<NesterLoop>();
+		loop->addLines({ point_t(0, 0), point_t(5, 0.001), point_t(10, 0), point_t(10, 4), point_t(0, 4), point_t(0, 0) });
+		BoundingBox bb = loop->getBoundingBox();
+		REQUIRE(bb.minY == 0.0);
+		REQUIRE(bb.maxY == 4.0);
+		REQUIRE(bb.maxX == 10.0);
+
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(loop);
+		REQUIRE(part->getEdgeTree()->size() == 5);
+		REQUIRE(part->getBoundingBox().maxX == 10.0);
+
+		// a hole which sticks out grows the box and the tree is built again
+		shared_ptr<NesterCircle> circle = make_shared<NesterCircle>();
+		circle->setCenter(point_t(10, 2));
+		circle->setRadius(1.0);
+		part->addInnerRing(circle);
+		REQUIRE(part->getBoundingBox().maxX == 11.0);
+		REQUIRE(part->getEdgeTree()->size() > 5);
+		REQUIRE(part->getEdgeTree()->getBoundingBox().maxX == 11.0);
+
+		// simplifying drops the corner that bulged out
+		loop->simplify(0.01);
+		bb = loop->getBoundingBox();
+		REQUIRE(bb.maxY == 4.0);
+		REQUIRE(bb.minY == 0.0);
+		REQUIRE(loop->toPolygon()->size() == 4);
+	}
+
+	TEST_CASE("edge_tree_benchmark", "[.][benchmark]") {
+		NesterPart_p part = edgePart(50000);
+		polygon_t outer = *part->toPolygon();
+		polygon_t hole = *part->toHolePolygons()[0];
+		auto started = chrono::steady_clock::now();
+		EdgeTree_p tree = part->getEdgeTree();
+		double built = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+
+		mt19937 random(17);
+		uniform_real_distribution<double> coordinate(-12.0, 12.0);
+		vector<point_t> points;
+		for (int i = 0; i < 1000; i++) {
+			points.push_back(point_t(coordinate(random), coordinate(random)));
+		}
+		size_t linearInside = 0, treeInside = 0;
+		started = chrono::steady_clock::now();
+		for (point_t p : points) {
+			linearInside += pointInPolygon(p, outer) && !pointInPolygon(p, hole) ? 1 : 0;
+		}
+		double linear = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		started = chrono::steady_clock::now();
+		for (point_t p : points) {
+			treeInside += tree->contains(p) ? 1 : 0;
+		}
+		double logarithmic = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "edge tree over " << tree->size() << " edges built in " << built << " ms, " << points.size()
+			<< " point queries: linear " << linear << " ms, tree " << logarithmic << " ms" << endl;
+		REQUIRE(linearInside == treeInside);
+	}
+
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/HoleFiller.hpp"
+#include "../Nester/Nester.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// a square of the given side, with a square hole of the given side in the middle unless that is 0
+	NesterPart_p framePart(double side, double hole) {
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(lineLoop(square(3.0, -2.0, side)));
+		if (hole > 0.0) {
+			part->addInnerRing(lineLoop(square(3.0 + (side - hole) / 2.0, -2.0 + (side - hole) / 2.0, hole)));
+		}
+		return part;
+	}
+
+	// a square frame turned by the given angle around the origin, its hole turned by holeAngle
+	NesterPart_p turnedFrame(double side, double hole, double angle, double holeAngle) {
+		NesterPart_p part = make_shared<NesterPart>();
+		for (double s : { side, hole }) {
+			polygon_t ring = { point_t(-s / 2, -s / 2), point_t(s / 2, -s / 2), point_t(s / 2, s / 2), point_t(-s / 2, s / 2), point_t(-s / 2, -s / 2) };
+			shared_ptr<NesterLoop> loop = make_shared<NesterLoop>();
+			loop->addLines(transformPolygon(ring, makeTransformation(s == side ? angle : holeAngle, 0.0, 0.0)));
+			if (s == side) {
+				part->setOuterRing(loop);
+			}
+			else {
+				part->addInnerRing(loop);
+			}
+		}
+		return part;
+	}
+
+	TEST_CASE("hole_filling", "[holes]") {
+		vector<NesterPart_p> parts = { framePart(10, 6) };
+		for (int i = 0; i < 5; i++) {
+			parts.push_back(framePart(2, 0));
+		}
+		parts.push_back(framePart(7, 0));
+		vector<PartShape> shapes = makePartShapes(parts, 4, 0.25);
+		HoleFiller filler(shapes);
+		vector<HolePlacement> filled = filler.fill({ 0, 6, 1, 2, 3, 4, 5 });
+
+		// with the spacing four of the small squares fit, the 7 by 7 square is ruled out by its box
+		REQUIRE(filled.size() == 4);
+		for (const HolePlacement& h : filled) {
+			REQUIRE(h.parent == 0);
+			REQUIRE(h.shape != 6);
+			BoundingBox bb = getBoundingBox(transformPolygon(shapes[h.shape].orientations[h.orientation].outer,
+				makeTransformation(0.0, h.position.x, h.position.y)));
+			REQUIRE(bb.minX >= 2.5 - 1e-6);
+			REQUIRE(bb.minY >= 2.5 - 1e-6);
+			REQUIRE(bb.maxX <= 7.5 + 1e-6);
+			REQUIRE(bb.maxY <= 7.5 + 1e-6);
+		}
+	}
+
+	TEST_CASE("part_in_part_nesting", "[holes]") {
+		// a square in the hole of a frame in the hole of a larger frame
+		Nester nester;
+		nester.setSheetWidth(30.0);
+		nester.setSpacing(0.5);
+		nester.addPart(framePart(2, 0));
+		nester.addPart(framePart(10, 8));
+		nester.addPart(framePart(6, 4));
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 3);
+		vector<BoundingBox> outer(3), hole(3);
+		for (const Placement& p : placements) {
+			polygon_t outline = transformPolygon(*p.part->toPolygon(), p.transformer);
+			BoundingBox bb = getBoundingBox(outline);
+			size_t size = bb.width() > 8.0 ? 2 : bb.width() > 4.0 ? 1 : 0;
+			outer[size] = bb;
+			vector<polygon_p> holes = p.part->toHolePolygons();
+			if (!holes.empty()) {
+				hole[size] = getBoundingBox(transformPolygon(*holes[0], p.transformer));
+			}
+		}
+		for (size_t inner = 0; inner < 2; inner++) {
+			REQUIRE(outer[inner].minX >= hole[inner + 1].minX + 0.5 - 1e-6);
+			REQUIRE(outer[inner].minY >= hole[inner + 1].minY + 0.5 - 1e-6);
+			REQUIRE(outer[inner].maxX <= hole[inner + 1].maxX - 0.5 + 1e-6);
+			REQUIRE(outer[inner].maxY <= hole[inner + 1].maxY - 0.5 + 1e-6);
+		}
+	}
+
+	TEST_CASE("tilted_hole_parent", "[holes]") {
+		// the frame is nested upright, its hole part has to turn back with it
+		Nester nester;
+		nester.setSheetWidth(30.0);
+		nester.setSpacing(0.5);
+		nester.addPart(turnedFrame(10, 6, 45.0, 45.0));
+		nester.addPart(framePart(2, 0));
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 2);
+		polygon_t hole = transformPolygon(*placements[0].part->toHolePolygons()[0], placements[0].transformer);
+		polygon_t square = transformPolygon(*placements[1].part->toPolygon(), placements[1].transformer);
+		REQUIRE(getBoundingBox(square).maxY < getBoundingBox(hole).maxY);
+		for (point_t p : square) {
+			REQUIRE(pointInPolygon(p, hole));
+			for (size_t k = 0; k < hole.size(); k++) {
+				point_t a = hole[k], b = hole[(k + 1) % hole.size()];
+				double t = min(1.0, max(0.0, glm::dot(p - a, b - a) / glm::dot(b - a, b - a)));
+				REQUIRE(glm::distance(p, a + (b - a) * t) >= 0.5 - 1e-4);
+			}
+		}
+	}
+
+	TEST_CASE("rotated_hole_parents", "[holes]") {
+		// once the frame is upright its hole is a little off square, or well off when it is turned in the
+		// frame, and the room in it is only bounded by crossings of the NFP edges
+		for (double angle : { 1.0, 15.0, 30.0, 60.0 }) {
+			for (double holeAngle : { angle, angle + 30.0 }) {
+				Nester nester;
+				nester.setSheetWidth(30.0);
+				nester.setSpacing(0.5);
+				nester.addPart(turnedFrame(10, 6, angle, holeAngle));
+				nester.addPart(framePart(2, 0));
+				nester.run();
+
+				const vector<Placement>& placements = nester.getPlacements();
+				REQUIRE(placements.size() == 2);
+				polygon_t hole = transformPolygon(*placements[0].part->toHolePolygons()[0], placements[0].transformer);
+				for (point_t p : transformPolygon(*placements[1].part->toPolygon(), placements[1].transformer)) {
+					REQUIRE(pointInPolygon(p, hole));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,216 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// counts what it is asked to write
+	class PolylineWriter : public FileWriter {
+	public:
+		vector<polygon_t> polylines;
+		size_t arcs = 0;
+		string order;  // 'l' for a line or polyline, 'a' for an arc, as they were written
+
+		virtual void line(point_t p1, point_t p2, int) {
+			polylines.push_back({ p1, p2 });
+			order += 'l';
+		}
+
+		virtual void arc(point_t, double, double, double, int) {
+			arcs++;
+			order += 'a';
+		}
+
+		virtual void polyline(const polygon_t& points, int) {
+			polylines.push_back(points);
+			order += 'l';
+		}
+	};
+
+	// an edge of a kind loops don't know
+	class PointEdge : public NesterEdge {
+	public:
+		virtual void write(shared_ptr<FileWriter>, color_t, transformer_t&) const {}
+		virtual BoundingBox getBoundingBox() const {
+			return BoundingBox();
+		}
+		virtual void appendPoints(polygon_t&) const {}
+	};
+
+	polygon_t zigzag(size_t corners) {
+		polygon_t points;
+		for (size_t k = 0; k < corners; k++) {
+			points.push_back(point_t((double)k, k % 2 == 0 ? 0.0 : 1.0));
+		}
+		return points;
+	}
+
+	TEST_CASE("loop_runs", "[loop]") {
+		// the zigzag closed along the bottom, once as line objects and once as corners
+		polygon_t ring = zigzag(9);
+		ring.push_back(point_t(4.0, -1.0));
+		NesterLoop edges, corners;
+		for (size_t k = 0; k < ring.size(); k++) {
+			shared_ptr<NesterLine> line = make_shared<NesterLine>();
+			line->setStartPoint(ring[k]);
+			line->setEndPoint(ring[(k + 1) % ring.size()]);
+			edges.addEdge(line);
+		}
+		polygon_t closed = ring;
+		closed.push_back(ring.front());
+		corners.addLines(closed);
+
+		polygon_p fromEdges = edges.toPolygon();
+		polygon_p fromCorners = corners.toPolygon();
+		REQUIRE(*fromEdges == ring);
+		REQUIRE(*fromCorners == ring);
+		BoundingBox bb = corners.getBoundingBox();
+		REQUIRE(bb.minX == 0.0);
+		REQUIRE(bb.maxX == 8.0);
+		REQUIRE(bb.minY == -1.0);
+		REQUIRE(bb.maxY == 1.0);
+
+		// one connected run is written in one go, moved by the transformer
+		shared_ptr<PolylineWriter> writer = make_shared<PolylineWriter>();
+		transformer_t transformer = makeTransformation(90.0, 10.0, 0.0);
+		edges.write(writer, DXF_OUTER_CUT_COLOR, transformer);
+		REQUIRE(writer->polylines.size() == 1);
+		REQUIRE(writer->polylines[0].size() == closed.size());
+		for (size_t k = 0; k < closed.size(); k++) {
+			REQUIRE(glm::distance(writer->polylines[0][k], transformPoint(transformer, closed[k])) < 1e-12);
+		}
+	}
+
+	TEST_CASE("loop_with_curves", "[loop]") {
+		// a slot: two straight sides and two half circle ends
+		NesterLoop slot;
+		slot.addLines({ point_t(0, 0), point_t(5, 0), point_t(10, 0) });
+		shared_ptr<NesterArc> right = make_shared<NesterArc>();
+		right->setCenter(point_t(10, 1));
+		right->setRadius(1.0);
+		right->setAngles(-90.0, 180.0);
+		slot.addEdge(right);
+		slot.addLines({ point_t(10, 2), point_t(0, 2) });
+		shared_ptr<NesterArc> left = make_shared<NesterArc>();
+		left->setCenter(point_t(0, 1));
+		left->setRadius(1.0);
+		left->setAngles(90.0, 180.0);
+		slot.addEdge(left);
+
+		BoundingBox bb = slot.getBoundingBox();
+		REQUIRE(fabs((double)bb.minX - -1.0) < 1e-12);
+		REQUIRE(fabs((double)bb.maxX - 11.0) < 1e-12);
+
+		polygon_p polygon = slot.toPolygon();
+		double area = 20.0 + 3.14159265358979323846;
+		REQUIRE(fabs(signedArea(*polygon) - area) < 0.01);
+
+		// the straight runs lose their middle corner, the arcs stay
+		slot.simplify(0.01);
+		shared_ptr<PolylineWriter> writer = make_shared<PolylineWriter>();
+		transformer_t identity = makeTransformation(0.0, 0.0, 0.0);
+		slot.write(writer, DXF_OUTER_CUT_COLOR, identity);
+		REQUIRE(writer->arcs == 2);
+		REQUIRE(writer->polylines.size() == 2);
+		REQUIRE(writer->polylines[0] == polygon_t({ point_t(0, 0), point_t(10, 0) }));
+		REQUIRE(fabs(signedArea(*slot.toPolygon()) - area) < 0.01);
+	}
+
+	TEST_CASE("loop_edge_kinds", "[loop]") {
+		// a square with rounded corners: lines, arcs and one corner as a spline
+		NesterLoop rounded;
+		shared_ptr<NesterArc> corner = make_shared<NesterArc>();
+		corner->setRadius(1.0);
+		rounded.addLine(point_t(1, 0), point_t(9, 0));
+		for (point_t centre : { point_t(9, 1), point_t(9, 9), point_t(1, 9) }) {
+			corner->setCenter(centre);
+			corner->setAngles(centre.y < 5.0 ? -90.0 : centre.x > 5.0 ? 0.0 : 90.0, 90.0);
+			rounded.addEdge(corner);
+			point_t next = centre.y < 5.0 ? point_t(10, 9) : centre.x > 5.0 ? point_t(1, 10) : point_t(0, 1);
+			rounded.addLine(corner->getEndPoint(), next);
+		}
+		shared_ptr<NesterNurbs> spline = make_shared<NesterNurbs>();
+		spline->addControlPoint(0, 1);
+		spline->addControlPoint(0, 0);
+		spline->addControlPoint(1, 0);
+		spline->addKnots({ 0, 0, 0, 1, 1, 1 });
+		REQUIRE(rounded.addEdge(spline));
+		REQUIRE(!rounded.addEdge(make_shared<PointEdge>()));
+
+		// the arcs were copied, so changing the last one afterwards changes nothing
+		polygon_p before = rounded.toPolygon();
+		corner->setRadius(5.0);
+		REQUIRE(*rounded.toPolygon() == *before);
+		BoundingBox bb = rounded.getBoundingBox();
+		REQUIRE(fabs(bb.maxX - 10.0) < 1e-12);
+		REQUIRE(fabs(bb.maxY - 10.0) < 1e-12);
+		REQUIRE(bb.minX == 0.0);
+
+		// one pass per kind, the box measured again the same
+		rounded.simplify(0.01);
+		bb = rounded.getBoundingBox();
+		REQUIRE(fabs(bb.maxX - 10.0) < 1e-12);
+		REQUIRE(bb.minY == 0.0);
+		shared_ptr<PolylineWriter> writer = make_shared<PolylineWriter>();
+		transformer_t identity = makeTransformation(0.0, 0.0, 0.0);
+		rounded.write(writer, DXF_OUTER_CUT_COLOR, identity);
+		REQUIRE(writer->arcs == 3);
+		// around the outline as it was drawn, the spline last as lines
+		REQUIRE(writer->order.substr(0, 7) == "lalalal");
+		REQUIRE(writer->order.find('a', 7) == string::npos);
+		REQUIRE(writer->order.size() > 8);
+		REQUIRE(fabs(signedArea(*rounded.toPolygon()) - signedArea(*before)) < 1e-9);
+	}
+
+	TEST_CASE("loop_benchmark", "[.][benchmark]") {
+		// a fine circle of a million lines
+		const size_t corners = 1000000;
+		polygon_t ring;
+		for (size_t k = 0; k <= corners; k++) {
+			double a = 2.0 * 3.14159265358979323846 * k / corners;
+			ring.push_back(point_t(cos(a), sin(a)));
+		}
+		auto started = chrono::steady_clock::now();
+		NesterLoop loop;
+		loop.addLines(ring);
+		double built = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		started = chrono::steady_clock::now();
+		BoundingBox bb;
+		for (int i = 0; i < 10; i++) {
+			bb = loop.getBoundingBox();
+		}
+		double boxed = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count() / 10.0;
+		cout << "built a loop of " << corners << " lines in " << built << " ms, bounding box in " << boxed << " ms" << endl;
+		REQUIRE(bb.maxX == 1.0);
+
+		// a wave of short runs and half circles, every other piece a curve
+		NesterLoop wave;
+		for (int i = 0; i < 100000; i++) {
+			double x = 3.0 * i;
+			wave.addLines({ point_t(x, 0), point_t(x + 1, 0.5), point_t(x + 2, 0) });
+			shared_ptr<NesterArc> arc = make_shared<NesterArc>();
+			arc->setCenter(point_t(x + 2.5, 0));
+			arc->setRadius(0.5);
+			arc->setAngles(180.0, -180.0);
+			wave.addEdge(arc);
+		}
+		started = chrono::steady_clock::now();
+		size_t points = wave.toPolygon()->size();
+		double tessellated = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		shared_ptr<PolylineWriter> writer = make_shared<PolylineWriter>();
+		transformer_t transformer = makeTransformation(30.0, 1.0, 2.0);
+		started = chrono::steady_clock::now();
+		wave.write(writer, DXF_OUTER_CUT_COLOR, transformer);
+		double written = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "200000 pieces to " << points << " points in " << tessellated << " ms, written in " << written << " ms" << endl;
+		REQUIRE(writer->arcs == 100000);
+	}
+
+}
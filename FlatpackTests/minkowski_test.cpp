@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/MinkowskiKernel.hpp"
+#include "../Nester/NoFitPolygon.hpp"
+#include "../Nester/Simd.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// a convex counter clockwise polygon with its vertices at random angles on an ellipse
+	polygon_t randomConvex(mt19937& random, size_t vertices) {
+		uniform_real_distribution<double> unit(0.0, 1.0);
+		vector<double> angles;
+		for (size_t k = 0; k < vertices; k++) {
+			angles.push_back(unit(random) * 6.283185307179586);
+		}
+		sort(angles.begin(), angles.end());
+		double rx = 1.0 + 5.0 * unit(random), ry = 1.0 + 5.0 * unit(random);
+		point_t center(10.0 * unit(random) - 5.0, 10.0 * unit(random) - 5.0);
+		polygon_t polygon;
+		for (double a : angles) {
+			polygon.push_back(center + point_t(rx * cos(a), ry * sin(a)));
+		}
+		return polygon;
+	}
+
+	TEST_CASE("minkowski_kernel", "[minkowski]") {
+		mt19937 random(7);
+		MinkowskiKernel kernel;
+		polygon_t sum;
+		for (int trial = 0; trial < 200; trial++) {
+			polygon_t a = randomConvex(random, 3 + trial % 13);
+			polygon_t b = randomConvex(random, 3 + trial % 7);
+			ConvexPieces pa({ a }), pb({ b });
+			kernel.sum(pa, 0, pb, 0, sum);
+
+			polygon_t reference = minkowskiSum(a, b);
+			REQUIRE(sum.size() == a.size() + b.size());
+			REQUIRE(signedArea(sum) == Approx(signedArea(reference)));
+			for (const point_t& p : sum) {
+				bool found = false;
+				for (const point_t& q : reference) {
+					found = found || glm::length(p - q) < 1e-9;
+				}
+				REQUIRE(found);
+			}
+		}
+
+		// parallel edges of both sides merge into one, and the pieces need not start at their lowest point
+		ConvexPieces boxes({ { point_t(2, 1), point_t(0, 1), point_t(0, 0), point_t(2, 0) }, { point_t(-1, -1), point_t(0, -1), point_t(0, 2), point_t(-1, 2) } });
+		kernel.sum(boxes, 0, boxes, 1, sum);
+		REQUIRE(sum.size() == 4);
+		REQUIRE(signedArea(sum) == Approx(3.0 * 4.0));
+		REQUIRE(sum[0] == point_t(-1, -1));
+	}
+
+	// a regular polygon of the given number of corners, a circle for many
+	polygon_t regularPolygon(point_t center, double radius, size_t corners) {
+		polygon_t polygon;
+		for (size_t k = 0; k < corners; k++) {
+			double a = 6.283185307179586 * k / corners;
+			polygon.push_back(center + point_t(radius * cos(a), radius * sin(a)));
+		}
+		return polygon;
+	}
+
+	// sums every fixed piece with every moving one with both the reference and the kernel
+	void timeSums(const char* name, const vector<polygon_t>& fixed, const vector<polygon_t>& moving, int rounds) {
+		ConvexPieces fixedPieces(fixed), movingPieces(moving);
+
+		auto start = chrono::steady_clock::now();
+		size_t referenceVertices = 0;
+		for (int r = 0; r < rounds; r++) {
+			for (const polygon_t& f : fixed) {
+				for (const polygon_t& m : moving) {
+					referenceVertices += minkowskiSum(f, m).size();
+				}
+			}
+		}
+		double referenceSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		start = chrono::steady_clock::now();
+		MinkowskiKernel kernel;
+		polygon_t sum;
+		size_t kernelVertices = 0;
+		for (int r = 0; r < rounds; r++) {
+			for (size_t f = 0; f < fixedPieces.size(); f++) {
+				for (size_t m = 0; m < movingPieces.size(); m++) {
+					kernel.sum(fixedPieces, f, movingPieces, m, sum);
+					kernelVertices += sum.size();
+				}
+			}
+		}
+		double kernelSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		size_t pairs = (size_t)rounds * fixed.size() * moving.size();
+		cout << "minkowski sums of " << pairs << " " << name << " pairs: reference " << referenceSeconds * 1000.0 << " ms, kernel "
+			<< kernelSeconds * 1000.0 << " ms" << (hasAvx2() ? " (avx2)" : "") << endl;
+		REQUIRE(kernelVertices <= referenceVertices);
+	}
+
+	TEST_CASE("minkowski_benchmark", "[.][benchmark]") {
+		// pieces as the nester sees them: small convex parts grown by the spacing octagon
+		mt19937 random(11);
+		polygon_t octagon = regularPolygon(point_t(0, 0), 0.1, 8);
+		vector<polygon_t> fixed, moving;
+		for (int i = 0; i < 64; i++) {
+			fixed.push_back(minkowskiSum(randomConvex(random, 4 + i % 8), octagon));
+			moving.push_back(randomConvex(random, 4 + i % 8));
+		}
+		timeSums("small", fixed, moving, 50);
+
+		// finely tessellated circles, where the edges of a pair are many
+		for (size_t corners : { 16, 32, 64, 256, 1024 }) {
+			fixed.clear();
+			moving.clear();
+			for (int i = 0; i < 8; i++) {
+				fixed.push_back(regularPolygon(point_t(i, 0), 1.0 + i, corners));
+				moving.push_back(regularPolygon(point_t(0, i), 2.0, corners - i));
+			}
+			string name = to_string(corners) + "-gon";
+			timeSums(name.c_str(), fixed, moving, (int)(2000000 / (corners * 64)) + 1);
+		}
+	}
+}
@@ -0,0 +1,201 @@
+#include <sstream>
+
+#include "catch.hpp"
+#include "../Nester/GeneticOrdering.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/NoFitPolygon.hpp"
+#include "../Nester/OverlapAnnealer.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	TEST_CASE("minkowski_sum", "[nfp]") {
+		polygon_t sum = minkowskiSum(rectangle(0.0, 0.0, 2.0, 1.0), rectangle(-1.0, -1.0, 1.0, 3.0));
+		REQUIRE(signedArea(sum) == Approx(3.0 * 4.0));
+
+		BoundingBox bb = getBoundingBox(sum);
+		REQUIRE(bb.minX == Approx(-1.0));
+		REQUIRE(bb.minY == Approx(-1.0));
+		REQUIRE(bb.maxX == Approx(2.0));
+		REQUIRE(bb.maxY == Approx(3.0));
+	}
+
+	TEST_CASE("convex_decomposition", "[nfp]") {
+		polygon_t l = { point_t(0, 0), point_t(3, 0), point_t(3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) };
+		vector<polygon_t> pieces = convexDecomposition(l);
+
+		REQUIRE(pieces.size() == 2);
+		double area = 0.0;
+		for (const polygon_t& piece : pieces) {
+			REQUIRE(isConvex(piece));
+			area += signedArea(piece);
+		}
+		REQUIRE(area == Approx(signedArea(l)));
+	}
+
+	TEST_CASE("no_fit_polygon", "[nfp]") {
+		vector<NesterPart_p> parts = { linePart(rectangle(0.0, 0.0, 2.0, 2.0)), linePart(rectangle(0.0, 0.0, 1.0, 1.0)) };
+		vector<PartShape> shapes = makePartShapes(parts, 1);
+		NfpCache nfps(shapes);
+		const NoFitPolygon& nfp = nfps.get(0, 1, 0);
+
+		REQUIRE(nfp.containsInterior(point_t(0.5, 0.5)));
+		REQUIRE(nfp.containsInterior(point_t(-0.5, 1.5)));
+		REQUIRE_FALSE(nfp.containsInterior(point_t(2.0, 0.0)));   // touching on the right
+		REQUIRE_FALSE(nfp.containsInterior(point_t(-1.0, 0.5)));  // touching on the left
+		REQUIRE_FALSE(nfp.containsInterior(point_t(3.0, 3.0)));
+	}
+
+	TEST_CASE("nfp_precompute", "[nfp]") {
+		vector<NesterPart_p> parts = {
+			linePart(rectangle(0.0, 0.0, 2.0, 2.0)),
+			linePart(rectangle(5.0, 5.0, 2.0, 2.0)),
+			linePart({ point_t(0, 0), point_t(3, 0), point_t(3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) }) };
+		vector<PartShape> shapes = makePartShapes(parts, 4, 0.05);
+		REQUIRE(shapes[0].shapeId == shapes[1].shapeId);
+
+		ThreadPool pool(4);
+		NfpCache precomputed(shapes);
+		precomputed.precompute(pool);
+		NfpCache lazy(shapes);
+
+		// two outlines, both pairings in both directions plus the square against itself
+		REQUIRE(precomputed.getTimings().size() == 3 * 4);
+		for (size_t f = 0; f < shapes.size(); f++) {
+			for (size_t m = 0; m < shapes.size(); m++) {
+				for (size_t r = 0; r < 4; r++) {
+					REQUIRE(precomputed.get(f, m, r).vertexCount() == lazy.get(f, m, r).vertexCount());
+				}
+			}
+		}
+	}
+
+	TEST_CASE("nfp_concurrent_lookups", "[nfp]") {
+		// only the L is precomputed, so the lookups of precomputed pairs run alongside the computation of
+		// the others
+		vector<NesterPart_p> parts = {
+			linePart({ point_t(0, 0), point_t(3, 0), point_t(3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) }),
+			linePart(rectangle(0.0, 0.0, 2.0, 1.0)),
+			linePart(rectangle(0.0, 0.0, 1.5, 1.5)),
+			linePart({ point_t(0, 0), point_t(2, 0), point_t(1, 2) }) };
+		vector<PartShape> shapes = makePartShapes(parts, 4, 0.05);
+		ThreadPool pool(4);
+		NfpCache shared(shapes);
+		shared.precompute(pool, { true, false, false, false });
+		NfpCache lazy(shapes);
+
+		size_t pairs = shapes.size() * shapes.size() * 4;
+		vector<size_t> vertices(8 * pairs);
+		for (size_t i = 0; i < vertices.size(); i++) {
+			pool.submit([&, i]() {
+				size_t k = i % pairs;
+				vertices[i] = shared.get(k / 16, k / 4 % 4, k % 4).vertexCount();
+			});
+		}
+		pool.wait();
+		for (size_t i = 0; i < vertices.size(); i++) {
+			size_t k = i % pairs;
+			REQUIRE(vertices[i] == lazy.get(k / 16, k / 4 % 4, k % 4).vertexCount());
+		}
+	}
+
+	TEST_CASE("bottom_left_nesting", "[nfp]") {
+		Nester nester;
+		nester.setSheetWidth(10.0);
+		nester.setSpacing(0.0);
+		for (int i = 0; i < 6; i++) {
+			nester.addPart(linePart(rectangle(100.0 * i, 50.0, 4.0, 3.0)));
+		}
+		nester.addPart(linePart({ point_t(0, 0), point_t(6, 0), point_t(6, 2), point_t(2, 2), point_t(2, 6), point_t(0, 6) }));
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 7);
+
+		vector<BoundingBox> boxes;
+		for (const Placement& p : placements) {
+			polygon_t outline = transformPolygon(*p.part->toPolygon(), p.transformer);
+			BoundingBox bb = getBoundingBox(outline);
+			REQUIRE(bb.minX >= -1e-6);
+			REQUIRE(bb.maxX <= 10.0 + 1e-6);
+			REQUIRE(bb.minY >= -1e-6);
+			boxes.push_back(bb);
+		}
+
+		// the rectangles are packed three abreast and must not overlap each other
+		for (size_t i = 0; i < placements.size(); i++) {
+			for (size_t j = i + 1; j < placements.size(); j++) {
+				if (placements[i].part->toPolygon()->size() != 4 || placements[j].part->toPolygon()->size() != 4) {
+					continue;
+				}
+				bool separate = boxes[i].maxX <= boxes[j].minX + 1e-6 || boxes[j].maxX <= boxes[i].minX + 1e-6 ||
+					boxes[i].maxY <= boxes[j].minY + 1e-6 || boxes[j].maxY <= boxes[i].minY + 1e-6;
+				REQUIRE(separate);
+			}
+		}
+	}
+
+	TEST_CASE("genetic_ordering", "[nfp]") {
+		vector<NesterPart_p> parts;
+		for (int i = 0; i < 8; i++) {
+			parts.push_back(linePart(rectangle(0.0, 0.0, 1.0 + i % 3, 3.0 - i % 3)));
+		}
+		vector<PartShape> shapes = makePartShapes(parts, 2);
+		ThreadPool pool(2);
+		NfpCache nfps(shapes);
+		nfps.precompute(pool);
+
+		vector<size_t> order = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		BottomLeftPlacer placer(shapes, nfps, 6.0, 0.0);
+		NestingResult initial = placer.place(order, vector<int>(order.size(), ANY_ORIENTATION));
+
+		stringstream log;
+		GeneticOrdering search(shapes, nfps, pool, 6.0, 0.0, 42);
+		NestingResult evolved = search.optimize(order, 0.2, log);
+
+		REQUIRE(evolved.placements.size() == parts.size());
+		REQUIRE(evolved.length <= initial.length);
+	}
+
+	TEST_CASE("overlap_annealing", "[nfp]") {
+		vector<NesterPart_p> parts;
+		for (int i = 0; i < 8; i++) {
+			parts.push_back(linePart(rectangle(0.0, 0.0, 1.0 + i % 3, 3.0 - i % 3)));
+		}
+		vector<PartShape> shapes = makePartShapes(parts, 2);
+		ThreadPool pool(2);
+		NfpCache nfps(shapes);
+		nfps.precompute(pool);
+
+		vector<size_t> order = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		BottomLeftPlacer placer(shapes, nfps, 6.0, 0.0);
+		NestingResult initial = placer.place(order, vector<int>(order.size(), ANY_ORIENTATION));
+
+		stringstream log;
+		OverlapAnnealer annealer(shapes, nfps, 6.0, 0.0, 42);
+		NestingResult annealed = annealer.improve(initial, 0.2, log);
+
+		REQUIRE(annealed.placements.size() == parts.size());
+		REQUIRE(annealed.length <= initial.length + 1e-9);
+
+		// the layout it hands back is always free of overlaps
+		vector<BoundingBox> boxes;
+		for (const ShapePlacement& p : annealed.placements) {
+			const OrientedShape& oriented = shapes[p.shape].orientations[p.orientation];
+			boxes.push_back(getBoundingBox(transformPolygon(oriented.outer, makeTransformation(0.0, p.position.x, p.position.y))));
+		}
+		for (size_t i = 0; i < boxes.size(); i++) {
+			REQUIRE(boxes[i].minX >= -1e-6);
+			REQUIRE(boxes[i].maxX <= 6.0 + 1e-6);
+			for (size_t j = i + 1; j < boxes.size(); j++) {
+				bool separate = boxes[i].maxX <= boxes[j].minX + 1e-6 || boxes[j].maxX <= boxes[i].minX + 1e-6 ||
+					boxes[i].maxY <= boxes[j].minY + 1e-6 || boxes[j].maxY <= boxes[i].minY + 1e-6;
+				REQUIRE(separate);
+			}
+		}
+	}
+}
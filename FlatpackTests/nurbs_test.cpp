@@ -0,0 +1,186 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/Nurbs.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// the unit circle as nine weighted control points of a quadratic spline
+	NurbsCurve nurbsCircle() {
+		double h = sqrt(0.5);
+		NurbsCurve circle;
+		circle.controlPoints = { point_t(1, 0), point_t(1, 1), point_t(0, 1), point_t(-1, 1), point_t(-1, 0),
+			point_t(-1, -1), point_t(0, -1), point_t(1, -1), point_t(1, 0) };
+		circle.weights = { 1, h, 1, h, 1, h, 1, h, 1 };
+		circle.knots = { 0, 0, 0, 0.25, 0.25, 0.5, 0.5, 0.75, 0.75, 1, 1, 1 };
+		return circle;
+	}
+
+	// a cubic Bezier curve by its Bernstein polynomials
+	point_t bezierPoint(const vector<point_t>& c, double t) {
+		double s = 1.0 - t;
+		return c[0] * (s * s * s) + c[1] * (3.0 * s * s * t) + c[2] * (3.0 * s * t * t) + c[3] * (t * t * t);
+	}
+
+	TEST_CASE("nurbs_evaluation", "[nurbs]") {
+		vector<point_t> controls = { point_t(0, 0), point_t(1, 3), point_t(4, -2), point_t(5, 1) };
+		NurbsCurve bezier;
+		bezier.controlPoints = controls;
+		bezier.knots = { 0, 0, 0, 0, 1, 1, 1, 1 };
+		REQUIRE(bezier.isValid());
+		REQUIRE(bezier.degree() == 3);
+
+		vector<double> parameters;
+		for (int i = 0; i <= 1000; i++) {
+			parameters.push_back(i / 1000.0);
+		}
+		polygon_t points;
+		evaluateNurbs(bezier, parameters, points);
+		REQUIRE(points.size() == parameters.size());
+		for (size_t i = 0; i < points.size(); i++) {
+			REQUIRE(glm::distance(points[i], bezierPoint(controls, parameters[i])) < 1e-12);
+		}
+
+		// the same in batches over several spans as one at a time
+		NurbsCurve circle = nurbsCircle();
+		REQUIRE(circle.isValid());
+		evaluateNurbs(circle, parameters, points);
+		for (size_t i = 0; i < points.size(); i++) {
+			REQUIRE(fabs(glm::length(points[i]) - 1.0) < 1e-12);
+			polygon_t single;
+			evaluateNurbs(circle, { parameters[i] }, single);
+			REQUIRE(glm::distance(single[0], points[i]) < 1e-15);
+		}
+		REQUIRE(glm::distance(points.back(), point_t(1, 0)) < 1e-15);
+
+		NurbsCurve broken = circle;
+		broken.knots[4] = 0.1;
+		REQUIRE(!broken.isValid());
+	}
+
+	TEST_CASE("nurbs_tessellation", "[nurbs]") {
+		NurbsCurve circle = nurbsCircle();
+		for (double tolerance : { 1e-2, 1e-4, 1e-6 }) {
+			polygon_t points = tessellateNurbs(circle, tolerance);
+			REQUIRE(points.front() == point_t(1, 0));
+			REQUIRE(glm::distance(points.back(), point_t(1, 0)) < 1e-15);
+			for (size_t k = 0; k + 1 < points.size(); k++) {
+				// how far the middle of the arc over the chord lies from it
+				double half = glm::distance(points[k], points[k + 1]) / 2.0;
+				REQUIRE(1.0 - sqrt(1.0 - half * half) <= tolerance * 1.01);
+			}
+			// not much finer than needed
+			size_t enough = (size_t)ceil(3.14159265358979323846 / acos(1.0 - tolerance));
+			REQUIRE(points.size() < 3 * enough + 40);
+		}
+	}
+
+	TEST_CASE("nurbs_edges", "[nurbs]") {
+		shared_ptr<NesterNurbs> arc = make_shared<NesterNurbs>();
+		double h = sqrt(0.5);
+		arc->addControlPoint(1, 0);
+		arc->addControlPoint(1, 1, h);
+		arc->addControlPoint(0, 1);
+		arc->addKnots({ 0, 0, 0, 1, 1, 1 });
+		arc->setTolerance(1e-5);
+
+		BoundingBox bb = arc->getBoundingBox();
+		REQUIRE(bb.minX == 0.0);
+		REQUIRE(bb.maxX == 1.0);
+		REQUIRE(bb.maxY == 1.0);
+
+		shared_ptr<NesterLine> back = make_shared<NesterLine>();
+		back->setStartPoint(point_t(0, 1));
+		back->setEndPoint(point_t(1, 0));
+		NesterLoop loop;
+		loop.addEdge(arc);
+		loop.addEdge(back);
+		polygon_p polygon = loop.toPolygon();
+		polygon_t polyline = arc->toPolyline();
+		REQUIRE(polygon->size() == polyline.size());
+		for (size_t k = 0; k + 1 < polyline.size(); k++) {
+			REQUIRE((*polygon)[k] == polyline[k]);
+			REQUIRE(fabs(glm::length(polyline[k]) - 1.0) < 1e-12);
+		}
+		REQUIRE((*polygon).back() == point_t(0, 1));
+
+		// a quarter disc less the triangle
+		double area = 0.0;
+		for (size_t k = 0; k < polygon->size(); k++) {
+			point_t a = (*polygon)[k], b = (*polygon)[(k + 1) % polygon->size()];
+			area += a.x * b.y - a.y * b.x;
+		}
+		REQUIRE(fabs(area / 2.0 - (3.14159265358979323846 / 4.0 - 0.5)) < 1e-4);
+	}
+
+	TEST_CASE("nurbs_reversed", "[nurbs]") {
+		// a rational cubic with uneven knots, so mirroring them matters
+		shared_ptr<NesterNurbs> spline = make_shared<NesterNurbs>();
+		spline->addControlPoint(0, 0);
+		spline->addControlPoint(1, 3, 2.0);
+		spline->addControlPoint(3, 3);
+		spline->addControlPoint(4, -1, 0.5);
+		spline->addControlPoint(6, 1);
+		spline->addKnots({ 0, 0, 0, 0, 0.2, 1, 1, 1, 1 });
+		spline->setTolerance(1e-4);
+		polygon_t forward = spline->toPolyline();
+		REQUIRE(spline->getStartPoint() == forward.front());
+		REQUIRE(spline->getEndPoint() == forward.back());
+
+		shared_ptr<NesterNurbs> backward = spline->reversed();
+		REQUIRE(glm::distance(backward->getStartPoint(), spline->getEndPoint()) < 1e-12);
+		REQUIRE(glm::distance(backward->getEndPoint(), spline->getStartPoint()) < 1e-12);
+		// the points of one tessellation are within the tolerance of the other
+		for (const point_t& p : backward->toPolyline()) {
+			double nearest = numeric_limits<double>::max();
+			for (size_t k = 0; k + 1 < forward.size(); k++) {
+				point_t d = forward[k + 1] - forward[k];
+				double t = max(0.0, min(1.0, glm::dot(p - forward[k], d) / glm::dot(d, d)));
+				nearest = min(nearest, glm::distance(p, forward[k] + d * t));
+			}
+			REQUIRE(nearest < 2e-4);
+		}
+
+		// without a valid knot vector the ends are those of the control polygon
+		shared_ptr<NesterNurbs> broken = make_shared<NesterNurbs>();
+		broken->addControlPoint(1, 2);
+		broken->addControlPoint(3, 4);
+		REQUIRE(broken->getStartPoint() == point_t(1, 2));
+		REQUIRE(broken->getEndPoint() == point_t(3, 4));
+	}
+
+	TEST_CASE("nurbs_benchmark", "[.][benchmark]") {
+		mt19937 random(3);
+		uniform_real_distribution<double> coordinate(-10.0, 10.0);
+		NurbsCurve spline;
+		for (int i = 0; i < 200; i++) {
+			spline.controlPoints.push_back(point_t(coordinate(random), coordinate(random)));
+		}
+		spline.knots = { 0, 0, 0, 0 };
+		for (int i = 1; i < 197; i++) {
+			spline.knots.push_back(i);
+		}
+		spline.knots.insert(spline.knots.end(), { 197, 197, 197, 197 });
+		REQUIRE(spline.isValid());
+
+		vector<double> parameters;
+		for (int i = 0; i <= 2000000; i++) {
+			parameters.push_back(197.0 * i / 2000000);
+		}
+		polygon_t points;
+		auto started = chrono::steady_clock::now();
+		evaluateNurbs(spline, parameters, points);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "evaluated " << parameters.size() << " spline points in " << ms << " ms" << endl;
+		REQUIRE(points.size() == parameters.size());
+	}
+
+}
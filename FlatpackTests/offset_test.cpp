@@ -0,0 +1,102 @@
+#include <cmath>
+#include <limits>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/Offset.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// the distance from p to the boundary of the ring
+	double boundaryDistance(point_t p, const polygon_t& ring) {
+		double distance = numeric_limits<double>::infinity();
+		for (size_t i = 0; i < ring.size(); i++) {
+			point_t a = ring[i], b = ring[(i + 1) % ring.size()];
+			double t = max(0.0, min(1.0, glm::dot(p - a, b - a) / glm::dot(b - a, b - a)));
+			distance = min(distance, glm::length(a + t * (b - a) - p));
+		}
+		return distance;
+	}
+
+	TEST_CASE("offset_joins", "[offset]") {
+		// clockwise input is fine, the result is counter clockwise
+		polygon_t ring = square(0, 0, 2);
+		makeClockwise(ring);
+
+		vector<polygon_t> mitered = offsetRing(ring, 0.5, JOIN_MITER);
+		REQUIRE(mitered.size() == 1);
+		REQUIRE(mitered[0].size() == 4);
+		REQUIRE(signedArea(mitered[0]) == Approx(9.0));
+
+		vector<polygon_t> rounded = offsetRing(ring, 0.5, JOIN_ROUND);
+		REQUIRE(rounded.size() == 1);
+		const double pi = 3.14159265358979323846;
+		REQUIRE(signedArea(rounded[0]) > 4.0 + 4.0 * 0.5 * 2.0 + pi * 0.25);
+		REQUIRE(signedArea(rounded[0]) < 9.0);
+		for (const point_t& p : rounded[0]) {
+			REQUIRE(boundaryDistance(p, ring) >= 0.5 - 1e-4);
+			REQUIRE(boundaryDistance(p, ring) <= 0.5 + OFFSET_ARC_TOLERANCE + 1e-4);
+		}
+
+		// a sharp spike is cut off square at the miter limit, instead of reaching out 2 cm
+		polygon_t spike = { point_t(0, 0), point_t(10, 0), point_t(0, 1) };
+		vector<polygon_t> cut = offsetRing(spike, 0.1, JOIN_MITER);
+		REQUIRE(cut.size() == 1);
+		REQUIRE((double)getBoundingBox(cut[0]).maxX < 10.0 + 1.5 * OFFSET_MITER_LIMIT * 0.1);
+
+		// shrinking by more than half the width leaves nothing, a narrow waist splits the ring
+		REQUIRE(offsetRing(ring, -1.1, JOIN_MITER).empty());
+		polygon_t dumbbell = { point_t(0, 0), point_t(3, 0), point_t(3, 1.4), point_t(4, 1.4), point_t(4, 0), point_t(7, 0),
+			point_t(7, 3), point_t(4, 3), point_t(4, 1.6), point_t(3, 1.6), point_t(3, 3), point_t(0, 3) };
+		vector<polygon_t> halves = offsetRing(dumbbell, -0.5, JOIN_ROUND);
+		REQUIRE(halves.size() == 2);
+		for (const polygon_t& half : halves) {
+			REQUIRE(signedArea(half) == Approx(4.0));
+		}
+	}
+
+	TEST_CASE("part_offsets", "[offset]") {
+		NesterPart_p part = linePart(square(0, 0, 10), { square(2, 2, 6) });
+
+		PartOffset_p offset = part->getOffset(0.25, JOIN_MITER);
+		REQUIRE(signedArea(offset->outer) == Approx(10.5 * 10.5));
+		REQUIRE(offset->holes.size() == 1);
+		REQUIRE(signedArea(offset->holes[0]) == Approx(5.5 * 5.5));
+		// computed once for the same offset
+		REQUIRE(part->getOffset(0.25, JOIN_MITER) == offset);
+		REQUIRE(part->getOffset(0.25, JOIN_ROUND) != offset);
+	}
+
+	TEST_CASE("kerf_nesting", "[offset]") {
+		Nester nester;
+		nester.setSheetWidth(20.0);
+		nester.setSpacing(0.2);
+		nester.setKerf(0.3);
+		for (int i = 0; i < 6; i++) {
+			nester.addPart(linePart({ point_t(0, 0), point_t(4, 0), point_t(0, 3) }));
+		}
+		nester.run();
+
+		// every vertex keeps the kerf plus the spacing from every other part
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 6);
+		for (size_t i = 0; i < placements.size(); i++) {
+			polygon_t a = transformPolygon(*placements[i].part->toPolygon(), placements[i].transformer);
+			for (size_t j = 0; j < placements.size(); j++) {
+				if (i == j) {
+					continue;
+				}
+				polygon_t b = transformPolygon(*placements[j].part->toPolygon(), placements[j].transformer);
+				for (const point_t& p : a) {
+					REQUIRE(!pointInPolygon(p, b));
+					REQUIRE(boundaryDistance(p, b) >= 0.5 - 1e-3);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#include <cmath>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/PartShape.hpp"
+#include "../Nester/RectanglePacker.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	polygon_t tiltedRectangle(double w, double h, double angle) {
+		polygon_t ring = { point_t(0, 0), point_t(w, 0), point_t(w, h), point_t(0, h) };
+		return transformPolygon(ring, makeTransformation(angle, 3.0, -2.0));
+	}
+
+	TEST_CASE("minimum_area_rectangle", "[orientation]") {
+		// turning back by the tilt, or on by the rest of a quarter turn, both lie the rectangle flat
+		double angle = minimumAreaAngle(tiltedRectangle(4.0, 1.0, 30.0));
+		REQUIRE(angle == Approx(60.0));
+		BoundingBox bb = getBoundingBox(transformPolygon(tiltedRectangle(4.0, 1.0, 30.0), makeTransformation(angle, 0.0, 0.0)));
+		REQUIRE((double)(bb.width() * bb.height()) == Approx(4.0));
+
+		// parts already as small as they get stay as drawn, even when another turn is just as good
+		REQUIRE(minimumAreaAngle(tiltedRectangle(4.0, 1.0, 0.0)) == 0.0);
+		REQUIRE(minimumAreaAngle({ point_t(0, 0), point_t(3, 0), point_t(0, 4) }) == 0.0);
+
+		// concave outlines are measured by their hull
+		polygon_t l = { point_t(0, 0), point_t(6, 0), point_t(6, 1), point_t(1, 1), point_t(1, 6), point_t(0, 6) };
+		REQUIRE(minimumAreaAngle(l) == 0.0);
+		REQUIRE(minimumAreaAngle(transformPolygon(l, makeTransformation(-20.0, 0.0, 0.0))) == Approx(20.0));
+	}
+
+	TEST_CASE("upright_orientations", "[orientation]") {
+		vector<PartShape> shapes = makePartShapes({ linePart(tiltedRectangle(4.0, 1.0, 30.0)) }, 4);
+		REQUIRE(shapes[0].upright == Approx(60.0));
+		REQUIRE(shapes[0].orientations[1].angle == Approx(150.0));
+		const BoundingBox& first = shapes[0].orientations[0].bounds;
+		REQUIRE((double)(first.width() * first.height()) == Approx(4.0));
+		REQUIRE((double)shapes[0].orientations[1].bounds.width() == Approx((double)first.height()));
+		REQUIRE(isNearlyRectangular(shapes[0], 1e-6));
+	}
+
+	TEST_CASE("upright_shelves", "[orientation]") {
+		// ten tilted bars lie flat in two columns across the sheet
+		Nester nester;
+		nester.setSheetWidth(10.0);
+		nester.setSpacing(0.0);
+		nester.setStrategy(STRATEGY_SHELF);
+		for (int i = 0; i < 10; i++) {
+			nester.addPart(linePart(tiltedRectangle(4.0, 1.0, 10.0 * i)));
+		}
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 10);
+		double length = 0.0;
+		for (const Placement& p : placements) {
+			BoundingBox bb = getBoundingBox(transformPolygon(*p.part->toPolygon(), p.transformer));
+			REQUIRE((double)(bb.width() * bb.height()) == Approx(4.0));
+			length = max(length, (double)bb.maxY);
+		}
+		REQUIRE(length == Approx(5.0));
+	}
+	TEST_CASE("tilted_parts_nest_apart", "[orientation]") {
+		// L shapes drawn at an angle are turned upright before nesting, and the no-fit polygons are built
+		// from the upright outlines, so the parts must not overlap in any strategy
+		polygon_t l = { point_t(0, 0), point_t(6, 0), point_t(6, 1.5), point_t(1.5, 1.5), point_t(1.5, 4), point_t(0, 4) };
+		polygon_t tilted = transformPolygon(l, makeTransformation(30.0, 5.0, 2.0));
+		for (NestingStrategy strategy : { STRATEGY_BOTTOM_LEFT, STRATEGY_ANNEALING }) {
+			Nester nester;
+			nester.setSheetWidth(14.0);
+			nester.setSpacing(0.1);
+			nester.setRotations(4);
+			nester.setStrategy(strategy);
+			nester.setSearch(strategy == STRATEGY_ANNEALING ? 0.5 : 0.0, 3);
+			for (int i = 0; i < 8; i++) {
+				nester.addPart(linePart(tilted));
+			}
+			nester.run();
+			REQUIRE(nester.getPlacements().size() == 8);
+			REQUIRE(nester.verify().empty());
+		}
+	}
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/Predicates.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	int sign(double value) {
+		return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+	}
+
+	int sign(__int128 value) {
+		return value > 0 ? 1 : (value < 0 ? -1 : 0);
+	}
+
+	TEST_CASE("orient2d_near_collinear", "[predicates]") {
+		// Kettner's example: points a few ulps off the line through (12, 12) and (24, 24). Scaled by 2^53
+		// every coordinate is an integer, so the exact answer is known.
+		point_t q(12.0, 12.0), r(24.0, 24.0);
+		const double ulp = ldexp(1.0, -53);
+		int wrong = 0;
+		for (int i = 0; i < 256; i++) {
+			for (int j = 0; j < 256; j++) {
+				point_t p(0.5 + i * ulp, 0.5 + j * ulp);
+				__int128 px = (__int128)ldexp(p.x, 53), py = (__int128)ldexp(p.y, 53);
+				__int128 qx = (__int128)ldexp(q.x, 53), rx = (__int128)ldexp(r.x, 53);
+				__int128 exact = (px - rx) * (qx - rx) - (py - rx) * (qx - rx);
+				REQUIRE(sign(orient2d(p, q, r)) == sign(exact));
+				wrong += sign(cross(r, p, q)) != sign(exact);
+			}
+		}
+		// plain floating point gets many of these wrong
+		REQUIRE(wrong > 0);
+	}
+
+	TEST_CASE("incircle_cocircular", "[predicates]") {
+		// on the circle of radius 5 around (2^30, -3), with every coordinate exact
+		double cx = ldexp(1.0, 30), cy = -3.0;
+		point_t a(cx + 5, cy), b(cx + 3, cy + 4), c(cx - 4, cy + 3), d(cx, cy - 5);
+		REQUIRE(incircle(a, b, c, d) == 0.0);
+		REQUIRE(incircle(a, b, c, point_t(d.x, nextafter(d.y, 0.0))) > 0.0);
+		REQUIRE(incircle(a, b, c, point_t(d.x, nextafter(d.y, -1e9))) < 0.0);
+		REQUIRE(incircle(a, b, c, point_t(cx, cy)) > 0.0);
+
+		// random small integer points, with the determinant exact in 128 bits
+		mt19937 random(3);
+		uniform_int_distribution<int> coordinate(-20, 20);
+		for (int round = 0; round < 2000; round++) {
+			long long p[8];
+			for (long long& v : p) {
+				v = coordinate(random);
+			}
+			__int128 adx = p[0] - p[6], ady = p[1] - p[7], bdx = p[2] - p[6], bdy = p[3] - p[7], cdx = p[4] - p[6], cdy = p[5] - p[7];
+			__int128 exact = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+				(cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+			double shift = ldexp(1.0, 26);
+			point_t pa(p[0] + shift, p[1] + shift), pb(p[2] + shift, p[3] + shift), pc(p[4] + shift, p[5] + shift), pd(p[6] + shift, p[7] + shift);
+			REQUIRE(sign(incircle(pa, pb, pc, pd)) == sign(exact));
+		}
+	}
+
+	TEST_CASE("segment_predicates", "[predicates]") {
+		point_t a(0, 0), b(4, 4);
+		REQUIRE(segmentsCross(a, b, point_t(0, 4), point_t(4, 0)));
+		REQUIRE(segmentsIntersect(a, b, point_t(0, 4), point_t(4, 0)));
+
+		// touching at an end point or overlapping along the line is no crossing
+		REQUIRE_FALSE(segmentsCross(a, b, point_t(2, 2), point_t(4, 0)));
+		REQUIRE(segmentsIntersect(a, b, point_t(2, 2), point_t(4, 0)));
+		REQUIRE_FALSE(segmentsCross(a, b, point_t(1, 1), point_t(6, 6)));
+		REQUIRE(segmentsIntersect(a, b, point_t(1, 1), point_t(6, 6)));
+		REQUIRE_FALSE(segmentsIntersect(a, b, point_t(5, 5), point_t(6, 6)));
+
+		// one ulp short of the other segment decides
+		point_t from(0.125, 0.875), to(0.875, 0.125);
+		point_t on(0.375, 0.625);
+		REQUIRE(orient2d(from, to, on) == 0.0);
+		REQUIRE(segmentsIntersect(from, to, point_t(0.0, 0.0), on));
+		REQUIRE_FALSE(segmentsCross(from, to, point_t(0.0, 0.0), on));
+		point_t shy(nextafter(on.x, 0.0), on.y);
+		REQUIRE(orient2d(from, to, shy) < 0.0);
+		REQUIRE_FALSE(segmentsIntersect(from, to, point_t(0.0, 0.0), shy));
+	}
+
+	// a convex part of the given number of corners around a random circle
+	NesterPart_p predicatePart(mt19937& random, int corners) {
+		uniform_real_distribution<double> radius(0.5, 2.0), turn(0.0, 6.283185307179586);
+		double r = radius(random), start = turn(random);
+		shared_ptr<NesterLoop> loop = make_shared<NesterLoop>();
+		polygon_t ring;
+		for (int k = 0; k <= corners; k++) {
+			double a = start + 6.283185307179586 * (k % corners) / corners;
+			ring.push_back(point_t(r * cos(a), r * (0.6 + 0.4 * (k % 2)) * sin(a)));
+		}
+		loop->addLines(ring);
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(loop);
+		return part;
+	}
+
+	TEST_CASE("predicates_benchmark", "[.][benchmark]") {
+		// the filter against the plain determinant on points in general position
+		mt19937 random(7);
+		uniform_real_distribution<double> coordinate(-100.0, 100.0);
+		vector<point_t> points;
+		for (int i = 0; i < 3000000; i++) {
+			points.push_back(point_t(coordinate(random), coordinate(random)));
+		}
+		auto started = chrono::steady_clock::now();
+		int plain = 0;
+		for (size_t i = 0; i + 2 < points.size(); i++) {
+			plain += sign(cross(points[i], points[i + 1], points[i + 2]));
+		}
+		double plainMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		started = chrono::steady_clock::now();
+		int adaptive = 0;
+		for (size_t i = 0; i + 2 < points.size(); i++) {
+			adaptive += sign(orient2d(points[i], points[i + 1], points[i + 2]));
+		}
+		double adaptiveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << points.size() - 2 << " orientations: plain " << plainMs << " ms, orient2d " << adaptiveMs << " ms" << endl;
+		REQUIRE(plain == adaptive);
+
+		// the nesting the predicates are used in
+		Nester nester;
+		nester.setSheetWidth(40.0);
+		for (int i = 0; i < 200; i++) {
+			nester.addPart(predicatePart(random, 5 + i % 6));
+		}
+		started = chrono::steady_clock::now();
+		nester.run();
+		double nestMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "nested 200 parts in " << nestMs << " ms" << endl;
+		REQUIRE(nester.getPlacements().size() == 200);
+	}
+}
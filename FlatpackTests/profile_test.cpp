@@ -0,0 +1,99 @@
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/InnerFitPolygon.hpp"
+#include "../Nester/Nester.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	bool insideFit(InnerFitCache& fits, size_t shape, size_t orientation, point_t p) {
+		const InnerFitPolygon& fit = fits.get(shape, orientation);
+		if (p.x < fit.xMin || p.x > fit.xMax || p.y < fit.yMin || p.y > fit.yMax) {
+			return false;
+		}
+		for (const NoFitPolygon& obstacle : fit.obstacles) {
+			if (obstacle.containsInterior(p)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TEST_CASE("inner_fit_polygon", "[profile]") {
+		// an L of 10 by 10 with a 4 by 4 hole in its foot
+		polygon_t l = { point_t(0, 0), point_t(10, 0), point_t(10, 4), point_t(4, 4), point_t(4, 10), point_t(0, 10) };
+		vector<PartShape> shapes = makePartShapes({ linePart(square(0, 0, 3)) }, 1);
+		InnerFitCache fits(shapes, l, { square(5, 0.5, 2) });
+
+		REQUIRE(insideFit(fits, 0, 0, point_t(0, 0)));
+		REQUIRE(insideFit(fits, 0, 0, point_t(1, 7)));
+		REQUIRE(insideFit(fits, 0, 0, point_t(7, 1)));
+		REQUIRE_FALSE(insideFit(fits, 0, 0, point_t(3, 3)));   // over the inner corner
+		REQUIRE_FALSE(insideFit(fits, 0, 0, point_t(6, 6)));   // off the stock
+		REQUIRE_FALSE(insideFit(fits, 0, 0, point_t(4, 0.5))); // over the defect
+		REQUIRE(&fits.get(0, 0) == &fits.get(0, 0));
+	}
+
+	TEST_CASE("profile_nesting", "[profile]") {
+		Nester nester;
+		nester.setSpacing(0.2);
+		polygon_t l = { point_t(20, 30), point_t(30, 30), point_t(30, 34), point_t(24, 34), point_t(24, 40), point_t(20, 40) };
+		nester.addStockProfile(linePart(l, { square(20.5, 30.5, 1) }), 1);
+		nester.addStockSheet(10.0, 10.0, -1);
+		for (int i = 0; i < 16; i++) {
+			nester.addPart(linePart(square(0, 0, 1.8)));
+		}
+		nester.run();
+
+		// the offcut is used first and takes squares all around the defect, the rest goes to a plain sheet
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 16);
+		REQUIRE(nester.getSheets().size() == 2);
+		REQUIRE(nester.getSheets()[0] == 0);
+		polygon_t moved = transformPolygon(l, makeTransformation(0.0, -20.0, -30.0));
+		BoundingBox defect = getBoundingBox(square(0.5, 0.5, 1));
+		size_t onProfile = 0;
+		for (const Placement& p : placements) {
+			if (p.sheet != 0) {
+				continue;
+			}
+			onProfile++;
+			BoundingBox bb = getBoundingBox(transformPolygon(*p.part->toPolygon(), p.transformer));
+			REQUIRE(pointInPolygon(point_t((double)(bb.minX + bb.maxX) / 2.0, (double)(bb.minY + bb.maxY) / 2.0), moved));
+			REQUIRE(bb.minX >= -1e-6);
+			REQUIRE(bb.minY >= -1e-6);
+			REQUIRE((bb.maxX <= 4.0 + 1e-6 || bb.maxY <= 4.0 + 1e-6));
+			REQUIRE((bb.minX >= defect.maxX - 1e-6 || bb.minY >= defect.maxY - 1e-6));
+		}
+		REQUIRE(onProfile >= 10);
+	}
+
+	TEST_CASE("tilted_stock_profile", "[profile]") {
+		// the corners of the room a part has on tilted stock are crossings of the NFP edges, none of them
+		// is a corner of an NFP
+		for (double angle : { 0.001, 7.0, 30.0 }) {
+			Nester nester;
+			nester.setSpacing(0.5);
+			polygon_t offcut = transformPolygon(square(0, 0, 5.5), makeTransformation(angle, 3.0, 4.0));
+			nester.addStockProfile(linePart(offcut), 1);
+			for (int i = 0; i < 4; i++) {
+				nester.addPart(linePart(square(0, 0, 2)));
+			}
+			nester.run();
+
+			const vector<Placement>& placements = nester.getPlacements();
+			REQUIRE(placements.size() >= (angle < 10.0 ? 4 : 3));
+			REQUIRE(nester.verify().empty());
+			BoundingBox bb = getBoundingBox(offcut);
+			polygon_t moved = transformPolygon(offcut, makeTransformation(0.0, -(double)bb.minX, -(double)bb.minY));
+			for (const Placement& p : placements) {
+				for (point_t corner : transformPolygon(*p.part->toPolygon(), p.transformer)) {
+					REQUIRE(pointInPolygon(corner, moved));
+				}
+			}
+		}
+	}
+}
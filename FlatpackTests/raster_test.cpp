@@ -0,0 +1,89 @@
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Bitboard.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	TEST_CASE("rasterize", "[raster]") {
+		// cell boundaries on the outline don't add a cell
+		Bitboard plain = rasterize(square(0.0, 0.0, 2.0), vector<polygon_t>(), point_t(0.0, 0.0), 1.0, 2, 2);
+		REQUIRE(plain.count() == 4);
+
+		// the cells the hole outline passes through stay occupied
+		Bitboard holed = rasterize(square(0.0, 0.0, 4.0), { square(1.0, 1.0, 2.0) }, point_t(0.0, 0.0), 0.5, 8, 8);
+		REQUIRE(holed.count() == 64 - 9);
+		REQUIRE_FALSE(holed.get(4, 4));
+		REQUIRE(holed.get(2, 4));
+
+		Bitboard grown = plain.dilated(1);
+		REQUIRE(grown.width() == 4);
+		REQUIRE(grown.count() == 16);
+		REQUIRE(grown.overlaps(plain, 2, 2));
+		REQUIRE_FALSE(plain.overlaps(plain, 2, 0));
+	}
+
+	TEST_CASE("bitboard_kernels", "[raster]") {
+		mt19937_64 random(7);
+		const size_t words = 11;
+		vector<uint64_t> in(words);
+		for (uint64_t& w : in) {
+			w = random() & random();
+		}
+		auto bit = [&](size_t i) {
+			return i < words * 64 && ((in[i / 64] >> (i % 64)) & 1);
+		};
+
+		for (size_t shift : { 0, 1, 63, 64, 65, 130, 700 }) {
+			vector<uint64_t> ored(words, 0), masked(words, ~(uint64_t)0);
+			orShiftedRight(ored.data(), words, in.data(), words, shift);
+			andNotShiftedRight(masked.data(), words, in.data(), words, shift);
+			for (size_t i = 0; i < words * 64; i++) {
+				bool expected = bit(i + shift);
+				REQUIRE((((ored[i / 64] >> (i % 64)) & 1) != 0) == expected);
+				REQUIRE((((masked[i / 64] >> (i % 64)) & 1) != 0) == !expected);
+			}
+		}
+
+		REQUIRE_FALSE(anySet(vector<uint64_t>(words, 0).data(), words));
+		vector<uint64_t> last(words, 0);
+		last[words - 1] = 1;
+		REQUIRE(anySet(last.data(), words));
+		REQUIRE(countBits(last.data(), words) == 1);
+	}
+
+	TEST_CASE("raster_nesting", "[raster]") {
+		Nester nester;
+		nester.setSheetWidth(10.0);
+		nester.setSpacing(0.2);
+		nester.setStrategy(STRATEGY_RASTER);
+		nester.setRasterResolution(0.1);
+		for (int i = 0; i < 12; i++) {
+			nester.addPart(linePart(square(20.0 * i, 0.0, 2.0 + i % 3)));
+		}
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 12);
+		vector<BoundingBox> boxes;
+		for (const Placement& p : placements) {
+			boxes.push_back(getBoundingBox(transformPolygon(*p.part->toPolygon(), p.transformer)));
+		}
+		for (size_t i = 0; i < boxes.size(); i++) {
+			REQUIRE(boxes[i].minX >= -1e-6);
+			REQUIRE(boxes[i].maxX <= 10.0 + 1e-6);
+			REQUIRE(boxes[i].minY >= -1e-6);
+			for (size_t j = i + 1; j < boxes.size(); j++) {
+				bool separate = boxes[i].maxX + 0.2 <= boxes[j].minX + 1e-6 || boxes[j].maxX + 0.2 <= boxes[i].minX + 1e-6 ||
+					boxes[i].maxY + 0.2 <= boxes[j].minY + 1e-6 || boxes[j].maxY + 0.2 <= boxes[i].minY + 1e-6;
+				REQUIRE(separate);
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/RectanglePacker.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	TEST_CASE("rectangle_detection", "[rectangle]") {
+		polygon_t notched = { point_t(0, 0), point_t(10, 0), point_t(10, 10), point_t(5.5, 10), point_t(5, 9.5), point_t(4.5, 10), point_t(0, 10) };
+		polygon_t l = { point_t(0, 0), point_t(3, 0), point_t(3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) };
+		vector<PartShape> shapes = makePartShapes({ linePart(rectangle(2, 3)), linePart(notched), linePart(l) }, 4);
+
+		REQUIRE(isNearlyRectangular(shapes[0], 0.0));
+		REQUIRE_FALSE(isNearlyRectangular(shapes[1], 0.0));
+		REQUIRE(isNearlyRectangular(shapes[1], 0.01));
+		REQUIRE_FALSE(isNearlyRectangular(shapes[2], 0.1));
+	}
+
+	TEST_CASE("maxrects_packing", "[rectangle]") {
+		// four squares fill the sheet exactly, the long bar only fits standing up next to them
+		vector<NesterPart_p> parts = { linePart(rectangle(5, 5)), linePart(rectangle(5, 5)), linePart(rectangle(5, 5)), linePart(rectangle(5, 5)), linePart(rectangle(10, 2)) };
+		vector<PartShape> shapes = makePartShapes(parts, 4);
+		RectanglePacker packer(shapes, 12.0, 0.0);
+		NestingResult result = packer.pack({ 0, 1, 2, 3, 4 });
+
+		REQUIRE(result.length == Approx(10.0));
+		REQUIRE(result.placements[4].orientation % 2 == 1);
+		for (size_t i = 0; i < 5; i++) {
+			const ShapePlacement& p = result.placements[i];
+			const BoundingBox& bb = shapes[p.shape].orientations[p.orientation].bounds;
+			REQUIRE(p.position.x + (double)bb.minX >= -1e-9);
+			REQUIRE(p.position.x + (double)bb.maxX <= 12.0 + 1e-9);
+		}
+	}
+
+	TEST_CASE("hybrid_nesting", "[rectangle]") {
+		Nester nester;
+		nester.setSheetWidth(8.0);
+		nester.setSpacing(0.1);
+		for (int i = 0; i < 5; i++) {
+			nester.addPart(linePart(rectangle(1.0 + i, 2.0)));
+		}
+		polygon_t l = { point_t(0, 0), point_t(6, 0), point_t(6, 2), point_t(2, 2), point_t(2, 6), point_t(0, 6) };
+		nester.addPart(linePart(l));
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 6);
+		polygon_t placedL;
+		vector<BoundingBox> boxes;
+		for (const Placement& p : placements) {
+			polygon_t outline = transformPolygon(*p.part->toPolygon(), p.transformer);
+			if (outline.size() == 6) {
+				placedL = outline;
+			}
+			else {
+				boxes.push_back(getBoundingBox(outline));
+			}
+		}
+
+		// the L is fitted around the rectangles which were packed first
+		REQUIRE(boxes.size() == 5);
+		for (const BoundingBox& bb : boxes) {
+			REQUIRE_FALSE(pointInPolygon(point_t((double)(bb.minX + bb.maxX) / 2.0, (double)(bb.minY + bb.maxY) / 2.0), placedL));
+			for (point_t p : placedL) {
+				REQUIRE_FALSE((p.x > bb.minX + 1e-6 && p.x < bb.maxX - 1e-6 && p.y > bb.minY + 1e-6 && p.y < bb.maxY - 1e-6));
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/SheetAssignment.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	TEST_CASE("first_fit_decreasing", "[sheets]") {
+		vector<NesterPart_p> parts = { linePart(rectangle(8, 8)), linePart(rectangle(6, 6)), linePart(rectangle(5, 5)),
+			linePart(rectangle(3, 3)), linePart(rectangle(30, 1)), linePart(rectangle(9.5, 9.5)) };
+		vector<PartShape> shapes = makePartShapes(parts, 4);
+		vector<StockSheet> stock = { { 10.0, 10.0, 2, nullptr }, { 20.0, 20.0, -1, nullptr } };
+		vector<int> remaining = { 2, -1 };
+		vector<size_t> unassigned;
+		vector<SheetAssignment> sheets = assignSheets(shapes, { 0, 1, 2, 5, 3, 4 }, stock, remaining, 0.0, unassigned);
+
+		// the 5x5 joins the 6x6 on the second small sheet, the 9.5x9.5 needs a large one after the small
+		// ones ran out and the 3x3 still fits next to the 8x8
+		REQUIRE(sheets.size() == 3);
+		REQUIRE(sheets[0].stock == 0);
+		REQUIRE(sheets[0].shapes == vector<size_t>({ 0, 3 }));
+		REQUIRE(sheets[1].shapes == vector<size_t>({ 1, 2 }));
+		REQUIRE(sheets[2].stock == 1);
+		REQUIRE(sheets[2].shapes == vector<size_t>({ 5 }));
+		REQUIRE(remaining[0] == 0);
+		REQUIRE(unassigned == vector<size_t>({ 4 }));
+	}
+
+	TEST_CASE("multi_sheet_nesting", "[sheets]") {
+		Nester nester;
+		nester.setSpacing(0.5);
+		nester.addStockSheet(10.0, 10.0, 5);
+		for (int i = 0; i < 12; i++) {
+			nester.addPart(linePart(rectangle(4.0, 4.0)));
+		}
+		polygon_t l = { point_t(0, 0), point_t(6, 0), point_t(6, 2), point_t(2, 2), point_t(2, 6), point_t(0, 6) };
+		nester.addPart(linePart(l));
+		nester.addPart(linePart(rectangle(12.0, 12.0)));
+		nester.run();
+
+		// four squares fit a sheet. The L is assigned three, one of which does not fit next to it and
+		// moves on to a sheet of its own. The oversized part fits no sheet.
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 13);
+		REQUIRE(nester.getSheets().size() == 5);
+		vector<NesterPart_p> unplaced = nester.getUnplaced();
+		REQUIRE(unplaced.size() == 1);
+		REQUIRE(unplaced[0]->getBoundingBox().width() == 12.0);
+		for (size_t i = 0; i < placements.size(); i++) {
+			polygon_t a = transformPolygon(*placements[i].part->toPolygon(), placements[i].transformer);
+			BoundingBox bb = getBoundingBox(a);
+			REQUIRE(placements[i].sheet < 5);
+			REQUIRE(bb.minX >= -1e-6);
+			REQUIRE(bb.minY >= -1e-6);
+			REQUIRE(bb.maxX <= 10.0 + 1e-6);
+			REQUIRE(bb.maxY <= 10.0 + 1e-6);
+			for (size_t j = i + 1; j < placements.size(); j++) {
+				if (placements[i].sheet != placements[j].sheet) {
+					continue;
+				}
+				polygon_t b = transformPolygon(*placements[j].part->toPolygon(), placements[j].transformer);
+				for (point_t p : b) {
+					bool inside = p.x > bb.minX + 1e-6 && p.x < bb.maxX - 1e-6 && p.y > bb.minY + 1e-6 && p.y < bb.maxY - 1e-6;
+					REQUIRE_FALSE((inside && pointInPolygon(p, a)));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/ShelfPacker.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	BoundingBox box(double w, double h) {
+		BoundingBox bb;
+		bb.minX = 1.0;
+		bb.minY = 2.0;
+		bb.maxX = 1.0 + w;
+		bb.maxY = 2.0 + h;
+		return bb;
+	}
+
+	TEST_CASE("shelf_heuristics", "[shelf]") {
+		vector<BoundingBox> boxes = { box(3.0, 2.0), box(6.0, 4.0), box(6.0, 5.0), box(3.0, 3.0) };
+
+		// next fit opens a third shelf for the smallest box, first fit finds room next to the tallest
+		ShelfLayout nextFit = ShelfPacker(10.0, 0.0, SHELF_NEXT_FIT).pack(boxes);
+		ShelfLayout firstFit = ShelfPacker(10.0, 0.0, SHELF_FIRST_FIT).pack(boxes);
+		REQUIRE(nextFit.length == Approx(11.0));
+		REQUIRE(firstFit.length == Approx(9.0));
+		REQUIRE(firstFit.placements[2].position == point_t(0.0, 0.0));
+		REQUIRE(firstFit.placements[3].position == point_t(6.0, 0.0));
+
+		// a tall box lies down, one too wide for the sheet stands up
+		ShelfLayout turned = ShelfPacker(10.0, 0.0, SHELF_FIRST_FIT).pack({ box(2.0, 8.0), box(12.0, 1.0) });
+		REQUIRE(turned.placements[0].rotated);
+		REQUIRE(turned.placements[1].rotated);
+	}
+
+	TEST_CASE("shelf_nesting", "[shelf]") {
+		Nester nester;
+		nester.setSheetWidth(20.0);
+		nester.setSpacing(0.5);
+		nester.setStrategy(STRATEGY_SHELF);
+		for (int i = 0; i < 30; i++) {
+			double w = 1.0 + i % 4;
+			double h = 1.0 + i % 7;
+			nester.addPart(linePart(rectangle(-5.0, 3.0, w, h)));
+		}
+		nester.run();
+
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 30);
+		vector<BoundingBox> boxes;
+		for (const Placement& p : placements) {
+			boxes.push_back(getBoundingBox(transformPolygon(*p.part->toPolygon(), p.transformer)));
+		}
+		for (size_t i = 0; i < boxes.size(); i++) {
+			REQUIRE(boxes[i].minX >= -1e-6);
+			REQUIRE(boxes[i].maxX <= 20.0 + 1e-6);
+			REQUIRE(boxes[i].minY >= -1e-6);
+			REQUIRE(boxes[i].height() <= boxes[i].width() + 1e-6);
+			for (size_t j = i + 1; j < boxes.size(); j++) {
+				bool separate = boxes[i].maxX + 0.5 <= boxes[j].minX + 1e-6 || boxes[j].maxX + 0.5 <= boxes[i].minX + 1e-6 ||
+					boxes[i].maxY + 0.5 <= boxes[j].minY + 1e-6 || boxes[j].maxY + 0.5 <= boxes[i].minY + 1e-6;
+				REQUIRE(separate);
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#include <cmath>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Nester.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	const double SIMPLIFY_PI = 3.14159265358979323846;
+
+	// a finely tessellated disc with a square bite out of its right side
+	polygon_t bittenDisc(double radius, size_t points) {
+		polygon_t ring;
+		for (size_t k = 0; k < points; k++) {
+			double a = 0.2 + (2.0 * SIMPLIFY_PI - 0.4) * k / (points - 1);
+			ring.push_back(point_t(radius * cos(a), radius * sin(a)));
+		}
+		ring.push_back(point_t(radius * cos(0.2) - 1.0, -radius * sin(0.2)));
+		ring.push_back(point_t(radius * cos(0.2) - 1.0, radius * sin(0.2)));
+		return ring;
+	}
+
+	double ringDistance(point_t p, const polygon_t& ring) {
+		double distance = INFINITY;
+		for (size_t i = 0; i < ring.size(); i++) {
+			point_t a = ring[i], b = ring[(i + 1) % ring.size()];
+			double t = max(0.0, min(1.0, glm::dot(p - a, b - a) / glm::dot(b - a, b - a)));
+			distance = min(distance, glm::length(a + t * (b - a) - p));
+		}
+		return distance;
+	}
+
+	TEST_CASE("douglas_peucker", "[simplify]") {
+		polygon_t line = { point_t(0, 0), point_t(1, 0.01), point_t(2, -0.01), point_t(3, 0.5), point_t(4, 0) };
+		polygon_t simplified = simplifyPolyline(line, 0.05);
+		REQUIRE(simplified == polygon_t({ point_t(0, 0), point_t(2, -0.01), point_t(3, 0.5), point_t(4, 0) }));
+
+		polygon_t disc = bittenDisc(10.0, 5000);
+		polygon_t coarse = simplifyRing(disc, 0.01);
+		REQUIRE(coarse.size() < 200);
+		REQUIRE(coarse.size() > 20);
+		for (point_t p : disc) {
+			REQUIRE(ringDistance(p, coarse) <= 0.01 + 1e-9);
+		}
+		// the corners of the bite are kept
+		REQUIRE(find(coarse.begin(), coarse.end(), disc[5000]) != coarse.end());
+		REQUIRE(find(coarse.begin(), coarse.end(), disc[5001]) != coarse.end());
+	}
+
+	TEST_CASE("loop_simplification", "[simplify]") {
+		polygon_t disc = bittenDisc(10.0, 5000);
+		shared_ptr<NesterLoop> loop = lineLoop(disc);
+		loop->simplify(0.01);
+		polygon_p points = loop->toPolygon();
+		REQUIRE(points->size() < 200);
+		for (point_t p : disc) {
+			REQUIRE(ringDistance(p, *points) <= 0.01 + 1e-9);
+		}
+		// still closed
+		BoundingBox before = getBoundingBox(disc), after = loop->getBoundingBox();
+		REQUIRE((double)after.width() == Approx((double)before.width()).margin(0.01));
+	}
+
+	TEST_CASE("coarse_nesting_outlines", "[simplify]") {
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(lineLoop(bittenDisc(10.0, 5000)));
+		part->addInnerRing(lineLoop(bittenDisc(3.0, 2000)));
+
+		// the coarse outline holds the part and its hole stays inside the hole
+		PartOffset_p coarse = part->getOffset(0.0, JOIN_MITER, 0.05);
+		polygon_p outline = part->toPolygon();
+		polygon_p hole = part->toHolePolygons()[0];
+		REQUIRE(coarse->outer.size() < 100);
+		for (point_t p : *outline) {
+			REQUIRE(pointInPolygon(p, coarse->outer));
+		}
+		REQUIRE(coarse->holes.size() == 1);
+		for (point_t p : coarse->holes[0]) {
+			REQUIRE(pointInPolygon(p, *hole));
+		}
+
+		// nested by their coarse outlines, parts keep their full outlines for writing
+		Nester nester;
+		nester.setSheetWidth(45.0);
+		nester.setSpacing(0.1);
+		nester.setNestingTolerance(0.05);
+		for (int i = 0; i < 4; i++) {
+			NesterPart_p p = make_shared<NesterPart>();
+			p->setOuterRing(lineLoop(bittenDisc(10.0, 5000)));
+			nester.addPart(p);
+		}
+		nester.run();
+		const vector<Placement>& placements = nester.getPlacements();
+		REQUIRE(placements.size() == 4);
+		for (size_t i = 0; i < placements.size(); i++) {
+			polygon_t a = transformPolygon(*placements[i].part->toPolygon(), placements[i].transformer);
+			REQUIRE(a.size() == 5002);
+			for (size_t j = i + 1; j < placements.size(); j++) {
+				polygon_t b = transformPolygon(*placements[j].part->toPolygon(), placements[j].transformer);
+				for (size_t k = 0; k < b.size(); k += 50) {
+					REQUIRE((!pointInPolygon(b[k], a) && ringDistance(b[k], a) >= 0.1 - 1e-6));
+				}
+			}
+		}
+	}
+}
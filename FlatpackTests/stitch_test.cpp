@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/Stitching.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	// the arc strokes of a circle, each run in a random direction, shuffled and with noisy ends
+	vector<polygon_t> circleStrokes(size_t count, size_t points, double noise, unsigned seed) {
+		mt19937 random(seed);
+		uniform_real_distribution<double> jitter(-noise, noise);
+		vector<polygon_t> strokes;
+		for (size_t s = 0; s < count; s++) {
+			polygon_t stroke;
+			for (size_t k = 0; k <= points; k++) {
+				double a = 2.0 * 3.14159265358979323846 * (s * points + k) / (count * points);
+				stroke.push_back(point_t(10.0 * cos(a), 10.0 * sin(a)));
+			}
+			stroke.front() += point_t(jitter(random), jitter(random));
+			stroke.back() += point_t(jitter(random), jitter(random));
+			if (random() % 2) {
+				reverse(stroke.begin(), stroke.end());
+			}
+			strokes.push_back(stroke);
+		}
+		shuffle(strokes.begin(), strokes.end(), random);
+		return strokes;
+	}
+
+	TEST_CASE("stitch_square", "[stitch]") {
+		vector<polygon_t> strokes = {
+			{ point_t(1.0, 0.0), point_t(1.0, 1.0) },
+			{ point_t(0.0, 0.0000004), point_t(1.0000003, 0.0) },
+			{ point_t(0.0, 1.0), point_t(0.0, 0.0) },
+			{ point_t(0.0, 1.0000002), point_t(0.9999998, 1.0) }
+		};
+		StitchedRing stitched = stitchStrokes(strokes, 1e-6);
+
+		REQUIRE(stitched.gaps.empty());
+		REQUIRE(stitched.ring.size() == 4);
+		REQUIRE(fabs(fabs(signedArea(stitched.ring)) - 1.0) < 1e-5);
+		// every corner follows its neighbour along a side
+		for (size_t k = 0; k < 4; k++) {
+			REQUIRE(fabs(glm::distance(stitched.ring[k], stitched.ring[(k + 1) % 4]) - 1.0) < 1e-5);
+		}
+
+		// each stroke starts where the ring reaches it
+		REQUIRE(stitched.order.size() == 4);
+		for (size_t k = 0; k < 4; k++) {
+			const polygon_t& stroke = strokes[stitched.order[k].stroke];
+			REQUIRE(glm::distance(stitched.ring[k], stitched.order[k].reversed ? stroke.back() : stroke.front()) <= 1e-6);
+		}
+	}
+
+	TEST_CASE("stitch_gaps", "[stitch]") {
+		vector<polygon_t> strokes = {
+			{ point_t(0.0, 0.0), point_t(1.0, 0.0) },
+			{ point_t(1.0, 0.0), point_t(1.0, 1.0) },
+			{ point_t(0.0, 1.0), point_t(0.0, 0.0) }
+		};
+		StitchedRing stitched = stitchStrokes(strokes, 1e-6);
+
+		REQUIRE(stitched.ring.size() == 4);
+		REQUIRE(stitched.gaps.size() == 1);
+		REQUIRE(fabs(glm::distance(stitched.gaps[0].from, stitched.gaps[0].to) - 1.0) < 1e-9);
+		REQUIRE(fabs(fabs(signedArea(stitched.ring)) - 1.0) < 1e-9);
+
+		// a stroke which cannot join in is reached over a gap there and another back
+		strokes.push_back({ point_t(0.0, 1.0), point_t(1.0, 1.0) });
+		strokes.push_back({ point_t(5.0, 5.0), point_t(6.0, 5.0) });
+		stitched = stitchStrokes(strokes, 1e-6);
+		REQUIRE(stitched.gaps.size() == 2);
+	}
+
+	TEST_CASE("stitch_shuffled_circle", "[stitch]") {
+		vector<polygon_t> strokes = circleStrokes(2000, 8, 1e-5, 7);
+		StitchedRing stitched = stitchStrokes(strokes, 1e-4);
+
+		REQUIRE(stitched.gaps.empty());
+		REQUIRE(stitched.ring.size() == 2000 * 8);
+		double circle = 3.14159265358979323846 * 100.0;
+		REQUIRE(fabs(fabs(signedArea(stitched.ring)) - circle) < 1e-3);
+		// consecutive points stay on the circle, so the walk never jumped across it
+		for (size_t k = 0; k < stitched.ring.size(); k++) {
+			REQUIRE(glm::distance(stitched.ring[k], stitched.ring[(k + 1) % stitched.ring.size()]) < 0.01);
+		}
+	}
+
+}
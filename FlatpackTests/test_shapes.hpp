@@ -0,0 +1,49 @@
+#ifndef _TEST_SHAPES_H_
+#define _TEST_SHAPES_H_
+
+#include "../Nester/Nester.hpp"
+
+// Builders for the simple parts the tests nest, shared by the test files
+
+namespace NesterTests
+{
+	using namespace nester;
+
+	// the ring as a loop of lines, closed back to its first point
+	inline shared_ptr<NesterLoop> lineLoop(const polygon_t& ring) {
+		shared_ptr<NesterLoop> loop = make_shared<NesterLoop>();
+		for (size_t k = 0; k < ring.size(); k++) {
+			shared_ptr<NesterLine> line = make_shared<NesterLine>();
+			line->setStartPoint(ring[k]);
+			line->setEndPoint(ring[(k + 1) % ring.size()]);
+			loop->addEdge(line);
+		}
+		return loop;
+	}
+
+	// a part made of lines
+	inline NesterPart_p linePart(const polygon_t& outline, const vector<polygon_t>& holes = vector<polygon_t>()) {
+		NesterPart_p part = make_shared<NesterPart>();
+		part->setOuterRing(lineLoop(outline));
+		for (const polygon_t& hole : holes) {
+			part->addInnerRing(lineLoop(hole));
+		}
+		return part;
+	}
+
+	// counter clockwise from the corner at x, y
+	inline polygon_t rectangle(double x, double y, double w, double h) {
+		return { point_t(x, y), point_t(x + w, y), point_t(x + w, y + h), point_t(x, y + h) };
+	}
+
+	inline polygon_t rectangle(double w, double h) {
+		return rectangle(0.0, 0.0, w, h);
+	}
+
+	inline polygon_t square(double x, double y, double side) {
+		return rectangle(x, y, side, side);
+	}
+
+}
+
+#endif
@@ -0,0 +1,205 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+
+#include "catch.hpp"
+#include "../Nester/Geometry.hpp"
+#include "../Nester/LayoutVerifier.hpp"
+#include "../Nester/Nester.hpp"
+#include "../Nester/Predicates.hpp"
+#include "test_shapes.hpp"
+
+using namespace nester;
+using namespace std;
+
+namespace NesterTests
+{
+	Placement placed(const polygon_t& outline, point_t at, size_t sheet = 0, const vector<polygon_t>& holes = vector<polygon_t>()) {
+		Placement p;
+		p.part = linePart(outline, holes);
+		p.transformer = makeTransformation(0.0, at.x, at.y);
+		p.sheet = sheet;
+		return p;
+	}
+
+	set<pair<size_t, size_t> > violatingPairs(const vector<LayoutViolation>& violations) {
+		set<pair<size_t, size_t> > pairs;
+		for (const LayoutViolation& v : violations) {
+			pairs.insert(make_pair(min(v.first, v.second), max(v.first, v.second)));
+		}
+		return pairs;
+	}
+
+	TEST_CASE("layout_violations", "[verify]") {
+		polygon_t frame = square(0, 0, 10);
+		vector<polygon_t> window = { square(2, 2, 6) };
+		vector<Placement> layout = {
+			placed(square(0, 0, 2), point_t(0, 0)),
+			placed(square(0, 0, 2), point_t(2, 0)),          // touches 0
+			placed(square(0, 0, 2), point_t(3, 1)),          // crosses 1
+			placed(frame, point_t(20, 0), 0, window),
+			placed(square(0, 0, 1), point_t(24, 4)),         // in the hole of 3
+			placed(square(0, 0, 1), point_t(20.5, 0.5)),     // in the material of 3
+			placed(square(0, 0, 2), point_t(0, 0), 1),       // the same spot as 0, but on another sheet
+			placed(square(0, 0, 2), point_t(40, 0)),
+			placed(square(0, 0, 2), point_t(40, 0)) };      // exactly on top of 7
+		vector<LayoutViolation> violations = verifyLayout(layout);
+
+		REQUIRE(violatingPairs(violations) == set<pair<size_t, size_t> >({ make_pair((size_t)1, (size_t)2), make_pair((size_t)3, (size_t)5), make_pair((size_t)7, (size_t)8) }));
+		for (const LayoutViolation& v : violations) {
+			if (v.first == 5 || v.second == 5) {
+				REQUIRE(v.kind == VIOLATION_INSIDE);
+				REQUIRE(v.first == 5);
+				REQUIRE(v.area == Approx(1.0));
+			}
+			if (v.first == 1 || v.second == 1) {
+				REQUIRE(v.kind == VIOLATION_CROSSING);
+				REQUIRE(v.where.x == Approx(3.0));
+				REQUIRE(v.area == Approx(1.0));
+			}
+			if (v.first == 7 || v.second == 7) {
+				REQUIRE(v.area == Approx(4.0));
+			}
+		}
+	}
+
+	TEST_CASE("sweep_against_pairwise", "[verify]") {
+		// random convex parts overlap exactly when their edges cross or a corner of one lies inside the other
+		mt19937 random(7);
+		uniform_real_distribution<double> position(0.0, 30.0), size(0.5, 4.0), turn(0.0, 6.28318530718);
+		for (int round = 0; round < 20; round++) {
+			vector<Placement> layout;
+			vector<polygon_t> outlines;
+			for (int i = 0; i < 40; i++) {
+				polygon_t ring;
+				int corners = 3 + i % 5;
+				double r = size(random), start = turn(random);
+				for (int k = 0; k < corners; k++) {
+					double a = start + k * 6.28318530718 / corners;
+					ring.push_back(point_t(r * cos(a), r * sin(a)));
+				}
+				point_t at(position(random), position(random));
+				layout.push_back(placed(ring, at));
+				outlines.push_back(transformPolygon(ring, layout.back().transformer));
+			}
+
+			set<pair<size_t, size_t> > expected;
+			for (size_t i = 0; i < outlines.size(); i++) {
+				for (size_t j = i + 1; j < outlines.size(); j++) {
+					const polygon_t& a = outlines[i];
+					const polygon_t& b = outlines[j];
+					bool overlap = pointInPolygon(a[0], b) || pointInPolygon(b[0], a);
+					for (size_t p = 0; p < a.size() && !overlap; p++) {
+						for (size_t q = 0; q < b.size() && !overlap; q++) {
+							point_t a1 = a[p], a2 = a[(p + 1) % a.size()], b1 = b[q], b2 = b[(q + 1) % b.size()];
+							overlap = cross(a1, a2, b1) * cross(a1, a2, b2) < 0.0 && cross(b1, b2, a1) * cross(b1, b2, a2) < 0.0;
+						}
+					}
+					if (overlap) {
+						expected.insert(make_pair(i, j));
+					}
+				}
+			}
+			REQUIRE(violatingPairs(verifyLayout(layout)) == expected);
+		}
+	}
+
+	TEST_CASE("sweep_on_integer_grid", "[verify]") {
+		// a corner of the quad lies on an edge of the triangle, and an edge of the quad crosses another one
+		// of the triangle through the same event point
+		vector<Placement> touching = {
+			placed({ point_t(8, 5), point_t(4, 9), point_t(4, 1) }, point_t(0, 0)),
+			placed({ point_t(5, 8), point_t(1, 13), point_t(-2, 8), point_t(1, 7) }, point_t(0, 0)) };
+		REQUIRE(violatingPairs(verifyLayout(touching)) == set<pair<size_t, size_t> >({ make_pair((size_t)0, (size_t)1) }));
+
+		// small rings on a coarse grid share corners, run along each other and cross in the corners of
+		// others all the time. Every pair whose edges cross has to be found, and every crossing reported
+		// has to be one.
+		mt19937 random(23);
+		uniform_int_distribution<int> coordinate(0, 12), corners(3, 5);
+		for (int round = 0; round < 200; round++) {
+			vector<Placement> layout;
+			vector<polygon_t> outlines;
+			for (int i = 0; i < 20; i++) {
+				polygon_t ring;
+				for (int k = corners(random); k > 0; k--) {
+					ring.push_back(point_t(coordinate(random), coordinate(random)));
+				}
+				layout.push_back(placed(ring, point_t(0, 0)));
+				outlines.push_back(ring);
+			}
+
+			set<pair<size_t, size_t> > crossing;
+			for (size_t i = 0; i < outlines.size(); i++) {
+				for (size_t j = i + 1; j < outlines.size(); j++) {
+					const polygon_t& a = outlines[i];
+					const polygon_t& b = outlines[j];
+					for (size_t p = 0; p < a.size(); p++) {
+						for (size_t q = 0; q < b.size(); q++) {
+							if (segmentsCross(a[p], a[(p + 1) % a.size()], b[q], b[(q + 1) % b.size()])) {
+								crossing.insert(make_pair(i, j));
+							}
+						}
+					}
+				}
+			}
+			vector<LayoutViolation> violations = verifyLayout(layout);
+			set<pair<size_t, size_t> > found = violatingPairs(violations);
+			for (const pair<size_t, size_t>& pair : crossing) {
+				REQUIRE(found.count(pair) == 1);
+			}
+			for (const LayoutViolation& v : violations) {
+				if (v.kind == VIOLATION_CROSSING) {
+					REQUIRE(crossing.count(make_pair(min(v.first, v.second), max(v.first, v.second))) == 1);
+				}
+			}
+		}
+	}
+
+	TEST_CASE("nested_layout_verifies", "[verify]") {
+		Nester nester;
+		nester.setSheetWidth(20.0);
+		nester.setSpacing(0.1);
+		for (int i = 0; i < 12; i++) {
+			polygon_t l = { point_t(0, 0), point_t(4 + i % 3, 0), point_t(4 + i % 3, 1), point_t(1, 1), point_t(1, 3), point_t(0, 3) };
+			NesterPart_p part = make_shared<NesterPart>();
+			part->setOuterRing(lineLoop(l));
+			nester.addPart(part);
+		}
+		nester.run();
+		REQUIRE(nester.getPlacements().size() == 12);
+		REQUIRE(nester.verify().empty());
+	}
+
+	TEST_CASE("verify_benchmark", "[.][benchmark]") {
+		// 5000 discs of 100 edges in a grid, with a few pushed into their neighbours
+		vector<Placement> layout;
+		polygon_t disc;
+		for (int k = 0; k < 100; k++) {
+			double a = k * 6.28318530718 / 100;
+			disc.push_back(point_t(cos(a), sin(a)));
+		}
+		for (int i = 0; i < 5000; i++) {
+			double shift = i % 1000 == 0 ? 0.5 : 0.0;
+			layout.push_back(placed(disc, point_t(2.0 * (i % 100) + shift, 2.0 * (i / 100))));
+		}
+		auto started = chrono::steady_clock::now();
+		vector<LayoutViolation> violations = verifyLayout(layout);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "verified 500000 edges in " << ms << " ms" << endl;
+		REQUIRE(violations.size() == 5);
+
+		// the same discs in 2 columns: the sweep line holds 5000 edges, which the probes need not walk
+		for (size_t i = 0; i < layout.size(); i++) {
+			double shift = i % 1000 == 0 ? 0.5 : 0.0;
+			layout[i].transformer = makeTransformation(0.0, 2.0 * (i % 2) + shift, 2.0 * (i / 2));
+		}
+		started = chrono::steady_clock::now();
+		violations = verifyLayout(layout);
+		ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+		cout << "verified 500000 edges in 2 columns in " << ms << " ms" << endl;
+		REQUIRE(violations.size() == 5);
+	}
+}
@@ -0,0 +1,42 @@
+#include <cstdint>
+
+#include "Arena.hpp"
+
+namespace nester {
+
+	static std::size_t padding(const char* p, std::size_t alignment) {
+		return (alignment - (std::uintptr_t)p % alignment) % alignment;
+	}
+
+	Arena::Arena() : next(nullptr), left(0), used(0), reserved(0) {}
+
+	void* Arena::allocate(std::size_t bytes, std::size_t alignment) {
+		used += bytes;
+		if (bytes > ARENA_BLOCK_SIZE / 4) {
+			// a block of its own, the rest of the current block stays for the small requests
+			blocks.push_back(std::unique_ptr<char[]>(new char[bytes + alignment]));
+			reserved += bytes + alignment;
+			char* block = blocks.back().get();
+			return block + padding(block, alignment);
+		}
+		if (!next || padding(next, alignment) + bytes > left) {
+			blocks.push_back(std::unique_ptr<char[]>(new char[ARENA_BLOCK_SIZE]));
+			reserved += ARENA_BLOCK_SIZE;
+			next = blocks.back().get();
+			left = ARENA_BLOCK_SIZE;
+		}
+		char* p = next + padding(next, alignment);
+		left -= p + bytes - next;
+		next = p + bytes;
+		return p;
+	}
+
+	std::size_t Arena::bytesUsed() const {
+		return used;
+	}
+
+	std::size_t Arena::bytesReserved() const {
+		return reserved;
+	}
+
+}
@@ -0,0 +1,80 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace nester {
+
+	// the size of the blocks an arena takes from the heap, larger requests get a block of their own
+	const std::size_t ARENA_BLOCK_SIZE = 1 << 20;
+
+	// Monotonic memory for the geometry of one job: an allocation only moves a pointer on, and all of it
+	// goes back to the heap at once with the arena. Not safe to allocate from several threads.
+	class Arena {
+		std::vector<std::unique_ptr<char[]> > blocks;
+		char* next;
+		std::size_t left;
+		std::size_t used;
+		std::size_t reserved;
+	public:
+		Arena();
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		void* allocate(std::size_t bytes, std::size_t alignment);
+		// what was handed out and what was taken from the heap for it
+		std::size_t bytesUsed() const;
+		std::size_t bytesReserved() const;
+	};
+
+	typedef std::shared_ptr<Arena> Arena_p;
+
+	// A standard allocator taking memory from an arena, which it keeps alive. Without an arena it uses
+	// the heap.
+	template<typename T>
+	struct ArenaAllocator {
+		typedef T value_type;
+		Arena_p arena;
+
+		ArenaAllocator() {}
+		explicit ArenaAllocator(Arena_p arena) : arena(arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+		T* allocate(std::size_t n) {
+			if (!arena) {
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, std::size_t) {
+			if (!arena) {
+				::operator delete(p);
+			}
+		}
+	};
+
+	template<typename T, typename U>
+	bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena == b.arena;
+	}
+
+	template<typename T, typename U>
+	bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena != b.arena;
+	}
+
+	// an object and its reference count in the arena, or on the heap without one
+	template<typename T, typename... Args>
+	std::shared_ptr<T> makeShared(const Arena_p& arena, Args&&... args) {
+		return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+	}
+
+}
+
+#endif
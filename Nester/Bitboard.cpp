@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Bitboard.hpp"
+#include "Simd.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace nester {
+
+	const size_t WORD_BITS = 64;
+
+	static size_t popcount(uint64_t word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		return (size_t)__popcnt64(word);
+#else
+		return (size_t)__builtin_popcountll(word);
+#endif
+	}
+
+	static uint64_t wordAt(const uint64_t* in, size_t words, size_t k) {
+		return k < words ? in[k] : 0;
+	}
+
+	static uint64_t shiftedWord(const uint64_t* in, size_t words, size_t k, size_t wordShift, unsigned bitShift) {
+		uint64_t low = wordAt(in, words, k + wordShift);
+		if (bitShift == 0) {
+			return low;
+		}
+		return (low >> bitShift) | (wordAt(in, words, k + wordShift + 1) << (WORD_BITS - bitShift));
+	}
+
+#ifdef NESTER_AVX2
+	// handles whole blocks of four words which can be read without running off the input and
+	// returns where the scalar loop has to take over
+	template<bool AND_NOT>
+	AVX2_TARGET static size_t shiftedRightAvx2(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift) {
+		size_t wordShift = shift / WORD_BITS;
+		unsigned bitShift = (unsigned)(shift % WORD_BITS);
+		// shifting by 64 clears a lane, which is exactly what a zero bit shift needs from the upper word
+		__m128i right = _mm_cvtsi32_si128((int)bitShift);
+		__m128i left = _mm_cvtsi32_si128((int)(WORD_BITS - bitShift));
+
+		size_t k = 0;
+		for (; k + 4 <= outWords && k + wordShift + 5 <= inWords; k += 4) {
+			__m256i low = _mm256_loadu_si256((const __m256i*)(in + k + wordShift));
+			__m256i high = _mm256_loadu_si256((const __m256i*)(in + k + wordShift + 1));
+			__m256i shifted = _mm256_or_si256(_mm256_srl_epi64(low, right), _mm256_sll_epi64(high, left));
+			__m256i target = _mm256_loadu_si256((const __m256i*)(out + k));
+			target = AND_NOT ? _mm256_andnot_si256(shifted, target) : _mm256_or_si256(target, shifted);
+			_mm256_storeu_si256((__m256i*)(out + k), target);
+		}
+		return k;
+	}
+
+	AVX2_TARGET static bool anySetAvx2(const uint64_t* in, size_t words, size_t& k) {
+		__m256i any = _mm256_setzero_si256();
+		for (k = 0; k + 4 <= words; k += 4) {
+			any = _mm256_or_si256(any, _mm256_loadu_si256((const __m256i*)(in + k)));
+		}
+		return !_mm256_testz_si256(any, any);
+	}
+#endif
+
+	// out may be the same row as in, every word is read before it is written
+	template<bool AND_NOT>
+	static void shiftedRight(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift) {
+		size_t k = 0;
+#ifdef NESTER_AVX2
+		if (hasAvx2()) {
+			k = shiftedRightAvx2<AND_NOT>(out, outWords, in, inWords, shift);
+		}
+#endif
+		size_t wordShift = shift / WORD_BITS;
+		unsigned bitShift = (unsigned)(shift % WORD_BITS);
+		for (; k < outWords; k++) {
+			uint64_t shifted = shiftedWord(in, inWords, k, wordShift, bitShift);
+			out[k] = AND_NOT ? out[k] & ~shifted : out[k] | shifted;
+		}
+	}
+
+	void orShiftedRight(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift) {
+		shiftedRight<false>(out, outWords, in, inWords, shift);
+	}
+
+	void andNotShiftedRight(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift) {
+		shiftedRight<true>(out, outWords, in, inWords, shift);
+	}
+
+	bool anySet(const uint64_t* in, size_t words) {
+		size_t k = 0;
+#ifdef NESTER_AVX2
+		if (hasAvx2() && anySetAvx2(in, words, k)) {
+			return true;
+		}
+#endif
+		for (; k < words; k++) {
+			if (in[k] != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t countBits(const uint64_t* in, size_t words) {
+		size_t count = 0;
+		for (size_t k = 0; k < words; k++) {
+			count += popcount(in[k]);
+		}
+		return count;
+	}
+
+	Bitboard::Bitboard(size_t columns, size_t rows) :
+		columns(columns), rows(rows), stride((columns + WORD_BITS - 1) / WORD_BITS), words(stride * rows, 0) {}
+
+	size_t Bitboard::width() const {
+		return columns;
+	}
+
+	size_t Bitboard::height() const {
+		return rows;
+	}
+
+	size_t Bitboard::rowWords() const {
+		return stride;
+	}
+
+	const uint64_t* Bitboard::row(size_t r) const {
+		return words.data() + r * stride;
+	}
+
+	uint64_t* Bitboard::row(size_t r) {
+		return words.data() + r * stride;
+	}
+
+	bool Bitboard::get(size_t column, size_t r) const {
+		return (row(r)[column / WORD_BITS] >> (column % WORD_BITS)) & 1;
+	}
+
+	void Bitboard::set(size_t column, size_t r) {
+		row(r)[column / WORD_BITS] |= (uint64_t)1 << (column % WORD_BITS);
+	}
+
+	void Bitboard::setSpan(size_t r, size_t from, size_t to) {
+		to = min(to, columns);
+		uint64_t* target = row(r);
+		while (from < to) {
+			size_t bit = from % WORD_BITS;
+			size_t n = min(WORD_BITS - bit, to - from);
+			uint64_t mask = n == WORD_BITS ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1) << bit;
+			target[from / WORD_BITS] |= mask;
+			from += n;
+		}
+	}
+
+	void Bitboard::addRows(size_t count) {
+		rows += count;
+		words.resize(stride * rows, 0);
+	}
+
+	size_t Bitboard::count() const {
+		return countBits(words.data(), words.size());
+	}
+
+	void Bitboard::stamp(const Bitboard& other, size_t column, size_t r) {
+		size_t wordShift = column / WORD_BITS;
+		unsigned bitShift = (unsigned)(column % WORD_BITS);
+		for (size_t i = 0; i < other.rows && r + i < rows; i++) {
+			const uint64_t* source = other.row(i);
+			uint64_t* target = row(r + i);
+			for (size_t k = 0; k < other.stride && k + wordShift < stride; k++) {
+				target[k + wordShift] |= source[k] << bitShift;
+				if (bitShift != 0 && k + wordShift + 1 < stride) {
+					target[k + wordShift + 1] |= source[k] >> (WORD_BITS - bitShift);
+				}
+			}
+			if (columns % WORD_BITS != 0) {
+				target[stride - 1] &= ((uint64_t)1 << (columns % WORD_BITS)) - 1;
+			}
+		}
+	}
+
+	bool Bitboard::overlaps(const Bitboard& other, size_t column, size_t r) const {
+		size_t wordShift = column / WORD_BITS;
+		unsigned bitShift = (unsigned)(column % WORD_BITS);
+		for (size_t i = 0; i < other.rows && r + i < rows; i++) {
+			const uint64_t* source = other.row(i);
+			const uint64_t* target = row(r + i);
+			for (size_t k = 0; k < other.stride && k + wordShift < stride; k++) {
+				uint64_t hit = target[k + wordShift] & (source[k] << bitShift);
+				if (bitShift != 0 && k + wordShift + 1 < stride) {
+					hit |= target[k + wordShift + 1] & (source[k] >> (WORD_BITS - bitShift));
+				}
+				if (hit != 0) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	Bitboard Bitboard::dilated(size_t radius) const {
+		Bitboard wide(columns + 2 * radius, rows);
+		for (size_t r = 0; r < rows; r++) {
+			size_t c = 0;
+			while (c < columns) {
+				if (!get(c, r)) {
+					c++;
+					continue;
+				}
+				size_t end = c;
+				while (end < columns && get(end, r)) {
+					end++;
+				}
+				wide.setSpan(r, c, end + 2 * radius);
+				c = end;
+			}
+		}
+
+		Bitboard result(columns + 2 * radius, rows + 2 * radius);
+		for (size_t r = 0; r < result.rows; r++) {
+			size_t first = r < 2 * radius ? 0 : r - 2 * radius;
+			uint64_t* target = result.row(r);
+			for (size_t from = first; from <= r && from < rows; from++) {
+				const uint64_t* source = wide.row(from);
+				for (size_t k = 0; k < result.stride; k++) {
+					target[k] |= source[k];
+				}
+			}
+		}
+		return result;
+	}
+
+	Bitboard rasterize(const polygon_t& outer, const vector<polygon_t>& holes, point_t origin, double resolution, size_t columns, size_t rows) {
+		Bitboard board(columns, rows);
+		if (columns == 0 || rows == 0) {
+			return board;
+		}
+
+		vector<const polygon_t*> rings = { &outer };
+		for (const polygon_t& hole : holes) {
+			rings.push_back(&hole);
+		}
+		auto cellOf = [&](double v, double start, size_t count) {
+			double cell = floor((v - start) / resolution);
+			return (size_t)max(0.0, min((double)count - 1.0, cell));
+		};
+
+		// every cell an edge passes through, which covers all cells only partly inside
+		for (const polygon_t* ring : rings) {
+			for (size_t i = 0, j = ring->size() - 1; i < ring->size(); j = i++) {
+				point_t a = (*ring)[j];
+				point_t b = (*ring)[i];
+				size_t first = cellOf(min(a.y, b.y), origin.y, rows);
+				size_t last = cellOf(max(a.y, b.y), origin.y, rows);
+				for (size_t r = first; r <= last; r++) {
+					double xa = min(a.x, b.x);
+					double xb = max(a.x, b.x);
+					if (a.y != b.y) {
+						double y0 = origin.y + r * resolution;
+						double t0 = max(0.0, min(1.0, (y0 - a.y) / (b.y - a.y)));
+						double t1 = max(0.0, min(1.0, (y0 + resolution - a.y) / (b.y - a.y)));
+						xa = a.x + t0 * (b.x - a.x);
+						xb = a.x + t1 * (b.x - a.x);
+						if (xa > xb) {
+							swap(xa, xb);
+						}
+					}
+					board.setSpan(r, cellOf(xa, origin.x, columns), cellOf(xb, origin.x, columns) + 1);
+				}
+			}
+		}
+
+		// cells entirely inside have their centre inside, even-odd over the outer ring and the holes
+		vector<double> crossings;
+		for (size_t r = 0; r < rows; r++) {
+			double y = origin.y + (r + 0.5) * resolution;
+			crossings.clear();
+			for (const polygon_t* ring : rings) {
+				for (size_t i = 0, j = ring->size() - 1; i < ring->size(); j = i++) {
+					point_t a = (*ring)[j];
+					point_t b = (*ring)[i];
+					if ((a.y > y) != (b.y > y)) {
+						crossings.push_back(a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y));
+					}
+				}
+			}
+			sort(crossings.begin(), crossings.end());
+			for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+				double from = ceil((crossings[i] - origin.x) / resolution - 0.5);
+				double to = floor((crossings[i + 1] - origin.x) / resolution - 0.5);
+				from = max(0.0, from);
+				to = min((double)columns - 1.0, to);
+				if (from <= to) {
+					board.setSpan(r, (size_t)from, (size_t)to + 1);
+				}
+			}
+		}
+		return board;
+	}
+
+}
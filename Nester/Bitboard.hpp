@@ -0,0 +1,56 @@
+#ifndef _BITBOARD_H_
+#define _BITBOARD_H_
+
+#include <cstdint>
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// A grid of occupancy cells packed 64 to a word. Bit i of word k in a row is column 64 * k + i,
+	// rows are padded to whole words and the padding bits are always clear.
+	class Bitboard {
+		size_t columns;
+		size_t rows;
+		size_t stride;  // words per row
+		vector<uint64_t> words;
+	public:
+		Bitboard(size_t columns = 0, size_t rows = 0);
+
+		size_t width() const;
+		size_t height() const;
+		size_t rowWords() const;
+		const uint64_t* row(size_t r) const;
+		uint64_t* row(size_t r);
+
+		bool get(size_t column, size_t r) const;
+		void set(size_t column, size_t r);
+		// sets the columns [from, to) of a row
+		void setSpan(size_t r, size_t from, size_t to);
+		void addRows(size_t count);
+
+		// number of set cells
+		size_t count() const;
+		// ors the other board in with its bottom left cell at (column, r), clipped to this board
+		void stamp(const Bitboard& other, size_t column, size_t r);
+		// true when the other board placed at (column, r) shares a set cell with this one
+		bool overlaps(const Bitboard& other, size_t column, size_t r) const;
+		// grows every set cell by radius cells in each direction, the board gets 2 * radius wider and taller
+		Bitboard dilated(size_t radius) const;
+	};
+
+	// Sets every cell which touches the inside of the outer ring minus the holes, so that parts which
+	// don't share a cell don't overlap. Cell (0, 0) starts at origin, cells are resolution wide.
+	Bitboard rasterize(const polygon_t& outer, const vector<polygon_t>& holes, point_t origin, double resolution, size_t columns, size_t rows);
+
+	// Word kernels over rows of the given number of words. A shift moves bits to lower columns and
+	// reads zeros past the end of the input, which may be longer than the output. They use AVX2 when
+	// the processor has it.
+	void orShiftedRight(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift);
+	void andNotShiftedRight(uint64_t* out, size_t outWords, const uint64_t* in, size_t inWords, size_t shift);
+	bool anySet(const uint64_t* in, size_t words);
+	size_t countBits(const uint64_t* in, size_t words);
+
+}
+
+#endif
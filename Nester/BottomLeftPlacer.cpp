@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "BottomLeftPlacer.hpp"
+#include "Geometry.hpp"
+
+namespace nester {
+
+	// slack allowed when deciding if a position touches rather than overlaps (cm)
+	const double PLACEMENT_TOLERANCE = 1e-7;
+	const int MAX_SLIDES = 16;
+	const size_t MAX_GRID_CELLS = 64;
+
+	// the no-fit polygon of the part being placed around one of the placed parts, in sheet coordinates
+	struct PlacedNfp {
+		const NoFitPolygon* nfp;
+		transformer_t toSheet;
+		transformer_t toLocal;
+		BoundingBox bounds;
+	};
+
+	// Buckets the placed NFPs so a candidate position only has to be tested against nearby ones
+	class NfpGrid {
+		BoundingBox bounds;
+		size_t columns, rows;
+		double cellWidth, cellHeight;
+		vector<vector<size_t> > cells;
+		vector<size_t> empty;
+
+		size_t column(double x) const {
+			return min(columns - 1, (size_t)max(0.0, floor((x - (double)bounds.minX) / cellWidth)));
+		}
+
+		size_t row(double y) const {
+			return min(rows - 1, (size_t)max(0.0, floor((y - (double)bounds.minY) / cellHeight)));
+		}
+
+	public:
+		NfpGrid(const vector<PlacedNfp>& placed) : columns(1), rows(1), cellWidth(1.0), cellHeight(1.0) {
+			for (const PlacedNfp& p : placed) {
+				bounds.join(p.bounds);
+			}
+			if (placed.empty()) {
+				return;
+			}
+
+			size_t side = min(MAX_GRID_CELLS, (size_t)ceil(sqrt((double)placed.size())));
+			columns = rows = max((size_t)1, side);
+			cellWidth = max((double)bounds.width() / columns, PLACEMENT_TOLERANCE);
+			cellHeight = max((double)bounds.height() / rows, PLACEMENT_TOLERANCE);
+			cells.resize(columns * rows);
+
+			for (size_t i = 0; i < placed.size(); i++) {
+				const BoundingBox& bb = placed[i].bounds;
+				for (size_t r = row((double)bb.minY); r <= row((double)bb.maxY); r++) {
+					for (size_t c = column((double)bb.minX); c <= column((double)bb.maxX); c++) {
+						cells[r * columns + c].push_back(i);
+					}
+				}
+			}
+		}
+
+		const vector<size_t>& at(point_t p) const {
+			if (cells.empty() || p.x < bounds.minX || p.x > bounds.maxX || p.y < bounds.minY || p.y > bounds.maxY) {
+				return empty;
+			}
+			return cells[row(p.y) * columns + column(p.x)];
+		}
+	};
+
+	static bool strictlyInside(const BoundingBox& bb, point_t p) {
+		return p.x > bb.minX && p.x < bb.maxX && p.y > bb.minY && p.y < bb.maxY;
+	}
+
+	static bool isFeasible(point_t p, const vector<PlacedNfp>& placed, const NfpGrid& grid) {
+		for (size_t i : grid.at(p)) {
+			const PlacedNfp& nfp = placed[i];
+			if (strictlyInside(nfp.bounds, p) && nfp.nfp->containsInterior(transformPoint(nfp.toLocal, p))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static double cross2(point_t a, point_t b) {
+		return a.x * b.y - a.y * b.x;
+	}
+
+	// a side of an NFP piece in sheet coordinates
+	struct NfpSide {
+		point_t a, b;
+		size_t piece;
+		bool stock;  // of the NFP of what is not stock
+	};
+
+	// Adds the points where a side of the stock NFPs crosses a side of another piece. The feasible region
+	// has corners there which are no corner of any piece, and on tilted stock or in a tilted hole they
+	// are often the only feasible positions. The sides are swept along x, so only those whose x ranges
+	// overlap are tested.
+	static void addCrossings(vector<NfpSide>& sides, vector<point_t>& candidates) {
+		sort(sides.begin(), sides.end(), [](const NfpSide& s, const NfpSide& t) {
+			return min(s.a.x, s.b.x) < min(t.a.x, t.b.x);
+		});
+		for (size_t i = 0; i < sides.size(); i++) {
+			const NfpSide& s = sides[i];
+			double right = max(s.a.x, s.b.x);
+			double bottom = min(s.a.y, s.b.y), top = max(s.a.y, s.b.y);
+			point_t d = s.b - s.a;
+			for (size_t j = i + 1; j < sides.size() && min(sides[j].a.x, sides[j].b.x) <= right; j++) {
+				const NfpSide& t = sides[j];
+				if (t.piece == s.piece || (!s.stock && !t.stock) || max(t.a.y, t.b.y) < bottom || min(t.a.y, t.b.y) > top) {
+					continue;
+				}
+				point_t e = t.b - t.a;
+				double denominator = cross2(d, e);
+				if (denominator == 0.0) {
+					continue;  // parallel, where they overlap the corners are candidates already
+				}
+				double u = cross2(t.a - s.a, e) / denominator;
+				double v = cross2(t.a - s.a, d) / denominator;
+				if (u > 0.0 && u < 1.0 && v > 0.0 && v < 1.0) {
+					candidates.push_back(s.a + d * u);
+				}
+			}
+		}
+	}
+
+	// how far p can move in the given unit direction (at most limit) before entering an NFP
+	static double slideDistance(point_t p, point_t direction, double limit, const vector<PlacedNfp>& placed) {
+		point_t end = p + direction * limit;
+		BoundingBox path;
+		path.minX = min(p.x, end.x) - PLACEMENT_TOLERANCE;
+		path.maxX = max(p.x, end.x) + PLACEMENT_TOLERANCE;
+		path.minY = min(p.y, end.y) - PLACEMENT_TOLERANCE;
+		path.maxY = max(p.y, end.y) + PLACEMENT_TOLERANCE;
+
+		double best = limit;
+		for (const PlacedNfp& nfp : placed) {
+			if (nfp.bounds.maxX < path.minX || nfp.bounds.minX > path.maxX ||
+				nfp.bounds.maxY < path.minY || nfp.bounds.minY > path.maxY) {
+				continue;
+			}
+
+			point_t q = transformPoint(nfp.toLocal, p);
+			point_t d = transformPoint(nfp.toLocal, p + direction) - q;
+
+			for (const polygon_t& piece : nfp.nfp->pieces) {
+				for (size_t k = 0, l = piece.size() - 1; k < piece.size(); l = k++) {
+					point_t a = piece[l];
+					point_t e = piece[k] - a;
+					double denominator = cross2(d, e);
+					if (denominator >= 0.0) {
+						continue;  // parallel, or leaving the piece through this edge
+					}
+					double t = cross2(a - q, e) / denominator;
+					double u = cross2(a - q, d) / denominator;
+					if (u < -PLACEMENT_TOLERANCE || u > 1.0 + PLACEMENT_TOLERANCE || t < -PLACEMENT_TOLERANCE) {
+						continue;
+					}
+					best = min(best, max(t, 0.0));
+				}
+			}
+		}
+		return best;
+	}
+
+	BottomLeftPlacer::BottomLeftPlacer(const vector<PartShape>& shapes, NfpCache& nfps, double sheetWidth, double spacing) :
+		shapes(shapes), nfps(nfps), sheetWidth(sheetWidth), spacing(spacing), stock(nullptr) {}
+
+	void BottomLeftPlacer::setStock(InnerFitCache* stock) {
+		this->stock = stock;
+	}
+
+	NestingResult BottomLeftPlacer::place(const vector<size_t>& order, const vector<int>& orientations, const NestingResult& start) {
+		NestingResult result = start;
+
+		for (size_t n = 0; n < order.size(); n++) {
+			const PartShape& shape = shapes[order[n]];
+
+			bool found = false;
+			ShapePlacement best;
+			double bestTop = 0.0, bestLeft = 0.0;
+
+			for (size_t o = 0; o < shape.orientations.size(); o++) {
+				if (orientations[n] != ANY_ORIENTATION && (size_t)orientations[n] != o) {
+					continue;
+				}
+				const OrientedShape& oriented = shape.orientations[o];
+
+				// inner-fit rectangle: the positions where the part stays on the sheet
+				double xMin = -(double)oriented.bounds.minX;
+				double xMax = sheetWidth - (double)oriented.bounds.maxX;
+				double yMin = -(double)oriented.bounds.minY;
+				double yMax = numeric_limits<double>::infinity();
+				const InnerFitPolygon* fit = nullptr;
+				if (stock) {
+					fit = &stock->get(order[n], o);
+					xMin = fit->xMin;
+					xMax = fit->xMax;
+					yMin = fit->yMin;
+					yMax = fit->yMax;
+				}
+				if (xMax < xMin - PLACEMENT_TOLERANCE || yMax < yMin - PLACEMENT_TOLERANCE) {
+					continue;
+				}
+				xMax = max(xMin, xMax);
+				yMax = max(yMin, yMax);
+
+				vector<PlacedNfp> placed;
+				placed.reserve(result.placements.size() + (fit ? fit->obstacles.size() : 0));
+				if (fit) {
+					// whatever is not stock is in place before any part
+					for (const NoFitPolygon& obstacle : fit->obstacles) {
+						PlacedNfp nfp;
+						nfp.nfp = &obstacle;
+						nfp.toSheet = transformer_t(1.0);
+						nfp.toLocal = transformer_t(1.0);
+						nfp.bounds = obstacle.bounds;
+						placed.push_back(nfp);
+					}
+				}
+				for (const ShapePlacement& p : result.placements) {
+					PlacedNfp nfp;
+					nfp.nfp = &nfps.get(p.shape, order[n], nfps.rotationBetween(p.orientation, o));
+					// the NFP holds the fixed shape in its first orientation, which is already turned upright
+					const vector<OrientedShape>& turns = shapes[p.shape].orientations;
+					nfp.toSheet = makeTransformation(turns[p.orientation].angle - turns[0].angle, p.position.x, p.position.y);
+					nfp.toLocal = glm::inverse(nfp.toSheet);
+					const BoundingBox& lb = nfp.nfp->bounds;
+					polygon_t corners = {
+						point_t((double)lb.minX, (double)lb.minY), point_t((double)lb.maxX, (double)lb.minY),
+						point_t((double)lb.maxX, (double)lb.maxY), point_t((double)lb.minX, (double)lb.maxY) };
+					nfp.bounds = getBoundingBox(transformPolygon(corners, nfp.toSheet));
+					placed.push_back(nfp);
+				}
+				NfpGrid grid(placed);
+
+				auto onSheet = [&](point_t c) {
+					return c.x >= xMin - PLACEMENT_TOLERANCE && c.x <= xMax + PLACEMENT_TOLERANCE &&
+						c.y >= yMin - PLACEMENT_TOLERANCE && c.y <= yMax + PLACEMENT_TOLERANCE;
+				};
+
+				// candidate positions: the NFP vertices, where the NFP edges cross the sheet boundary and on
+				// stock where they cross the edges of the stock NFPs. On a sheet the part slides into the
+				// corners between parts from a vertex, so crossings of part NFPs are left out, which would
+				// make the placement several times slower.
+				size_t vertices = 1;
+				for (const PlacedNfp& nfp : placed) {
+					vertices += nfp.nfp->vertexCount();
+				}
+				vector<point_t> candidates;
+				candidates.reserve(vertices);
+				candidates.push_back(point_t(xMin, yMin));
+				vector<NfpSide> sides;
+				sides.reserve(vertices);
+				size_t pieceCount = 0;
+				polygon_t ring;
+				size_t stockNfps = fit ? fit->obstacles.size() : 0;
+				for (size_t i = 0; i < placed.size(); i++) {
+					const PlacedNfp& nfp = placed[i];
+					if (nfp.bounds.maxX < xMin || nfp.bounds.minX > xMax) {
+						continue;
+					}
+					for (const polygon_t& piece : nfp.nfp->pieces) {
+						ring.clear();
+						for (const point_t& p : piece) {
+							ring.push_back(transformPoint(nfp.toSheet, p));
+						}
+						for (size_t k = 0, l = ring.size() - 1; k < ring.size(); l = k++) {
+							point_t a = ring[l], b = ring[k];
+							if (onSheet(b)) {
+								candidates.push_back(b);
+							}
+							for (double x : { xMin, xMax }) {
+								if ((a.x - x) * (b.x - x) < 0.0) {
+									point_t c(x, a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x));
+									if (onSheet(c)) {
+										candidates.push_back(c);
+									}
+								}
+							}
+							if ((a.y - yMin) * (b.y - yMin) < 0.0) {
+								point_t c(a.x + (b.x - a.x) * (yMin - a.y) / (b.y - a.y), yMin);
+								if (onSheet(c)) {
+									candidates.push_back(c);
+								}
+							}
+							// sides which leave the inner-fit rectangle alone cross nothing that matters
+							if (fit && max(a.x, b.x) >= xMin - PLACEMENT_TOLERANCE && min(a.x, b.x) <= xMax + PLACEMENT_TOLERANCE &&
+								max(a.y, b.y) >= yMin - PLACEMENT_TOLERANCE && min(a.y, b.y) <= yMax + PLACEMENT_TOLERANCE) {
+								NfpSide side;
+								side.a = a;
+								side.b = b;
+								side.piece = pieceCount;
+								side.stock = i < stockNfps;
+								sides.push_back(side);
+							}
+						}
+						pieceCount++;
+					}
+				}
+
+				auto lower = [](point_t a, point_t b) {
+					return a.y < b.y || (a.y == b.y && a.x < b.x);
+				};
+				sort(candidates.begin(), candidates.end(), lower);
+
+				bool feasible = false;
+				point_t c;
+				for (point_t candidate : candidates) {
+					candidate.x = min(max(candidate.x, xMin), xMax);
+					candidate.y = max(candidate.y, yMin);
+					if (isFeasible(candidate, placed, grid)) {
+						feasible = true;
+						c = candidate;
+						break;
+					}
+				}
+
+				// a crossing can only do better below the lowest feasible corner, so only the sides which
+				// reach down there are crossed with each other
+				if (feasible) {
+					sides.erase(remove_if(sides.begin(), sides.end(), [&](const NfpSide& side) {
+						return min(side.a.y, side.b.y) > c.y + PLACEMENT_TOLERANCE;
+					}), sides.end());
+				}
+				vector<point_t> crossings;
+				addCrossings(sides, crossings);
+				sort(crossings.begin(), crossings.end(), lower);
+				for (point_t crossing : crossings) {
+					if (feasible && !lower(crossing, c)) {
+						break;
+					}
+					if (onSheet(crossing) && isFeasible(crossing, placed, grid)) {
+						feasible = true;
+						c = crossing;
+						break;
+					}
+				}
+
+				if (feasible) {
+					// let the part fall down and to the left as far as the placed parts allow
+					for (int slide = 0; slide < MAX_SLIDES; slide++) {
+						double down = slideDistance(c, point_t(0.0, -1.0), c.y - yMin, placed);
+						c.y -= down;
+						double left = slideDistance(c, point_t(-1.0, 0.0), c.x - xMin, placed);
+						c.x -= left;
+						if (down + left < PLACEMENT_TOLERANCE) {
+							break;
+						}
+					}
+
+					double top = c.y + (double)oriented.bounds.maxY;
+					double leftEdge = c.x + (double)oriented.bounds.minX;
+					if (!found || top < bestTop - PLACEMENT_TOLERANCE ||
+						(top < bestTop + PLACEMENT_TOLERANCE && leftEdge < bestLeft)) {
+						found = true;
+						bestTop = top;
+						bestLeft = leftEdge;
+						best.shape = order[n];
+						best.orientation = o;
+						best.position = c;
+					}
+				}
+			}
+
+			if (!found) {
+				// wider than the sheet in every allowed orientation, or not fitting the stock anywhere:
+				// put it above everything else
+				size_t narrowest = 0;
+				for (size_t o = 1; o < shape.orientations.size(); o++) {
+					if (shape.orientations[o].bounds.width() < shape.orientations[narrowest].bounds.width()) {
+						narrowest = o;
+					}
+				}
+				const OrientedShape& oriented = shape.orientations[narrowest];
+				best.shape = order[n];
+				best.orientation = narrowest;
+				double above = stock ? max(result.length, (double)stock->getBounds().maxY) : result.length;
+				best.position = point_t(-(double)oriented.bounds.minX, above + spacing - (double)oriented.bounds.minY);
+				bestTop = best.position.y + (double)oriented.bounds.maxY;
+			}
+
+			result.placements.push_back(best);
+			result.length = max(result.length, bestTop);
+		}
+
+		return result;
+	}
+
+}
@@ -0,0 +1,48 @@
+#ifndef _BOTTOM_LEFT_PLACER_H_
+#define _BOTTOM_LEFT_PLACER_H_
+
+#include "InnerFitPolygon.hpp"
+#include "Nester.hpp"
+#include "NoFitPolygon.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	const int ANY_ORIENTATION = -1;
+
+	struct ShapePlacement {
+		size_t shape;        // index into the part shapes
+		size_t orientation;
+		point_t position;
+	};
+
+	struct NestingResult {
+		vector<ShapePlacement> placements;
+		double length;   // how far up the sheet the layout reaches
+
+		NestingResult() : length(0.0) {}
+	};
+
+	// Places parts one at a time on a sheet of fixed width and unbounded length (along y) at the
+	// lowest, then leftmost, position where its no-fit polygons with all placed parts allow it.
+	class BottomLeftPlacer {
+		const vector<PartShape>& shapes;
+		NfpCache& nfps;
+		double sheetWidth;
+		double spacing;
+		InnerFitCache* stock;
+	public:
+		BottomLeftPlacer(const vector<PartShape>& shapes, NfpCache& nfps, double sheetWidth, double spacing);
+
+		// places the parts inside a piece of stock of any shape instead of on the open sheet. Parts which
+		// do not fit are put above it.
+		void setStock(InnerFitCache* stock);
+
+		// order holds shape indices, orientations holds an orientation per entry or ANY_ORIENTATION.
+		// The parts of start are already on the sheet and the others are placed around them.
+		NestingResult place(const vector<size_t>& order, const vector<int>& orientations, const NestingResult& start = NestingResult());
+	};
+
+}
+
+#endif
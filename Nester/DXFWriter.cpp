@@ -22,4 +22,19 @@ namespace nester {
 
 	}
 
+	void DXFWriter::arc(point_t center, double radius, double startAngle, double endAngle, color_t color) {
+		dxf.arc((double)(center.x*mm), (double)(center.y*mm), 0.0,
+			(double)(radius*mm),
+			startAngle, endAngle,
+			0, // layer
+			color);
+	}
+
+	void DXFWriter::circle(point_t center, double radius, color_t color) {
+		dxf.circle((double)(center.x*mm), (double)(center.y*mm), 0.0,
+			(double)(radius*mm),
+			0, // layer
+			color);
+	}
+
 }
\ No newline at end of file
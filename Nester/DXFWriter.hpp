@@ -7,11 +7,13 @@
 namespace nester {
 
 	class DXFWriter : public FileWriter {
-		XDxfGen<long double> dxf;
+		XDxfGen<double> dxf;
 	public:
 		DXFWriter(string filename);
 		virtual ~DXFWriter();
 		virtual void line(point_t p1, point_t p2, color_t color = 0);
+		virtual void arc(point_t center, double radius, double startAngle, double endAngle, color_t color = 0);
+		virtual void circle(point_t center, double radius, color_t color = 0);
 	};
 
 }
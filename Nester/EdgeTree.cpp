@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "EdgeTree.hpp"
+#include "Geometry.hpp"
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// deeper than any median split of an addressable number of segments gets
+	const size_t EDGE_TREE_STACK = 128;
+
+	namespace {
+
+		template<typename Box>
+		bool disjoint(const Box& a, const Box& b) {
+			return a.maxX < b.minX || b.maxX < a.minX || a.maxY < b.minY || b.maxY < a.minY;
+		}
+
+		template<typename Box>
+		double squaredDistance(const Box& box, point_t p) {
+			double dx = max(0.0, max(box.minX - p.x, p.x - box.maxX));
+			double dy = max(0.0, max(box.minY - p.y, p.y - box.maxY));
+			return dx * dx + dy * dy;
+		}
+
+		double squaredSegmentDistance(point_t p, point_t a, point_t b) {
+			point_t d = b - a;
+			double length = glm::dot(d, d);
+			double t = length > 0.0 ? min(1.0, max(0.0, glm::dot(p - a, d) / length)) : 0.0;
+			point_t q = a + d * t - p;
+			return glm::dot(q, q);
+		}
+
+	}
+
+	EdgeTree::EdgeTree(const vector<polygon_t>& rings) {
+		for (const polygon_t& ring : rings) {
+			for (size_t k = 0; k < ring.size(); k++) {
+				from.push_back(ring[k]);
+				to.push_back(ring[(k + 1) % ring.size()]);
+			}
+		}
+		if (from.empty()) {
+			return;
+		}
+
+		vector<Box> boxes(from.size());
+		vector<size_t> order(from.size());
+		for (size_t i = 0; i < from.size(); i++) {
+			Box b = { min(from[i].x, to[i].x), min(from[i].y, to[i].y), max(from[i].x, to[i].x), max(from[i].y, to[i].y) };
+			boxes[i] = b;
+			order[i] = i;
+		}
+		nodes.reserve(2 * from.size() / EDGE_TREE_LEAF_SIZE + 1);
+		build(order, 0, order.size(), boxes);
+
+		// the segments of each leaf next to each other
+		vector<point_t> sortedFrom(from.size()), sortedTo(to.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			sortedFrom[i] = from[order[i]];
+			sortedTo[i] = to[order[i]];
+		}
+		from.swap(sortedFrom);
+		to.swap(sortedTo);
+	}
+
+	size_t EdgeTree::build(vector<size_t>& order, size_t first, size_t count, const vector<Box>& boxes) {
+		size_t index = nodes.size();
+		Node node;
+		node.box = boxes[order[first]];
+		for (size_t i = first + 1; i < first + count; i++) {
+			const Box& b = boxes[order[i]];
+			node.box.minX = min(node.box.minX, b.minX);
+			node.box.minY = min(node.box.minY, b.minY);
+			node.box.maxX = max(node.box.maxX, b.maxX);
+			node.box.maxY = max(node.box.maxY, b.maxY);
+		}
+		node.first = first;
+		node.count = count;
+		node.right = 0;
+		nodes.push_back(node);
+		if (count <= EDGE_TREE_LEAF_SIZE) {
+			return index;
+		}
+
+		// the median of the segment centres along the longer side
+		bool alongX = node.box.maxX - node.box.minX >= node.box.maxY - node.box.minY;
+		auto centre = [&boxes, alongX](size_t i) {
+			return alongX ? boxes[i].minX + boxes[i].maxX : boxes[i].minY + boxes[i].maxY;
+		};
+		size_t half = count / 2;
+		nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+			[&centre](size_t a, size_t b) { return centre(a) < centre(b); });
+
+		build(order, first, half, boxes);
+		size_t right = build(order, first + half, count - half, boxes);
+		nodes[index].count = 0;
+		nodes[index].right = right;
+		return index;
+	}
+
+	size_t EdgeTree::size() const {
+		return from.size();
+	}
+
+	BoundingBox EdgeTree::getBoundingBox() const {
+		BoundingBox bb;
+		if (!nodes.empty()) {
+			bb.minX = nodes[0].box.minX;
+			bb.minY = nodes[0].box.minY;
+			bb.maxX = nodes[0].box.maxX;
+			bb.maxY = nodes[0].box.maxY;
+		}
+		return bb;
+	}
+
+	bool EdgeTree::contains(point_t p) const {
+		// a ray to the right, counting the edges it passes through
+		bool inside = false;
+		size_t stack[EDGE_TREE_STACK];
+		size_t depth = 0;
+		if (!nodes.empty()) {
+			stack[depth++] = 0;
+		}
+		while (depth > 0) {
+			const Node& node = nodes[stack[--depth]];
+			if (node.box.minY > p.y || node.box.maxY <= p.y || node.box.maxX <= p.x) {
+				continue;
+			}
+			if (node.right) {
+				stack[depth++] = node.right;
+				stack[depth++] = &node - nodes.data() + 1;
+				continue;
+			}
+			for (size_t i = node.first; i < node.first + node.count; i++) {
+				const point_t& a = from[i];
+				const point_t& b = to[i];
+				if ((a.y > p.y) != (b.y > p.y) &&
+					p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+					inside = !inside;
+				}
+			}
+		}
+		return inside;
+	}
+
+	double EdgeTree::distance(point_t p) const {
+		double best = numeric_limits<double>::infinity();
+		size_t stack[EDGE_TREE_STACK];
+		size_t depth = 0;
+		if (!nodes.empty()) {
+			stack[depth++] = 0;
+		}
+		while (depth > 0) {
+			const Node& node = nodes[stack[--depth]];
+			if (squaredDistance(node.box, p) >= best) {
+				continue;
+			}
+			if (node.right) {
+				// the nearer child on top, so that it tightens the bound first
+				size_t left = &node - nodes.data() + 1;
+				bool leftFirst = squaredDistance(nodes[left].box, p) <= squaredDistance(nodes[node.right].box, p);
+				stack[depth++] = leftFirst ? node.right : left;
+				stack[depth++] = leftFirst ? left : node.right;
+				continue;
+			}
+			for (size_t i = node.first; i < node.first + node.count; i++) {
+				best = min(best, squaredSegmentDistance(p, from[i], to[i]));
+			}
+		}
+		return sqrt(best);
+	}
+
+	bool EdgeTree::crosses(point_t a, point_t b) const {
+		Box segment = { min(a.x, b.x), min(a.y, b.y), max(a.x, b.x), max(a.y, b.y) };
+		size_t stack[EDGE_TREE_STACK];
+		size_t depth = 0;
+		if (!nodes.empty()) {
+			stack[depth++] = 0;
+		}
+		while (depth > 0) {
+			const Node& node = nodes[stack[--depth]];
+			if (disjoint(node.box, segment)) {
+				continue;
+			}
+			if (node.right) {
+				stack[depth++] = node.right;
+				stack[depth++] = &node - nodes.data() + 1;
+				continue;
+			}
+			for (size_t i = node.first; i < node.first + node.count; i++) {
+				if (segmentsCross(from[i], to[i], a, b)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	bool EdgeTree::crosses(const EdgeTree& other, const transformer_t& transformer) const {
+		if (nodes.empty() || other.nodes.empty()) {
+			return false;
+		}
+		return crosses(0, other, 0, transformer);
+	}
+
+	bool EdgeTree::crosses(size_t node, const EdgeTree& other, size_t otherNode, const transformer_t& transformer) const {
+		const Node& n = nodes[node];
+		const Node& m = other.nodes[otherNode];
+		// the box around the moved box of the other node
+		BoundingBox moved = nester::getBoundingBox({
+			transformPoint(transformer, point_t(m.box.minX, m.box.minY)),
+			transformPoint(transformer, point_t(m.box.maxX, m.box.minY)),
+			transformPoint(transformer, point_t(m.box.maxX, m.box.maxY)),
+			transformPoint(transformer, point_t(m.box.minX, m.box.maxY)) });
+		Box box = { (double)moved.minX, (double)moved.minY, (double)moved.maxX, (double)moved.maxY };
+		if (disjoint(n.box, box)) {
+			return false;
+		}
+
+		if (!n.right && !m.right) {
+			for (size_t j = m.first; j < m.first + m.count; j++) {
+				point_t a = transformPoint(transformer, other.from[j]);
+				point_t b = transformPoint(transformer, other.to[j]);
+				for (size_t i = n.first; i < n.first + n.count; i++) {
+					if (segmentsCross(from[i], to[i], a, b)) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+		// down the larger of the two boxes
+		double area = (n.box.maxX - n.box.minX) * (n.box.maxY - n.box.minY);
+		double otherArea = (box.maxX - box.minX) * (box.maxY - box.minY);
+		if (m.right && (!n.right || otherArea > area)) {
+			return crosses(node, other, otherNode + 1, transformer) || crosses(node, other, m.right, transformer);
+		}
+		return crosses(node + 1, other, otherNode, transformer) || crosses(n.right, other, otherNode, transformer);
+	}
+
+}
@@ -0,0 +1,51 @@
+#ifndef _EDGE_TREE_H_
+#define _EDGE_TREE_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// segments per leaf of an edge tree
+	const size_t EDGE_TREE_LEAF_SIZE = 4;
+
+	// A bounding box hierarchy over the edges of closed rings. Nodes are split at the median along
+	// their longer side and stored depth first, the left child right after its parent, so the queries
+	// only descend into boxes that matter and are logarithmic for parts of any size.
+	class EdgeTree {
+		struct Box {
+			double minX, minY, maxX, maxY;
+		};
+
+		struct Node {
+			Box box;
+			size_t first, count;  // the segments of a leaf
+			size_t right;         // the second child of an inner node, 0 for a leaf
+		};
+
+		vector<point_t> from, to;
+		vector<Node> nodes;
+
+		size_t build(vector<size_t>& order, size_t first, size_t count, const vector<Box>& boxes);
+		bool crosses(size_t node, const EdgeTree& other, size_t otherNode, const transformer_t& transformer) const;
+	public:
+		EdgeTree() {}
+		// the edges of each ring, from its last point back to the first one included
+		explicit EdgeTree(const vector<polygon_t>& rings);
+
+		size_t size() const;
+		BoundingBox getBoundingBox() const;
+
+		// even-odd over all rings: inside the outer ring and outside the holes when the rings are those
+		// of a part. Points on an edge may go either way.
+		bool contains(point_t p) const;
+		// distance to the nearest edge, infinity without edges
+		double distance(point_t p) const;
+		// true when an edge crosses the segment from a to b at a point inside both
+		bool crosses(point_t a, point_t b) const;
+		// true when an edge crosses an edge of the other tree moved by the transformer
+		bool crosses(const EdgeTree& other, const transformer_t& transformer) const;
+	};
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+
+#include "GeneticOrdering.hpp"
+
+namespace nester {
+
+	const size_t TOURNAMENT_SIZE = 3;
+
+	GeneticOrdering::GeneticOrdering(const vector<PartShape>& shapes, NfpCache& nfps, ThreadPool& pool, double sheetWidth, double spacing, unsigned seed) :
+		shapes(shapes), nfps(nfps), pool(pool), sheetWidth(sheetWidth), spacing(spacing),
+		populationSize(max((size_t)4, pool.size())), mutationRate(0.1), stock(nullptr), random(seed) {}
+
+	void GeneticOrdering::setPopulationSize(size_t size) {
+		populationSize = max((size_t)2, size);
+	}
+
+	void GeneticOrdering::setMutationRate(double rate) {
+		mutationRate = rate;
+	}
+
+	void GeneticOrdering::setStart(const NestingResult& start) {
+		this->start = start;
+	}
+
+	void GeneticOrdering::setStock(InnerFitCache* stock) {
+		this->stock = stock;
+	}
+
+	void GeneticOrdering::evaluate(vector<Individual>& population) {
+		for (size_t i = 0; i < population.size(); i++) {
+			if (population[i].evaluated) {
+				continue;
+			}
+			Individual* individual = &population[i];
+			pool.submit([this, individual]() {
+				BottomLeftPlacer placer(shapes, nfps, sheetWidth, spacing);
+				placer.setStock(stock);
+				individual->result = placer.place(individual->order, individual->orientations, start);
+				individual->evaluated = true;
+			});
+		}
+		pool.wait();
+
+		stable_sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+			return a.result.length < b.result.length;
+		});
+	}
+
+	const GeneticOrdering::Individual& GeneticOrdering::select(const vector<Individual>& population) {
+		// the population is sorted, so the lowest index drawn is the fittest contestant
+		uniform_int_distribution<size_t> pick(0, population.size() - 1);
+		size_t best = pick(random);
+		for (size_t i = 1; i < TOURNAMENT_SIZE; i++) {
+			best = min(best, pick(random));
+		}
+		return population[best];
+	}
+
+	GeneticOrdering::Individual GeneticOrdering::crossover(const Individual& mother, const Individual& father) {
+		// order crossover: a slice of the mother's order, the rest in the father's order.
+		// A part keeps the rotation gene of the parent it was taken from.
+		size_t n = mother.order.size();
+		uniform_int_distribution<size_t> pick(0, n);
+		size_t a = pick(random);
+		size_t b = pick(random);
+		if (a > b) {
+			swap(a, b);
+		}
+
+		Individual child;
+		child.evaluated = false;
+		vector<bool> taken(shapes.size(), false);
+		for (size_t i = a; i < b; i++) {
+			taken[mother.order[i]] = true;
+		}
+
+		size_t from = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (i >= a && i < b) {
+				child.order.push_back(mother.order[i]);
+				child.orientations.push_back(mother.orientations[i]);
+				continue;
+			}
+			while (taken[father.order[from]]) {
+				from++;
+			}
+			child.order.push_back(father.order[from]);
+			child.orientations.push_back(father.orientations[from]);
+			taken[father.order[from]] = true;
+		}
+		return child;
+	}
+
+	void GeneticOrdering::mutate(Individual& individual) {
+		uniform_real_distribution<double> chance(0.0, 1.0);
+		int rotations = shapes.empty() ? 1 : (int)shapes[0].orientations.size();
+		uniform_int_distribution<int> orientation(ANY_ORIENTATION, rotations - 1);
+
+		for (size_t i = 0; i < individual.order.size(); i++) {
+			if (i + 1 < individual.order.size() && chance(random) < mutationRate) {
+				swap(individual.order[i], individual.order[i + 1]);
+				swap(individual.orientations[i], individual.orientations[i + 1]);
+				individual.evaluated = false;
+			}
+			if (chance(random) < mutationRate) {
+				individual.orientations[i] = orientation(random);
+				individual.evaluated = false;
+			}
+		}
+	}
+
+	NestingResult GeneticOrdering::optimize(const vector<size_t>& initialOrder, double seconds, ostream& log) {
+		auto started = chrono::steady_clock::now();
+		auto elapsed = [&]() {
+			return chrono::duration<double>(chrono::steady_clock::now() - started).count();
+		};
+
+		vector<Individual> population(1);
+		population[0].order = initialOrder;
+		population[0].orientations.assign(initialOrder.size(), ANY_ORIENTATION);
+		population[0].evaluated = false;
+		while (population.size() < populationSize) {
+			Individual mutant = population[0];
+			mutate(mutant);
+			population.push_back(mutant);
+		}
+		evaluate(population);
+		double firstLength = population[0].result.length;
+
+		size_t generation = 1;
+		while (elapsed() < seconds && initialOrder.size() > 1) {
+			vector<Individual> next;
+			next.push_back(population[0]);  // elitism
+			while (next.size() < populationSize) {
+				Individual child = crossover(select(population), select(population));
+				mutate(child);
+				next.push_back(child);
+			}
+			population.swap(next);
+			evaluate(population);
+			generation++;
+		}
+
+		log << "genetic ordering: " << generation << " generations of " << populationSize << " in " << elapsed()
+			<< "s, length " << firstLength << " -> " << population[0].result.length << endl;
+		return population[0].result;
+	}
+
+}
@@ -0,0 +1,57 @@
+#ifndef _GENETIC_ORDERING_H_
+#define _GENETIC_ORDERING_H_
+
+#include <random>
+
+#include "BottomLeftPlacer.hpp"
+#include "Nester.hpp"
+#include "NoFitPolygon.hpp"
+#include "PartShape.hpp"
+#include "ThreadPool.hpp"
+
+namespace nester {
+
+	// Evolves the order in which parts are handed to the bottom-left placer, and the rotation each part
+	// is placed in. Every member of a generation is placed on its own thread of the pool.
+	class GeneticOrdering {
+		struct Individual {
+			vector<size_t> order;
+			vector<int> orientations;  // per position in order, or ANY_ORIENTATION
+			NestingResult result;
+			bool evaluated;
+		};
+
+		const vector<PartShape>& shapes;
+		NfpCache& nfps;
+		ThreadPool& pool;
+		double sheetWidth;
+		double spacing;
+		size_t populationSize;
+		double mutationRate;
+		NestingResult start;
+		InnerFitCache* stock;
+		mt19937 random;
+
+		void evaluate(vector<Individual>& population);
+		const Individual& select(const vector<Individual>& population);
+		Individual crossover(const Individual& mother, const Individual& father);
+		void mutate(Individual& individual);
+	public:
+		// the cache must have been precomputed since it is read from several threads
+		GeneticOrdering(const vector<PartShape>& shapes, NfpCache& nfps, ThreadPool& pool, double sheetWidth, double spacing, unsigned seed);
+
+		void setPopulationSize(size_t size);
+		void setMutationRate(double rate);
+		// parts which are on the sheet before the evolved ones, in every layout
+		void setStart(const NestingResult& start);
+		// evolves layouts inside a piece of stock of any shape, see BottomLeftPlacer::setStock()
+		void setStock(InnerFitCache* stock);
+
+		// runs generations until the time budget is used up and returns the shortest layout found.
+		// The given order, with free rotations, is always part of the first generation.
+		NestingResult optimize(const vector<size_t>& initialOrder, double seconds, ostream& log);
+	};
+
+}
+
+#endif
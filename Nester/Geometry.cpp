@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+#include "Geometry.hpp"
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// a part is only turned away from its drawn orientation when its box gets smaller by this fraction
+	const double MINIMUM_AREA_GAIN = 1e-6;
+	// points along an arc between those computed with sine and cosine directly
+	const int ARC_EXACT_EVERY = 16;
+	// arcs are tessellated at least this coarsely (cm), and into no more chords than this
+	const double ARC_MINIMUM_TOLERANCE = 1e-9;
+	const int ARC_MAXIMUM_CHORDS = 1 << 20;
+
+	double cross(point_t o, point_t a, point_t b) {
+		return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+	}
+
+	point_t transformPoint(const transformer_t& transformer, point_t p) {
+		glm::dvec3 t = transformer * glm::dvec3(p, 1.0);
+		return point_t(t.x, t.y);
+	}
+
+	polygon_t transformPolygon(const polygon_t& ring, const transformer_t& transformer) {
+		polygon_t result;
+		result.reserve(ring.size());
+		for (const point_t& p : ring) {
+			result.push_back(transformPoint(transformer, p));
+		}
+		return result;
+	}
+
+	double signedArea(const polygon_t& ring) {
+		double area = 0.0;
+		size_t n = ring.size();
+		for (size_t i = 0, j = n - 1; i < n; j = i++) {
+			area += ring[j].x * ring[i].y - ring[i].x * ring[j].y;
+		}
+		return area / 2.0;
+	}
+
+	void makeCounterClockwise(polygon_t& ring) {
+		if (signedArea(ring) < 0.0) {
+			reverse(ring.begin(), ring.end());
+		}
+	}
+
+	void makeClockwise(polygon_t& ring) {
+		if (signedArea(ring) > 0.0) {
+			reverse(ring.begin(), ring.end());
+		}
+	}
+
+	BoundingBox getBoundingBox(const polygon_t& ring) {
+		BoundingBox bb;
+		for (const point_t& p : ring) {
+			bb.minX = min(bb.minX, p.x);
+			bb.maxX = max(bb.maxX, p.x);
+			bb.minY = min(bb.minY, p.y);
+			bb.maxY = max(bb.maxY, p.y);
+		}
+		return bb;
+	}
+
+	polygon_t arcPoints(point_t center, double radius, double startAngle, double sweep, double tolerance) {
+		if (!(radius > 0.0)) {
+			// a point, which starts and ends there
+			return { center, center };
+		}
+		// a chord turning by step strays radius * (1 - cos(step / 2)) from the arc
+		tolerance = max(tolerance, ARC_MINIMUM_TOLERANCE);
+		double step = 2.0 * acos(1.0 - min(tolerance, radius / 2.0) / radius);
+		int chords = (int)max(1.0, min(ceil(fabs(glm::radians(sweep)) / step), (double)ARC_MAXIMUM_CHORDS));
+		// each point is the one before turned by the chord angle, with sine and cosine taken afresh every
+		// ARC_EXACT_EVERY points so that the rounding errors can't add up
+		double turn = glm::radians(sweep) / chords;
+		double c = cos(turn), s = sin(turn);
+		polygon_t points(chords + 1);
+		point_t r;
+		for (int k = 0; k <= chords; k++) {
+			if (k % ARC_EXACT_EVERY == 0 || k == chords) {
+				double angle = glm::radians(startAngle + sweep * k / chords);
+				r = radius * point_t(cos(angle), sin(angle));
+			}
+			else {
+				r = point_t(c * r.x - s * r.y, s * r.x + c * r.y);
+			}
+			points[k] = center + r;
+		}
+		return points;
+	}
+
+	void cleanPolygon(polygon_t& ring, double tolerance) {
+		bool changed = true;
+		while (changed && ring.size() >= 3) {
+			changed = false;
+			polygon_t cleaned;
+			cleaned.reserve(ring.size());
+			size_t n = ring.size();
+			for (size_t i = 0; i < n; i++) {
+				point_t prev = cleaned.empty() ? ring[n - 1] : cleaned.back();
+				point_t cur = ring[i];
+				point_t next = ring[(i + 1) % n];
+
+				double base = glm::length(next - prev);
+				if (glm::length(cur - prev) <= tolerance || fabs(cross(prev, cur, next)) <= tolerance * base) {
+					changed = true;
+					continue;
+				}
+				cleaned.push_back(cur);
+			}
+			ring.swap(cleaned);
+		}
+		if (ring.size() < 3) {
+			ring.clear();
+		}
+	}
+
+	static double segmentDistance(point_t p, point_t a, point_t b) {
+		point_t d = b - a;
+		double length = glm::dot(d, d);
+		double t = length > 0.0 ? glm::dot(p - a, d) / length : 0.0;
+		return glm::distance(p, a + d * max(0.0, min(1.0, t)));
+	}
+
+	polygon_t simplifyPolyline(const polygon_t& points, double tolerance) {
+		if (points.size() < 3) {
+			return points;
+		}
+
+		// spans still to split, without recursion since tessellated curves have thousands of points
+		vector<bool> keep(points.size(), false);
+		keep.front() = keep.back() = true;
+		vector<pair<size_t, size_t> > spans = { make_pair((size_t)0, points.size() - 1) };
+		while (!spans.empty()) {
+			size_t first = spans.back().first, last = spans.back().second;
+			spans.pop_back();
+			double furthest = tolerance;
+			size_t split = 0;
+			for (size_t i = first + 1; i < last; i++) {
+				double d = segmentDistance(points[i], points[first], points[last]);
+				if (d > furthest) {
+					furthest = d;
+					split = i;
+				}
+			}
+			if (split != 0) {
+				keep[split] = true;
+				spans.push_back(make_pair(first, split));
+				spans.push_back(make_pair(split, last));
+			}
+		}
+
+		polygon_t simplified;
+		for (size_t i = 0; i < points.size(); i++) {
+			if (keep[i]) {
+				simplified.push_back(points[i]);
+			}
+		}
+		return simplified;
+	}
+
+	polygon_t simplifyRing(const polygon_t& ring, double tolerance) {
+		if (ring.size() <= 3) {
+			return ring;
+		}
+		size_t far = 0;
+		for (size_t i = 1; i < ring.size(); i++) {
+			if (glm::distance(ring[i], ring[0]) > glm::distance(ring[far], ring[0])) {
+				far = i;
+			}
+		}
+		if (far == 0) {
+			return ring;
+		}
+
+		polygon_t there(ring.begin(), ring.begin() + far + 1);
+		polygon_t back(ring.begin() + far, ring.end());
+		back.push_back(ring[0]);
+		polygon_t simplified = simplifyPolyline(there, tolerance);
+		polygon_t rest = simplifyPolyline(back, tolerance);
+		simplified.insert(simplified.end(), rest.begin() + 1, rest.end() - 1);
+		return simplified;
+	}
+
+	bool pointInPolygon(point_t p, const polygon_t& ring) {
+		bool inside = false;
+		size_t n = ring.size();
+		for (size_t i = 0, j = n - 1; i < n; j = i++) {
+			const point_t& a = ring[i];
+			const point_t& b = ring[j];
+			if ((a.y > p.y) != (b.y > p.y) &&
+				p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+
+	bool isConvex(const polygon_t& ring) {
+		size_t n = ring.size();
+		for (size_t i = 0; i < n; i++) {
+			if (orient2d(ring[(i + n - 1) % n], ring[i], ring[(i + 1) % n]) < 0.0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	polygon_t convexHull(polygon_t points) {
+		sort(points.begin(), points.end(), [](point_t a, point_t b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		});
+		points.erase(unique(points.begin(), points.end()), points.end());
+		if (points.size() < 3) {
+			return points;
+		}
+
+		// Andrew's monotone chain
+		polygon_t hull(2 * points.size());
+		size_t k = 0;
+		for (size_t i = 0; i < points.size(); i++) {
+			while (k >= 2 && orient2d(hull[k - 2], hull[k - 1], points[i]) <= 0.0) k--;
+			hull[k++] = points[i];
+		}
+		for (size_t i = points.size() - 1, t = k + 1; i > 0; i--) {
+			while (k >= t && orient2d(hull[k - 2], hull[k - 1], points[i - 1]) <= 0.0) k--;
+			hull[k++] = points[i - 1];
+		}
+		hull.resize(k - 1);
+		return hull;
+	}
+
+	double minimumAreaAngle(const polygon_t& ring) {
+		polygon_t hull = convexHull(ring);
+		size_t n = hull.size();
+		if (n < 3) {
+			return 0.0;
+		}
+
+		BoundingBox upright = getBoundingBox(hull);
+		double bestArea = (double)(upright.width() * upright.height());
+		double bestAngle = 0.0;
+
+		// one side of the smallest box lies on a hull edge. For each edge in turn the points furthest
+		// along it, furthest behind it and furthest away from it only ever move forward around the hull.
+		size_t ahead = 0, above = 0, behind = 0;
+		for (size_t i = 0; i < n; i++) {
+			point_t along = glm::normalize(hull[(i + 1) % n] - hull[i]);
+			point_t away(-along.y, along.x);
+			if (i == 0) {
+				for (size_t k = 1; k < n; k++) {
+					if (glm::dot(hull[k], along) > glm::dot(hull[ahead], along)) ahead = k;
+					if (glm::dot(hull[k], away) > glm::dot(hull[above], away)) above = k;
+					if (glm::dot(hull[k], along) < glm::dot(hull[behind], along)) behind = k;
+				}
+			}
+			else {
+				while (glm::dot(hull[(ahead + 1) % n], along) > glm::dot(hull[ahead], along)) ahead = (ahead + 1) % n;
+				while (glm::dot(hull[(above + 1) % n], away) > glm::dot(hull[above], away)) above = (above + 1) % n;
+				while (glm::dot(hull[(behind + 1) % n], along) < glm::dot(hull[behind], along)) behind = (behind + 1) % n;
+			}
+
+			double area = glm::dot(hull[ahead] - hull[behind], along) * glm::dot(hull[above] - hull[i], away);
+			// keep the parts as drawn unless turning them really pays off
+			if (area < bestArea * (1.0 - MINIMUM_AREA_GAIN)) {
+				bestArea = area;
+				double angle = fmod(-glm::degrees(atan2(along.y, along.x)), 90.0);
+				bestAngle = angle < 0.0 ? angle + 90.0 : angle;
+			}
+		}
+		return bestAngle;
+	}
+
+	static bool pointInTriangle(point_t p, point_t a, point_t b, point_t c) {
+		return orient2d(a, b, p) >= 0.0 && orient2d(b, c, p) >= 0.0 && orient2d(c, a, p) >= 0.0;
+	}
+
+	static bool isConvexPiece(const vector<size_t>& piece, const polygon_t& ring) {
+		size_t n = piece.size();
+		for (size_t i = 0; i < n; i++) {
+			if (orient2d(ring[piece[(i + n - 1) % n]], ring[piece[i]], ring[piece[(i + 1) % n]]) < 0.0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// joins two counter clockwise pieces sharing the diagonal a->b (in p) / b->a (in q)
+	static vector<size_t> mergePieces(const vector<size_t>& p, const vector<size_t>& q, size_t a, size_t b) {
+		vector<size_t> merged;
+		size_t pb = find(p.begin(), p.end(), b) - p.begin();
+		for (size_t i = 0; i < p.size(); i++) {
+			merged.push_back(p[(pb + i) % p.size()]);  // b ... a
+		}
+		size_t qa = find(q.begin(), q.end(), a) - q.begin();
+		for (size_t i = 1; i + 1 < q.size(); i++) {
+			merged.push_back(q[(qa + i) % q.size()]);  // strictly between a and b
+		}
+		return merged;
+	}
+
+	vector<polygon_t> convexDecomposition(const polygon_t& ring) {
+		vector<polygon_t> result;
+		if (ring.size() < 3) {
+			return result;
+		}
+		if (isConvex(ring)) {
+			result.push_back(ring);
+			return result;
+		}
+
+		// ear clipping
+		vector<vector<size_t> > pieces;
+		vector<size_t> remaining(ring.size());
+		iota(remaining.begin(), remaining.end(), 0);
+
+		size_t i = 0;
+		size_t misses = 0;
+		while (remaining.size() > 3) {
+			size_t m = remaining.size();
+			i %= m;
+			size_t a = remaining[(i + m - 1) % m], b = remaining[i], c = remaining[(i + 1) % m];
+
+			bool ear = orient2d(ring[a], ring[b], ring[c]) > 0.0;
+			for (size_t j = 0; j < m && ear; j++) {
+				size_t v = remaining[j];
+				if (v != a && v != b && v != c && ring[v] != ring[a] && ring[v] != ring[b] && ring[v] != ring[c] &&
+					pointInTriangle(ring[v], ring[a], ring[b], ring[c])) {
+					ear = false;
+				}
+			}
+
+			if (!ear && misses >= m) {
+				// self touching or degenerate ring, there is no proper ear left.
+				// Clip the most convex vertex so that we always make progress.
+				size_t best = 0;
+				double bestCross = -numeric_limits<double>::infinity();
+				for (size_t k = 0; k < m; k++) {
+					double c = cross(ring[remaining[(k + m - 1) % m]], ring[remaining[k]], ring[remaining[(k + 1) % m]]);
+					if (c > bestCross) {
+						bestCross = c;
+						best = k;
+					}
+				}
+				i = best;
+				a = remaining[(i + m - 1) % m];
+				b = remaining[i];
+				c = remaining[(i + 1) % m];
+				ear = true;
+			}
+
+			if (ear) {
+				if (orient2d(ring[a], ring[b], ring[c]) > 0.0) {
+					pieces.push_back({ a, b, c });
+				}
+				remaining.erase(remaining.begin() + i);
+				misses = 0;
+			}
+			else {
+				i++;
+				misses++;
+			}
+		}
+		if (orient2d(ring[remaining[0]], ring[remaining[1]], ring[remaining[2]]) > 0.0) {
+			pieces.push_back(remaining);
+		}
+
+		// Hertel-Mehlhorn: drop diagonals whose removal keeps both sides convex
+		map<pair<size_t, size_t>, size_t> edgeOwner;
+		for (size_t p = 0; p < pieces.size(); p++) {
+			for (size_t k = 0; k < pieces[p].size(); k++) {
+				edgeOwner[make_pair(pieces[p][k], pieces[p][(k + 1) % pieces[p].size()])] = p;
+			}
+		}
+
+		vector<bool> dead(pieces.size(), false);
+		for (size_t p = 0; p < pieces.size(); p++) {
+			bool merged = true;
+			while (!dead[p] && merged) {
+				merged = false;
+				for (size_t k = 0; k < pieces[p].size() && !merged; k++) {
+					size_t a = pieces[p][k];
+					size_t b = pieces[p][(k + 1) % pieces[p].size()];
+					auto other = edgeOwner.find(make_pair(b, a));
+					if (other == edgeOwner.end() || other->second == p || dead[other->second]) {
+						continue;
+					}
+					size_t q = other->second;
+					vector<size_t> candidate = mergePieces(pieces[p], pieces[q], a, b);
+					if (isConvexPiece(candidate, ring)) {
+						edgeOwner.erase(make_pair(a, b));
+						edgeOwner.erase(make_pair(b, a));
+						for (size_t e = 0; e < pieces[q].size(); e++) {
+							auto key = make_pair(pieces[q][e], pieces[q][(e + 1) % pieces[q].size()]);
+							auto it = edgeOwner.find(key);
+							if (it != edgeOwner.end()) {
+								it->second = p;
+							}
+						}
+						pieces[p] = candidate;
+						dead[q] = true;
+						merged = true;
+					}
+				}
+			}
+		}
+
+		for (size_t p = 0; p < pieces.size(); p++) {
+			if (dead[p]) {
+				continue;
+			}
+			polygon_t piece;
+			for (size_t v : pieces[p]) {
+				piece.push_back(ring[v]);
+			}
+			result.push_back(piece);
+		}
+		return result;
+	}
+
+}
@@ -0,0 +1,50 @@
+#ifndef _GEOMETRY_H_
+#define _GEOMETRY_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// z component of (a - o) x (b - o), positive when o, a, b turn counter clockwise
+	double cross(point_t o, point_t a, point_t b);
+
+	point_t transformPoint(const transformer_t& transformer, point_t p);
+	polygon_t transformPolygon(const polygon_t& ring, const transformer_t& transformer);
+
+	// positive for counter clockwise rings
+	double signedArea(const polygon_t& ring);
+	void makeCounterClockwise(polygon_t& ring);
+	void makeClockwise(polygon_t& ring);
+
+	BoundingBox getBoundingBox(const polygon_t& ring);
+
+	// points along the arc around center from startAngle, turning by sweep (degrees, clockwise when
+	// negative), both ends included, with the chords within tolerance of the arc. Without a radius both
+	// ends are the center.
+	polygon_t arcPoints(point_t center, double radius, double startAngle, double sweep, double tolerance);
+
+	// drops repeated points and points lying on the line between their neighbours
+	void cleanPolygon(polygon_t& ring, double tolerance);
+
+	// Douglas-Peucker: keeps both ends and drops every point that lies within tolerance of the
+	// simplified line
+	polygon_t simplifyPolyline(const polygon_t& points, double tolerance);
+	// the same for a closed ring, which is split at the point furthest from its first one
+	polygon_t simplifyRing(const polygon_t& ring, double tolerance);
+
+	bool pointInPolygon(point_t p, const polygon_t& ring);
+	bool isConvex(const polygon_t& ring);
+
+	polygon_t convexHull(polygon_t points);
+
+	// the angle in degrees, in [0, 90), by which the ring is turned so that its bounding box has the
+	// least area (rotating calipers over the convex hull). 0 unless turning makes the box smaller.
+	double minimumAreaAngle(const polygon_t& ring);
+
+	// splits a simple counter clockwise ring into convex counter clockwise pieces
+	// (ear clipping followed by Hertel-Mehlhorn merging of the triangles)
+	vector<polygon_t> convexDecomposition(const polygon_t& ring);
+
+}
+
+#endif
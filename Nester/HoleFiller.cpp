@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Geometry.hpp"
+#include "HoleFiller.hpp"
+
+namespace nester {
+
+	const double HOLE_TOLERANCE = 1e-7;
+
+	HoleFiller::HoleFiller(const vector<PartShape>& shapes) :
+		shapes(shapes), nfps(shapes) {}
+
+	InnerFitCache& HoleFiller::hole(size_t shape, size_t hole) {
+		// parts with the same outline have the same holes
+		shared_ptr<InnerFitCache>& fits = holes[make_pair(shapes[shape].shapeId, hole)];
+		if (!fits) {
+			polygon_t outline = shapes[shape].orientations[0].shrunkHoles[hole];
+			makeCounterClockwise(outline);
+			fits = make_shared<InnerFitCache>(shapes, outline, vector<polygon_t>());
+		}
+		return *fits;
+	}
+
+	vector<HolePlacement> HoleFiller::fill(const vector<size_t>& order) {
+		vector<HolePlacement> filled;
+		vector<bool> taken(shapes.size(), false);
+
+		for (size_t n = 0; n < order.size(); n++) {
+			size_t parent = order[n];
+			const vector<polygon_t>& parentHoles = shapes[parent].orientations[0].shrunkHoles;
+			for (size_t h = 0; h < parentHoles.size(); h++) {
+				double room = fabs(signedArea(parentHoles[h]));
+				BoundingBox holeBounds = getBoundingBox(parentHoles[h]);
+				double holeWidth = (double)holeBounds.width();
+				double holeHeight = (double)holeBounds.height();
+
+				NestingResult result;
+				for (size_t m = n + 1; m < order.size(); m++) {
+					size_t s = order[m];
+					const PartShape& shape = shapes[s];
+					if (taken[s] || shape.area > room) {
+						continue;
+					}
+					bool fits = false;
+					for (size_t o = 0; o < shape.orientations.size() && !fits; o++) {
+						const BoundingBox& bb = shape.orientations[o].grownBounds;
+						fits = (double)bb.width() <= holeWidth + HOLE_TOLERANCE && (double)bb.height() <= holeHeight + HOLE_TOLERANCE;
+					}
+					if (!fits) {
+						continue;
+					}
+
+					BottomLeftPlacer placer(shapes, nfps, holeWidth, 0.0);
+					placer.setStock(&hole(parent, h));
+					NestingResult placed = placer.place({ s }, { ANY_ORIENTATION }, result);
+					const ShapePlacement& p = placed.placements.back();
+					if (p.position.y + (double)shape.orientations[p.orientation].grownBounds.maxY > (double)holeBounds.maxY + HOLE_TOLERANCE) {
+						continue;  // put above the hole, it does not fit
+					}
+
+					result = placed;
+					room -= shape.area;
+					taken[s] = true;
+					HolePlacement placement;
+					placement.shape = s;
+					placement.parent = parent;
+					placement.orientation = p.orientation;
+					placement.position = p.position;
+					filled.push_back(placement);
+				}
+			}
+		}
+		return filled;
+	}
+
+	transformer_t holeTransformer(const PartShape& parent, const transformer_t& parentTransformer, const PartShape& shape, const HolePlacement& placement) {
+		// positions in a hole are in the first orientation of the parent, which is its outline moved by -offset
+		// and turned upright. Undo both, then the parent transformation takes the part along.
+		return parentTransformer * makeTransformation(-parent.upright, parent.offset.x, parent.offset.y) *
+			placementTransformer(shape, placement.orientation, placement.position);
+	}
+
+}
@@ -0,0 +1,45 @@
+#ifndef _HOLE_FILLER_H_
+#define _HOLE_FILLER_H_
+
+#include <map>
+
+#include "BottomLeftPlacer.hpp"
+#include "InnerFitPolygon.hpp"
+#include "Nester.hpp"
+#include "NoFitPolygon.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// A part nested inside a hole of a larger one, where it stays wherever the larger part goes
+	struct HolePlacement {
+		size_t shape;
+		size_t parent;       // the shape with the hole
+		size_t orientation;
+		point_t position;    // in the coordinates of the first orientation of the parent
+	};
+
+	// Fills the holes of large parts with smaller parts before the parts are nested. Each shrunk hole is a
+	// piece of stock of its own for the bottom-left placer. Only parts which pass a cheap test of their area
+	// against what is left of the hole and of their bounding box against that of the hole are tried.
+	class HoleFiller {
+		const vector<PartShape>& shapes;
+		NfpCache nfps;
+		map<pair<size_t, size_t>, shared_ptr<InnerFitCache> > holes;  // per shape id and hole
+
+		InnerFitCache& hole(size_t shape, size_t hole);
+	public:
+		// the parts keep the margins of their shapes to each other and to the edges of the holes
+		HoleFiller(const vector<PartShape>& shapes);
+
+		// order holds the shapes largest first. Returns the parts placed in holes, each after the part
+		// whose hole it is in when that is in a hole itself.
+		vector<HolePlacement> fill(const vector<size_t>& order);
+	};
+
+	// the transformation of a part in a hole, given the one of the part with the hole
+	transformer_t holeTransformer(const PartShape& parent, const transformer_t& parentTransformer, const PartShape& shape, const HolePlacement& placement);
+
+}
+
+#endif
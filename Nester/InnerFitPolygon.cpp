@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <limits>
+
+#include "Geometry.hpp"
+#include "InnerFitPolygon.hpp"
+
+namespace nester {
+
+	// how far the area outside the outline reaches beyond its bounding box (cm)
+	const double INNER_FIT_MARGIN = 1.0;
+
+	static OrientedShape obstacle(polygon_t ring) {
+		cleanPolygon(ring, 1e-9);
+		makeCounterClockwise(ring);
+		OrientedShape shape;
+		shape.angle = 0.0;
+		shape.outer = ring;
+		shape.bounds = getBoundingBox(ring);
+		shape.grown = ring;
+		shape.pieces = convexDecomposition(ring);
+		shape.grownBounds = shape.bounds;
+		return shape;
+	}
+
+	InnerFitCache::InnerFitCache(const vector<PartShape>& shapes, const polygon_t& outline, const vector<polygon_t>& holes) :
+		shapes(shapes) {
+		bounds = getBoundingBox(outline);
+		if (outline.size() < 3) {
+			return;
+		}
+
+		// the box minus the outline in two simple pieces, split at the leftmost and rightmost points.
+		// Counter clockwise from the leftmost point the outline runs along the bottom to the rightmost.
+		size_t n = outline.size();
+		size_t left = 0, right = 0;
+		for (size_t i = 1; i < n; i++) {
+			const point_t& p = outline[i];
+			if (p.x < outline[left].x || (p.x == outline[left].x && p.y < outline[left].y)) {
+				left = i;
+			}
+			if (p.x > outline[right].x || (p.x == outline[right].x && p.y > outline[right].y)) {
+				right = i;
+			}
+		}
+		double x0 = (double)bounds.minX - INNER_FIT_MARGIN, x1 = (double)bounds.maxX + INNER_FIT_MARGIN;
+		double y0 = (double)bounds.minY - INNER_FIT_MARGIN, y1 = (double)bounds.maxY + INNER_FIT_MARGIN;
+
+		polygon_t below = { point_t(x0, outline[left].y), point_t(x0, y0), point_t(x1, y0), point_t(x1, outline[right].y) };
+		for (size_t i = right; ; i = (i + n - 1) % n) {
+			below.push_back(outline[i]);
+			if (i == left) {
+				break;
+			}
+		}
+		polygon_t above = { point_t(x1, outline[right].y), point_t(x1, y1), point_t(x0, y1), point_t(x0, outline[left].y) };
+		for (size_t i = left; ; i = (i + n - 1) % n) {
+			above.push_back(outline[i]);
+			if (i == right) {
+				break;
+			}
+		}
+
+		obstacles.push_back(obstacle(below));
+		obstacles.push_back(obstacle(above));
+		for (const polygon_t& hole : holes) {
+			if (hole.size() >= 3) {
+				obstacles.push_back(obstacle(hole));
+			}
+		}
+	}
+
+	InnerFitPolygon InnerFitCache::compute(const OrientedShape& moving) const {
+		InnerFitPolygon fit;
+		fit.xMin = (double)bounds.minX - (double)moving.grownBounds.minX;
+		fit.xMax = (double)bounds.maxX - (double)moving.grownBounds.maxX;
+		fit.yMin = (double)bounds.minY - (double)moving.grownBounds.minY;
+		fit.yMax = (double)bounds.maxY - (double)moving.grownBounds.maxY;
+		if (fit.xMax < fit.xMin || fit.yMax < fit.yMin) {
+			return fit;
+		}
+		// the convex hull fallback of the part pairs would close off the stock, so never take it
+		for (const OrientedShape& o : obstacles) {
+			fit.obstacles.push_back(computeNoFitPolygon(o, moving, numeric_limits<size_t>::max()));
+		}
+		return fit;
+	}
+
+	const BoundingBox& InnerFitCache::getBounds() const {
+		return bounds;
+	}
+
+	const InnerFitPolygon& InnerFitCache::get(size_t shape, size_t orientation) {
+		pair<size_t, size_t> key(shapes[shape].shapeId, orientation);
+		{
+			lock_guard<mutex> guard(lock);
+			auto known = fits.find(key);
+			if (known != fits.end()) {
+				return *known->second;
+			}
+		}
+
+		// computed outside the lock so other sheets are not held up, the first result to arrive is kept
+		shared_ptr<InnerFitPolygon> fit = make_shared<InnerFitPolygon>(compute(shapes[shape].orientations[orientation]));
+		lock_guard<mutex> guard(lock);
+		return *fits.insert(make_pair(key, fit)).first->second;
+	}
+
+}
@@ -0,0 +1,43 @@
+#ifndef _INNER_FIT_POLYGON_H_
+#define _INNER_FIT_POLYGON_H_
+
+#include <map>
+#include <mutex>
+
+#include "Nester.hpp"
+#include "NoFitPolygon.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// Where a part may be placed on a piece of stock of any shape. The reference point has to stay in
+	// the rectangle which keeps the part within the bounding box of the stock, and out of the no-fit
+	// polygons of the part with everything in that box which is not stock: the area between the outline
+	// and the box, and the holes.
+	struct InnerFitPolygon {
+		double xMin, xMax, yMin, yMax;
+		vector<NoFitPolygon> obstacles;  // in stock coordinates
+	};
+
+	// The inner-fit polygons of the parts on one stock profile, computed the first time each shape and
+	// orientation asks for it. Safe to use from several threads.
+	class InnerFitCache {
+		const vector<PartShape>& shapes;
+		vector<OrientedShape> obstacles;
+		BoundingBox bounds;
+		map<pair<size_t, size_t>, shared_ptr<InnerFitPolygon> > fits;
+		mutex lock;
+
+		InnerFitPolygon compute(const OrientedShape& moving) const;
+	public:
+		// outline and holes of the stock, the outline counter clockwise. The grown outlines of the parts
+		// stay inside, so offset the stock by their margin for parts to reach its boundary.
+		InnerFitCache(const vector<PartShape>& shapes, const polygon_t& outline, const vector<polygon_t>& holes);
+
+		const BoundingBox& getBounds() const;
+		const InnerFitPolygon& get(size_t shape, size_t orientation);
+	};
+
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <set>
+
+#include "EdgeTree.hpp"
+#include "Geometry.hpp"
+#include "LayoutVerifier.hpp"
+#include "PolygonBoolean.hpp"
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// segments this close to an event point on the sweep line run through it (cm)
+	const double VERIFY_SNAP = 1e-9;
+
+	namespace {
+
+		struct SweepSegment {
+			point_t a, b;  // a comes first in sweep order
+			size_t part;
+		};
+
+		// the events at one point are handled together
+		enum SweepEventType {
+			EVENT_END,
+			EVENT_CROSSING,
+			EVENT_START
+		};
+
+		struct SweepEvent {
+			point_t p;
+			SweepEventType type;
+			size_t first, second;  // the segments
+			size_t sequence;       // first come first served at the same point
+
+			bool operator>(const SweepEvent& other) const {
+				if (p.x != other.p.x) {
+					return p.x > other.p.x;
+				}
+				if (p.y != other.p.y) {
+					return p.y > other.p.y;
+				}
+				if (type != other.type) {
+					return type > other.type;
+				}
+				return sequence > other.sequence;
+			}
+		};
+
+		bool before(point_t a, point_t b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		}
+
+		class IntersectionSweep {
+			// the segment in a slot of the sweep line changes when the segments through a point are put in order
+			struct Slot {
+				mutable size_t segment;
+			};
+
+			struct SlotBelow {
+				const IntersectionSweep* sweep;
+
+				bool operator()(const Slot& s, const Slot& t) const {
+					return sweep->below(s.segment, t.segment);
+				}
+			};
+
+			typedef set<Slot, SlotBelow> SweepLine;
+
+			const vector<SweepSegment>& segments;
+			double tolerance;
+			point_t sweep;
+			SweepLine line;
+			vector<SweepLine::iterator> positions;
+			vector<bool> onLine;
+			vector<bool> grouped, ending, done;  // the segments of the events at the sweep point
+			priority_queue<SweepEvent, vector<SweepEvent>, greater<SweepEvent> > events;
+			size_t sequence;
+			set<pair<size_t, size_t> > crossed;
+			map<pair<size_t, size_t>, LayoutViolation> violations;
+
+			double heightAt(size_t i) const {
+				const SweepSegment& s = segments[i];
+				if (s.a.x == s.b.x) {
+					return max(s.a.y, min(sweep.y, s.b.y));
+				}
+				if (sweep.x <= s.a.x) {
+					return s.a.y;
+				}
+				if (sweep.x >= s.b.x) {
+					return s.b.y;
+				}
+				return s.a.y + (s.b.y - s.a.y) * (sweep.x - s.a.x) / (s.b.x - s.a.x);
+			}
+
+			bool below(size_t i, size_t j) const {
+				if (i == j) {
+					return false;
+				}
+				double hi = heightAt(i), hj = heightAt(j);
+				if (hi != hj) {
+					return hi < hj;
+				}
+				// through the same point: the flatter one stays below right of it
+				point_t di = segments[i].b - segments[i].a, dj = segments[j].b - segments[j].a;
+				double turn = di.x * dj.y - di.y * dj.x;
+				if (turn != 0.0) {
+					return turn > 0.0;
+				}
+				return i < j;
+			}
+
+			void push(point_t p, SweepEventType type, size_t first, size_t second) {
+				SweepEvent e = { p, type, first, second, sequence++ };
+				events.push(e);
+			}
+
+			void report(size_t first, size_t second, ViolationKind kind, point_t where) {
+				pair<size_t, size_t> key(min(first, second), max(first, second));
+				if (violations.find(key) == violations.end()) {
+					LayoutViolation v = { first, second, kind, where, 0.0 };
+					violations[key] = v;
+				}
+			}
+
+			// reports the crossing of two segments when the parts differ, false when they do not cross
+			bool crossing(size_t i, size_t j, point_t& p) {
+				const SweepSegment& s = segments[i];
+				const SweepSegment& t = segments[j];
+				if (!segmentsCross(s.a, s.b, t.a, t.b)) {
+					return false;
+				}
+				double c1 = cross(s.a, s.b, t.a), c2 = cross(s.a, s.b, t.b);
+				double c3 = cross(t.a, t.b, s.a), c4 = cross(t.a, t.b, s.b);
+				p = s.a + (s.b - s.a) * (c3 / (c3 - c4));
+				if (before(p, sweep)) {
+					p = sweep;
+				}
+
+				// how far the edges reach across each other
+				double ls = glm::length(s.b - s.a), lt = glm::length(t.b - t.a);
+				double depth = min(min(fabs(c1), fabs(c2)) / ls, min(fabs(c3), fabs(c4)) / lt);
+				if (s.part != t.part && depth > tolerance) {
+					report(s.part, t.part, VIOLATION_CROSSING, p);
+				}
+				return true;
+			}
+
+			// queues the crossing of two neighbours on the sweep line
+			void check(SweepLine::iterator lower, SweepLine::iterator upper) {
+				size_t i = lower->segment, j = upper->segment;
+				pair<size_t, size_t> key(min(i, j), max(i, j));
+				point_t p;
+				if (crossed.find(key) == crossed.end() && crossing(i, j, p)) {
+					crossed.insert(key);
+					push(p, EVENT_CROSSING, i, j);
+				}
+			}
+
+			// the order of segments through the sweep point right of it: by direction, overlapping ones by height
+			bool leaves(size_t i, size_t j) const {
+				double ai = angle(segments[i]), aj = angle(segments[j]);
+				if (ai != aj) {
+					return ai < aj;
+				}
+				double hi = heightAt(i), hj = heightAt(j);
+				if (hi != hj) {
+					return hi < hj;
+				}
+				return i < j;
+			}
+
+			static double angle(const SweepSegment& s) {
+				return atan2(s.b.y - s.a.y, s.b.x - s.a.x);
+			}
+
+			bool through(SweepLine::iterator position) const {
+				return grouped[position->segment] || fabs(heightAt(position->segment) - sweep.y) <= VERIFY_SNAP;
+			}
+
+			// The segments which end, start or cross at the sweep point and those running through it lie next
+			// to each other on the sweep line. Their crossings at the point are reported, the ending ones leave
+			// and the others are put in the order they take right of the point, so only the outer ones of the
+			// run get new neighbours.
+			void reorder(SweepLine::iterator first, SweepLine::iterator last) {
+				SweepLine::iterator lower = first == line.begin() ? line.end() : prev(first);
+				SweepLine::iterator upper = next(last);
+				vector<SweepLine::iterator> run;
+				for (SweepLine::iterator it = first; it != upper; ++it) {
+					run.push_back(it);
+				}
+				for (size_t k = 0; k < run.size(); k++) {
+					for (size_t l = k + 1; l < run.size(); l++) {
+						size_t i = run[k]->segment, j = run[l]->segment;
+						pair<size_t, size_t> key(min(i, j), max(i, j));
+						point_t p;
+						if (crossed.find(key) == crossed.end() && crossing(i, j, p)) {
+							crossed.insert(key);
+						}
+					}
+				}
+
+				vector<SweepLine::iterator> slots;
+				vector<size_t> staying;
+				for (SweepLine::iterator it : run) {
+					if (ending[it->segment]) {
+						onLine[it->segment] = false;
+						line.erase(it);
+					}
+					else {
+						slots.push_back(it);
+						staying.push_back(it->segment);
+					}
+				}
+				sort(staying.begin(), staying.end(), [this](size_t i, size_t j) { return leaves(i, j); });
+				for (size_t k = 0; k < slots.size(); k++) {
+					slots[k]->segment = staying[k];
+					positions[staying[k]] = slots[k];
+				}
+
+				if (slots.empty()) {
+					if (lower != line.end() && upper != line.end()) {
+						check(lower, upper);
+					}
+					return;
+				}
+				if (lower != line.end()) {
+					check(lower, slots.front());
+				}
+				if (upper != line.end()) {
+					check(slots.back(), upper);
+				}
+			}
+
+			// handles the segments of the events at the sweep point as one group
+			void handle(const vector<size_t>& group) {
+				vector<size_t> seen;
+				for (size_t i : group) {
+					if (!onLine[i] && !ending[i]) {
+						positions[i] = line.insert(Slot{ i }).first;
+						onLine[i] = true;
+					}
+				}
+				for (size_t i : group) {
+					if (!onLine[i] || done[i]) {
+						continue;
+					}
+					SweepLine::iterator first = positions[i], last = positions[i];
+					while (first != line.begin() && through(prev(first))) {
+						--first;
+					}
+					while (next(last) != line.end() && through(next(last))) {
+						++last;
+					}
+					for (SweepLine::iterator it = first; it != next(last); ++it) {
+						done[it->segment] = true;
+						seen.push_back(it->segment);
+					}
+					reorder(first, last);
+				}
+				for (size_t i : seen) {
+					done[i] = false;
+				}
+			}
+
+		public:
+			IntersectionSweep(const vector<SweepSegment>& segments, double tolerance) :
+				segments(segments), tolerance(tolerance), line(SlotBelow{ this }), positions(segments.size()),
+				onLine(segments.size(), false), grouped(segments.size(), false), ending(segments.size(), false),
+				done(segments.size(), false), sequence(0) {
+			}
+
+			vector<LayoutViolation> run() {
+				for (size_t i = 0; i < segments.size(); i++) {
+					push(segments[i].a, EVENT_START, i, i);
+					push(segments[i].b, EVENT_END, i, i);
+				}
+				vector<size_t> group;
+				while (!events.empty()) {
+					sweep = events.top().p;
+					while (!events.empty() && events.top().p == sweep) {
+						SweepEvent e = events.top();
+						events.pop();
+						for (size_t i : { e.first, e.second }) {
+							if (!grouped[i] && (e.type != EVENT_CROSSING || onLine[i])) {
+								grouped[i] = true;
+								group.push_back(i);
+							}
+						}
+						if (e.type == EVENT_END) {
+							ending[e.first] = true;
+						}
+					}
+					handle(group);
+					for (size_t i : group) {
+						grouped[i] = ending[i] = false;
+					}
+					group.clear();
+				}
+
+				vector<LayoutViolation> result;
+				for (const auto& v : violations) {
+					result.push_back(v.second);
+				}
+				return result;
+			}
+		};
+
+	}
+
+	// the rings of a placed part on its sheet, the outline counter clockwise and the holes clockwise as the
+	// boolean operations want them. None without an outline.
+	static vector<polygon_t> sheetRings(const Placement& placement) {
+		vector<polygon_t> rings;
+		polygon_p outline = placement.part->toPolygon();
+		if (!outline || outline->size() < 3) {
+			return rings;
+		}
+		rings.push_back(transformPolygon(*outline, placement.transformer));
+		makeCounterClockwise(rings[0]);
+		for (polygon_p hole : placement.part->toHolePolygons()) {
+			if (hole && hole->size() >= 3) {
+				rings.push_back(transformPolygon(*hole, placement.transformer));
+				makeClockwise(rings.back());
+			}
+		}
+		return rings;
+	}
+
+	vector<LayoutViolation> verifyLayout(const vector<Placement>& placements, double tolerance) {
+		map<size_t, vector<size_t> > bySheet;
+		for (size_t i = 0; i < placements.size(); i++) {
+			bySheet[placements[i].sheet].push_back(i);
+		}
+
+		vector<LayoutViolation> result;
+		vector<BoundingBox> bounds(placements.size());
+		for (const auto& sheet : bySheet) {
+			vector<SweepSegment> segments;
+			vector<pair<size_t, point_t> > probes;
+			vector<size_t> placed;
+			double widest = 0.0;
+			for (size_t i : sheet.second) {
+				vector<polygon_t> rings = sheetRings(placements[i]);
+				if (rings.empty()) {
+					continue;
+				}
+				bounds[i] = getBoundingBox(rings[0]);
+				widest = max(widest, bounds[i].width());
+				placed.push_back(i);
+				for (const polygon_t& ring : rings) {
+					for (size_t k = 0; k < ring.size(); k++) {
+						point_t a = ring[k], b = ring[(k + 1) % ring.size()];
+						if (a == b) {
+							continue;
+						}
+						SweepSegment s = { before(a, b) ? a : b, before(a, b) ? b : a, i };
+						segments.push_back(s);
+					}
+				}
+
+				// the first corner of the outline in sweep order is convex, so the part lies between its edges
+				const polygon_t& ring = rings[0];
+				size_t first = min_element(ring.begin(), ring.end(), before) - ring.begin();
+				point_t v = ring[first];
+				point_t toPrev = ring[(first + ring.size() - 1) % ring.size()] - v, toNext = ring[(first + 1) % ring.size()] - v;
+				if (glm::length(toPrev) > 0.0 && glm::length(toNext) > 0.0) {
+					point_t bisector = glm::normalize(toPrev) + glm::normalize(toNext);
+					if (glm::length(bisector) > 1e-9) {
+						probes.push_back(make_pair(i, v + glm::normalize(bisector) * (2.0 * max(tolerance, 1e-9))));
+					}
+				}
+			}
+
+			IntersectionSweep sweep(segments, tolerance);
+			vector<LayoutViolation> found = sweep.run();
+			set<pair<size_t, size_t> > overlapping;
+			for (const LayoutViolation& v : found) {
+				overlapping.insert(make_pair(min(v.first, v.second), max(v.first, v.second)));
+			}
+
+			// the probe of a part is looked up in the edge trees of the parts whose boxes hold it, which are
+			// found among the parts sorted by their left sides
+			sort(placed.begin(), placed.end(), [&](size_t a, size_t b) { return bounds[a].minX < bounds[b].minX; });
+			for (const auto& probe : probes) {
+				size_t i = probe.first;
+				point_t p = probe.second;
+				auto first = lower_bound(placed.begin(), placed.end(), p.x - widest, [&](size_t j, double x) { return bounds[j].minX < x; });
+				for (auto it = first; it != placed.end() && bounds[*it].minX <= p.x; ++it) {
+					size_t j = *it;
+					const BoundingBox& bb = bounds[j];
+					if (j == i || p.x > bb.maxX || p.y < bb.minY || p.y > bb.maxY || overlapping.count(make_pair(min(i, j), max(i, j)))) {
+						continue;
+					}
+					point_t local = transformPoint(glm::inverse(placements[j].transformer), p);
+					if (placements[j].part->getEdgeTree()->contains(local)) {
+						LayoutViolation v = { i, j, VIOLATION_INSIDE, p, 0.0 };
+						found.push_back(v);
+						overlapping.insert(make_pair(min(i, j), max(i, j)));
+					}
+				}
+			}
+
+			for (LayoutViolation& v : found) {
+				v.area = overlapArea(sheetRings(placements[v.first]), sheetRings(placements[v.second]));
+			}
+			result.insert(result.end(), found.begin(), found.end());
+		}
+		return result;
+	}
+
+}
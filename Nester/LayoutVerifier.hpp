@@ -0,0 +1,21 @@
+#ifndef _LAYOUT_VERIFIER_H_
+#define _LAYOUT_VERIFIER_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// edges may cross by this much before the parts count as overlapping (cm)
+	const double VERIFY_TOLERANCE = 1e-6;
+
+	// Finds the pairs of placed parts which overlap. All edges of the parts on a sheet go through a
+	// Bentley-Ottmann sweep, which finds the k crossings among n edges in O((n + k) log n). Edges which
+	// end, start or cross at the same point are handled together there. Parts which only touch are fine.
+	// A part may also lie inside another one without any crossing, so a point just inside each part is
+	// looked up in the edge trees of the parts whose boxes hold it. The overlaps found are measured
+	// with an intersection of the two parts.
+	vector<LayoutViolation> verifyLayout(const vector<Placement>& placements, double tolerance = VERIFY_TOLERANCE);
+
+}
+
+#endif
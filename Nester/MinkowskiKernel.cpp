@@ -0,0 +1,171 @@
+#include <cmath>
+#include <limits>
+
+#include "MinkowskiKernel.hpp"
+#include "Simd.hpp"
+
+namespace nester {
+
+	// monotonic in the angle of (dx, dy) from the x axis, 0 along it and counting up to 4 for a full turn
+	static double pseudoAngle(double dx, double dy) {
+		double r = fabs(dy) / (fabs(dx) + fabs(dy));
+		return dy >= 0.0 ? (dx >= 0.0 ? r : 2.0 - r) : (dx < 0.0 ? 2.0 + r : 4.0 - r);
+	}
+
+	ConvexPieces::ConvexPieces(const vector<polygon_t>& pieces) {
+		for (const polygon_t& piece : pieces) {
+			add(piece);
+		}
+	}
+
+	void ConvexPieces::add(const polygon_t& piece) {
+		polygon_t ring;
+		for (const point_t& p : piece) {
+			if (ring.empty() || p != ring.back()) {
+				ring.push_back(p);
+			}
+		}
+		while (ring.size() > 1 && ring.front() == ring.back()) {
+			ring.pop_back();
+		}
+
+		size_t n = ring.size();
+		size_t lowest = 0;
+		for (size_t i = 1; i < n; i++) {
+			if (ring[i].y < ring[lowest].y || (ring[i].y == ring[lowest].y && ring[i].x < ring[lowest].x)) {
+				lowest = i;
+			}
+		}
+
+		firstVertex.push_back(x.size());
+		firstSlope.push_back(slopes.size());
+		edges.push_back(n < 2 ? 0 : n);
+		for (size_t k = 0; k <= n && n > 0; k++) {
+			x.push_back(ring[(lowest + k) % n].x);
+			y.push_back(ring[(lowest + k) % n].y);
+		}
+		if (n < 2) {
+			return;
+		}
+
+		size_t v = firstVertex.back();
+		size_t padded = (n + SLOPE_BLOCK - 1) / SLOPE_BLOCK * SLOPE_BLOCK;
+		slopes.resize(slopes.size() + padded, numeric_limits<double>::infinity());
+		double* s = slopes.data() + firstSlope.back();
+		const double* px = x.data() + v;
+		const double* py = y.data() + v;
+		for (size_t k = 0; k < n; k++) {
+			s[k] = pseudoAngle(px[k + 1] - px[k], py[k + 1] - py[k]);
+		}
+	}
+
+	size_t ConvexPieces::size() const {
+		return edges.size();
+	}
+
+	polygon_t ConvexPieces::piece(size_t i) const {
+		polygon_t ring;
+		for (size_t k = 0; k < edges[i]; k++) {
+			ring.push_back(point_t(x[firstVertex[i] + k], y[firstVertex[i] + k]));
+		}
+		return ring;
+	}
+
+	// For each of the own slopes the number of other slopes below it, or with orEqual not above it,
+	// plus its own index: where it goes in the merged order. own is padded to whole blocks.
+	static void mergeRanks(const double* own, size_t ownCount, const double* other, size_t otherCount, bool orEqual, long long* ranks) {
+		for (size_t i = 0; i < ownCount; i++) {
+			long long below = 0;
+			for (size_t j = 0; j < otherCount; j++) {
+				below += orEqual ? other[j] <= own[i] : other[j] < own[i];
+			}
+			ranks[i] = (long long)i + below;
+		}
+	}
+
+#ifdef NESTER_AVX2
+	// four own slopes at a time against each other slope
+	AVX2_TARGET static void mergeRanksAvx2(const double* own, size_t ownCount, const double* other, size_t otherCount, bool orEqual, long long* ranks) {
+		const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+		for (size_t i = 0; i < ownCount; i += SLOPE_BLOCK) {
+			__m256d mine = _mm256_loadu_pd(own + i);
+			__m256i rank = _mm256_add_epi64(_mm256_set1_epi64x((long long)i), lanes);
+			for (size_t j = 0; j < otherCount; j++) {
+				__m256d theirs = _mm256_broadcast_sd(other + j);
+				__m256d below = orEqual ? _mm256_cmp_pd(theirs, mine, _CMP_LE_OQ) : _mm256_cmp_pd(theirs, mine, _CMP_LT_OQ);
+				// a true comparison is all ones, which is -1
+				rank = _mm256_sub_epi64(rank, _mm256_castpd_si256(below));
+			}
+			_mm256_storeu_si256((__m256i*)(ranks + i), rank);
+		}
+	}
+#endif
+
+	static void ranksOf(const double* own, size_t ownCount, const double* other, size_t otherCount, bool orEqual, long long* ranks) {
+#ifdef NESTER_AVX2
+		if (hasAvx2()) {
+			mergeRanksAvx2(own, ownCount, other, otherCount, orEqual, ranks);
+			return;
+		}
+#endif
+		mergeRanks(own, ownCount, other, otherCount, orEqual, ranks);
+	}
+
+	// merges two ascending slope lists in one walk, equal slopes put the edge of a first
+	static void mergeWalk(const double* slopesA, size_t n, const double* slopesB, size_t m, unsigned char* fromA, double* merged) {
+		size_t ia = 0, ib = 0;
+		for (size_t k = 0; k < n + m; k++) {
+			bool takeA = ib == m || (ia < n && slopesA[ia] <= slopesB[ib]);
+			fromA[k] = takeA ? 1 : 0;
+			merged[k] = takeA ? slopesA[ia++] : slopesB[ib++];
+		}
+	}
+
+	void MinkowskiKernel::sum(const ConvexPieces& a, size_t i, const ConvexPieces& b, size_t j, polygon_t& sum) {
+		sum.clear();
+		size_t n = a.edges[i];
+		size_t m = b.edges[j];
+		if (n == 0 || m == 0) {
+			return;
+		}
+		const double* slopesA = a.slopes.data() + a.firstSlope[i];
+		const double* slopesB = b.slopes.data() + b.firstSlope[j];
+
+		fromA.resize(n + m);
+		mergedSlopes.resize(n + m);
+		if (n + m > RANK_MERGE_LIMIT) {
+			mergeWalk(slopesA, n, slopesB, m, fromA.data(), mergedSlopes.data());
+		}
+		else {
+			// equal slopes put the edge of a first
+			ranks.resize((n + SLOPE_BLOCK) / SLOPE_BLOCK * SLOPE_BLOCK + (m + SLOPE_BLOCK) / SLOPE_BLOCK * SLOPE_BLOCK);
+			long long* ranksB = ranks.data() + (n + SLOPE_BLOCK) / SLOPE_BLOCK * SLOPE_BLOCK;
+			ranksOf(slopesA, n, slopesB, m, false, ranks.data());
+			ranksOf(slopesB, m, slopesA, n, true, ranksB);
+			for (size_t k = 0; k < n; k++) {
+				fromA[(size_t)ranks[k]] = 1;
+				mergedSlopes[(size_t)ranks[k]] = slopesA[k];
+			}
+			for (size_t k = 0; k < m; k++) {
+				fromA[(size_t)ranksB[k]] = 0;
+				mergedSlopes[(size_t)ranksB[k]] = slopesB[k];
+			}
+		}
+
+		// both pieces start at their lowest vertex, so does the sum
+		const double* ax = a.x.data() + a.firstVertex[i];
+		const double* ay = a.y.data() + a.firstVertex[i];
+		const double* bx = b.x.data() + b.firstVertex[j];
+		const double* by = b.y.data() + b.firstVertex[j];
+		sum.reserve(n + m);
+		size_t ia = 0, ib = 0;
+		for (size_t k = 0; k < n + m; k++) {
+			if (k == 0 || mergedSlopes[k] != mergedSlopes[k - 1]) {
+				sum.push_back(point_t(ax[ia] + bx[ib], ay[ia] + by[ib]));
+			}
+			ia += fromA[k];
+			ib += 1 - fromA[k];
+		}
+	}
+
+}
@@ -0,0 +1,49 @@
+#ifndef _MINKOWSKI_KERNEL_H_
+#define _MINKOWSKI_KERNEL_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// edge slopes are compared in blocks of this many
+	const size_t SLOPE_BLOCK = 4;
+	// pairs with more edges than this together are merged edge by edge, counting ranks grows with the
+	// product of the edge counts
+	const size_t RANK_MERGE_LIMIT = 32;
+
+	// Convex counter clockwise polygons packed into flat coordinate arrays, prepared once for any number
+	// of Minkowski sums: each piece starts at its lowest vertex and repeats it at the end, and the slope
+	// of each edge is kept as a pseudo angle which grows along the piece. The slopes of a piece are
+	// padded with infinity to whole blocks.
+	struct ConvexPieces {
+		vector<double> x, y;
+		vector<double> slopes;
+		vector<size_t> firstVertex, firstSlope, edges;  // per piece
+
+		ConvexPieces() {}
+		explicit ConvexPieces(const vector<polygon_t>& pieces);
+
+		void add(const polygon_t& piece);
+		size_t size() const;
+		polygon_t piece(size_t i) const;
+	};
+
+	// Sums pairs of convex pieces by merging their edges in slope order. For small pieces, the common
+	// case, every edge finds its place in the merged order by counting the edges of the other piece
+	// with a smaller slope instead of walking both edge lists with a branch per step, which runs on
+	// whole blocks of slopes at once. That takes n times m comparisons, so larger pairs are walked.
+	// The vertices then follow from one pass over the merged edges. Holds the buffers for that, so
+	// keep one per thread.
+	class MinkowskiKernel {
+		vector<unsigned char> fromA;  // per merged edge, whether it is an edge of the first piece
+		vector<double> mergedSlopes;
+		vector<long long> ranks;
+	public:
+		// replaces sum with the sum of piece i of a and piece j of b. Where edges of both are parallel the
+		// vertex between them is left out.
+		void sum(const ConvexPieces& a, size_t i, const ConvexPieces& b, size_t j, polygon_t& sum);
+	};
+
+}
+
+#endif
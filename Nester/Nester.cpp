@@ -1,6 +1,28 @@
 #include <algorithm> 
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
 
 #include "Nester.hpp"
+#include "BottomLeftPlacer.hpp"
+#include "EdgeTree.hpp"
+#include "GeneticOrdering.hpp"
+#include "Geometry.hpp"
+#include "HoleFiller.hpp"
+#include "InnerFitPolygon.hpp"
+#include "LayoutVerifier.hpp"
+#include "NoFitPolygon.hpp"
+#include "Nurbs.hpp"
+#include "Offset.hpp"
+#include "OverlapAnnealer.hpp"
+#include "PartShape.hpp"
+#include "RasterPlacer.hpp"
+#include "RectanglePacker.hpp"
+#include "SheetAssignment.hpp"
+#include "ShelfPacker.hpp"
+#include "ThreadPool.hpp"
 
 namespace nester {
 
@@ -25,6 +47,51 @@ namespace nester {
 		return mat;
 	}
 
+	void FileWriter::arc(point_t center, double radius, double startAngle, double endAngle, int color) {
+		double sweep = fmod(endAngle - startAngle, 360.0);
+		if (sweep <= 0.0) {
+			sweep += 360.0;
+		}
+		polygon_t points = arcPoints(center, radius, startAngle, sweep, curveTolerance);
+		for (size_t k = 0; k + 1 < points.size(); k++) {
+			line(points[k], points[k + 1], color);
+		}
+	}
+
+	void FileWriter::circle(point_t center, double radius, int color) {
+		arc(center, radius, 0.0, 360.0, color);
+	}
+
+	void FileWriter::polyline(const polygon_t& points, int color) {
+		for (size_t k = 0; k + 1 < points.size(); k++) {
+			line(points[k], points[k + 1], color);
+		}
+	}
+
+	SegmentWriter::SegmentWriter(shared_ptr<FileWriter> target, double tolerance) : target(target) {
+		curveTolerance = tolerance;
+	}
+
+	void SegmentWriter::line(point_t p1, point_t p2, color_t color) {
+		target->line(p1, p2, color);
+	}
+
+	void SegmentWriter::polyline(const polygon_t& points, color_t color) {
+		target->polyline(points, color);
+	}
+
+	// the angle in degrees by which the transformer turns
+	static double rotationOf(const transformer_t& transformer) {
+		return glm::degrees(atan2(transformer[0][1], transformer[0][0]));
+	}
+
+	static void joinPoint(BoundingBox& bb, point_t p) {
+		bb.minX = min(bb.minX, p.x);
+		bb.maxX = max(bb.maxX, p.x);
+		bb.minY = min(bb.minY, p.y);
+		bb.maxY = max(bb.maxY, p.y);
+	}
+
 	void NesterLine::setStartPoint(point_t p) {
 		start = p;
 	}
@@ -53,49 +120,429 @@ namespace nester {
 		return bb;
 	}
 
-	void NesterNurbs::addControlPoint(double x, double y) {
+	point_t NesterLine::getStartPoint() const {
+		return start;
+	}
+
+	point_t NesterLine::getEndPoint() const {
+		return end;
+	}
+
+	void NesterLine::appendPoints(polygon_t& points) const {
+		points.push_back(start);
+	}
+
+	NesterArc::NesterArc() : radius(0.0), startAngle(0.0), sweep(0.0), tolerance(CURVE_TOLERANCE) {}
+
+	void NesterArc::setCenter(point_t p) {
+		center = p;
+	}
+
+	void NesterArc::setRadius(double r) {
+		radius = r;
+	}
+
+	void NesterArc::setAngles(double start, double s) {
+		startAngle = start;
+		sweep = s;
+	}
+
+	void NesterArc::setTolerance(double t) {
+		tolerance = t;
+	}
+
+	point_t NesterArc::getCenter() const {
+		return center;
+	}
+
+	double NesterArc::getRadius() const {
+		return radius;
+	}
+
+	double NesterArc::getStartAngle() const {
+		return startAngle;
+	}
+
+	double NesterArc::getSweep() const {
+		return sweep;
+	}
+
+	point_t NesterArc::getStartPoint() const {
+		double a = glm::radians(startAngle);
+		return center + radius * point_t(cos(a), sin(a));
+	}
+
+	point_t NesterArc::getEndPoint() const {
+		double a = glm::radians(startAngle + sweep);
+		return center + radius * point_t(cos(a), sin(a));
+	}
+
+	shared_ptr<NesterArc> NesterArc::reversed() const {
+		shared_ptr<NesterArc> arc = make_shared<NesterArc>(*this);
+		arc->setAngles(startAngle + sweep, -sweep);
+		return arc;
+	}
+
+	void NesterArc::write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const {
+		// writers take arcs counter clockwise
+		double from = (sweep < 0.0 ? startAngle + sweep : startAngle) + rotationOf(transformer);
+		writer->arc(transformPoint(transformer, center), radius, from, from + fabs(sweep), color);
+	}
+
+	BoundingBox NesterArc::getBoundingBox() const {
+		BoundingBox bb;
+		point_t ends[2] = { getStartPoint(), getEndPoint() };
+		for (point_t p : ends) {
+			bb.minX = min(bb.minX, p.x);
+			bb.maxX = max(bb.maxX, p.x);
+			bb.minY = min(bb.minY, p.y);
+			bb.maxY = max(bb.maxY, p.y);
+		}
+		// where the arc passes the right, top, left and bottom of its circle
+		double from = sweep < 0.0 ? startAngle + sweep : startAngle;
+		for (int quarter = 0; quarter < 4; quarter++) {
+			double past = fmod(quarter * 90.0 - from, 360.0);
+			if (past < 0.0) {
+				past += 360.0;
+			}
+			if (past <= fabs(sweep)) {
+				switch (quarter) {
+				case 0: bb.maxX = center.x + radius; break;
+				case 1: bb.maxY = center.y + radius; break;
+				case 2: bb.minX = center.x - radius; break;
+				case 3: bb.minY = center.y - radius; break;
+				}
+			}
+		}
+		return bb;
+	}
+
+	void NesterArc::appendPoints(polygon_t& points) const {
+		polygon_t arc = arcPoints(center, radius, startAngle, sweep, tolerance);
+		points.insert(points.end(), arc.begin(), arc.end() - 1);
+	}
+
+	NesterNurbs::NesterNurbs() : tolerance(CURVE_TOLERANCE) {}
+
+	void NesterNurbs::addControlPoint(double x, double y, double weight) {
 		controlPoints.push_back(point_t(x, y));
+		weights.push_back(weight);
 	}
 
 	void NesterNurbs::addKnots(vector<double> ks) {
 		knots.insert(knots.end(), ks.begin(), ks.end()); 
 	};
 
+	void NesterNurbs::setTolerance(double t) {
+		tolerance = t;
+	}
+
+	const polygon_t& NesterNurbs::getPoints() const {
+		// parts may be tessellated from several threads at once
+		call_once(tessellated, [this]() {
+			NurbsCurve curve = { controlPoints, weights, knots };
+			if (curve.isValid()) {
+				points = tessellateNurbs(curve, tolerance);
+			}
+			else {
+				// better the control polygon than losing the edge
+				points = controlPoints;
+			}
+		});
+		return points;
+	}
+
+	polygon_t NesterNurbs::toPolyline() const {
+		return getPoints();
+	}
+
+	point_t NesterNurbs::endPoint(bool start) const {
+		NurbsCurve curve = { controlPoints, weights, knots };
+		if (!curve.isValid()) {
+			// where the control polygon the tessellation falls back to ends
+			return controlPoints.empty() ? point_t(0, 0) : (start ? controlPoints.front() : controlPoints.back());
+		}
+		polygon_t end;
+		evaluateNurbs(curve, { start ? curve.startParameter() : curve.endParameter() }, end);
+		return end[0];
+	}
+
+	point_t NesterNurbs::getStartPoint() const {
+		return endPoint(true);
+	}
+
+	point_t NesterNurbs::getEndPoint() const {
+		return endPoint(false);
+	}
+
+	shared_ptr<NesterNurbs> NesterNurbs::reversed() const {
+		// the knots are mirrored within their range
+		shared_ptr<NesterNurbs> spline = make_shared<NesterNurbs>();
+		for (size_t k = controlPoints.size(); k-- > 0;) {
+			spline->addControlPoint(controlPoints[k].x, controlPoints[k].y, weights[k]);
+		}
+		for (size_t k = knots.size(); k-- > 0;) {
+			spline->knots.push_back(knots.front() + knots.back() - knots[k]);
+		}
+		spline->tolerance = tolerance;
+		return spline;
+	}
+
 	void NesterNurbs::write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const {
-		// Not implemented
+		const polygon_t& polyline = getPoints();
+		for (size_t k = 0; k + 1 < polyline.size(); k++) {
+			writer->line(transformPoint(transformer, polyline[k]), transformPoint(transformer, polyline[k + 1]), color);
+		}
 	}
 
 	BoundingBox NesterNurbs::getBoundingBox() const {
+		// the curve stays inside the convex hull of its control points, and so inside their box
+		return nester::getBoundingBox(controlPoints);
+	}
+
+	void NesterNurbs::appendPoints(polygon_t& polygon) const {
+		const polygon_t& polyline = getPoints();
+		if (!polyline.empty()) {
+			polygon.insert(polygon.end(), polyline.begin(), polyline.end() - 1);
+		}
+	}
+
+	NesterCircle::NesterCircle() : radius(0.0), tolerance(CURVE_TOLERANCE) {}
+
+	void NesterCircle::setCenter(point_t p) {
+		center = p;
+	}
+
+	void NesterCircle::setRadius(double r) {
+		radius = r;
+	}
+
+	void NesterCircle::setTolerance(double t) {
+		tolerance = t;
+	}
+
+	void NesterCircle::write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const {
+		writer->circle(transformPoint(transformer, center), radius, color);
+	}
+
+	BoundingBox NesterCircle::getBoundingBox() const {
 		BoundingBox bb;
-		// Not implemented
+		bb.minX = center.x - radius;
+		bb.minY = center.y - radius;
+		bb.maxX = center.x + radius;
+		bb.maxY = center.y + radius;
 		return bb;
 	}
 
-	void NesterLoop::addEdge(NesterEdge_p edge) {
-		edges.push_back(edge);
+	polygon_p NesterCircle::toPolygon() const {
+		polygon_p polygon = make_shared<polygon_t>(arcPoints(center, radius, 0.0, 360.0, tolerance));
+		polygon->pop_back();
+		return polygon;
+	}
+
+	void NesterCircle::simplify(double t) {
+		tolerance += t;
+	}
+
+	NesterLoop::NesterLoop(Arena_p arena) :
+		x(ArenaAllocator<double>(arena)), y(ArenaAllocator<double>(arena)), arcs(ArenaAllocator<NesterArc>(arena)),
+		splines(ArenaAllocator<shared_ptr<NesterNurbs> >(arena)), pieces(ArenaAllocator<Piece>(arena)) {}
+
+	bool NesterLoop::addEdge(NesterEdge_p edge) {
+		if (shared_ptr<NesterLine> line = dynamic_pointer_cast<NesterLine>(edge)) {
+			addLine(line->getStartPoint(), line->getEndPoint());
+		}
+		else if (shared_ptr<NesterArc> arc = dynamic_pointer_cast<NesterArc>(edge)) {
+			addArc(*arc);
+		}
+		else if (shared_ptr<NesterNurbs> spline = dynamic_pointer_cast<NesterNurbs>(edge)) {
+			addNurbs(spline);
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+	void NesterLoop::addLine(point_t from, point_t to) {
+		// the last run is at the end of the corners, and goes on if the line starts where it ends
+		bool goesOn = !pieces.empty() && pieces.back().kind == PIECE_LINES && x.back() == from.x && y.back() == from.y;
+		if (!goesOn) {
+			Piece piece = { PIECE_LINES, x.size(), 1 };
+			pieces.push_back(piece);
+			x.push_back(from.x);
+			y.push_back(from.y);
+			joinPoint(bounds, from);
+		}
+		x.push_back(to.x);
+		y.push_back(to.y);
+		pieces.back().count++;
+		joinPoint(bounds, to);
+	}
+
+	void NesterLoop::addLines(const polygon_t& points) {
+		for (size_t k = 0; k + 1 < points.size(); k++) {
+			addLine(points[k], points[k + 1]);
+		}
+	}
+
+	void NesterLoop::addArc(const NesterArc& arc) {
+		Piece piece = { PIECE_ARC, arcs.size(), 1 };
+		pieces.push_back(piece);
+		arcs.push_back(arc);
+		bounds.join(arc.getBoundingBox());
+	}
+
+	void NesterLoop::addNurbs(shared_ptr<NesterNurbs> spline) {
+		Piece piece = { PIECE_NURBS, splines.size(), 1 };
+		pieces.push_back(piece);
+		splines.push_back(spline);
+		bounds.join(spline->getBoundingBox());
+	}
+
+	void NesterLoop::measure() {
+		bounds = BoundingBox();
+		if (!x.empty()) {
+			// all corners in one go, the runs don't matter for the box
+			const double* px = x.data();
+			const double* py = y.data();
+			double minX = px[0], maxX = px[0], minY = py[0], maxY = py[0];
+			for (size_t k = 1; k < x.size(); k++) {
+				minX = min(minX, px[k]);
+				maxX = max(maxX, px[k]);
+				minY = min(minY, py[k]);
+				maxY = max(maxY, py[k]);
+			}
+			bounds.minX = minX;
+			bounds.maxX = maxX;
+			bounds.minY = minY;
+			bounds.maxY = maxY;
+		}
+		for (const NesterArc& arc : arcs) {
+			bounds.join(arc.getBoundingBox());
+		}
+		for (const shared_ptr<NesterNurbs>& spline : splines) {
+			bounds.join(spline->getBoundingBox());
+		}
 	}
 
 	void NesterLoop::write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const {
-		for (NesterEdge_p edge : edges) {
-			edge->write(writer, color, transformer);
+		// in the order the edges were added, so the cutter follows the outline around
+		polygon_t run;
+		for (const Piece& piece : pieces) {
+			switch (piece.kind) {
+			case PIECE_LINES: {
+				const double* px = x.data() + piece.first;
+				const double* py = y.data() + piece.first;
+				run.resize(piece.count);
+				for (size_t k = 0; k < piece.count; k++) {
+					run[k] = point_t(transformer[0][0] * px[k] + transformer[1][0] * py[k] + transformer[2][0],
+						transformer[0][1] * px[k] + transformer[1][1] * py[k] + transformer[2][1]);
+				}
+				writer->polyline(run, color);
+				break;
+			}
+			case PIECE_ARC:
+				arcs[piece.first].write(writer, color, transformer);
+				break;
+			case PIECE_NURBS:
+				splines[piece.first]->write(writer, color, transformer);
+				break;
+			}
 		}
 	}
 
 	BoundingBox NesterLoop::getBoundingBox() const {
-		BoundingBox bb;
-		for (NesterEdge_p edge : edges) {
-			bb.join(edge->getBoundingBox());
+		return bounds;
+	}
+
+	polygon_p NesterLoop::toPolygon() const {
+		polygon_p polygon = make_shared<polygon_t>();
+		polygon->reserve(x.size());
+		for (const Piece& piece : pieces) {
+			switch (piece.kind) {
+			case PIECE_LINES:
+				for (size_t k = piece.first; k + 1 < piece.first + piece.count; k++) {
+					polygon->push_back(point_t(x[k], y[k]));
+				}
+				break;
+			case PIECE_ARC:
+				arcs[piece.first].appendPoints(*polygon);
+				break;
+			case PIECE_NURBS:
+				splines[piece.first]->appendPoints(*polygon);
+				break;
+			}
 		}
+		return polygon;
+	}
 
-		return bb;
+	void NesterLoop::simplify(double tolerance) {
+		// the pieces again, with the corners of each run as a polyline
+		vector<pair<Piece, polygon_t> > items;
+		for (const Piece& piece : pieces) {
+			polygon_t points;
+			if (piece.kind == PIECE_LINES) {
+				for (size_t k = piece.first; k < piece.first + piece.count; k++) {
+					points.push_back(point_t(x[k], y[k]));
+				}
+			}
+			items.push_back(make_pair(piece, points));
+		}
+		auto isRun = [](const pair<Piece, polygon_t>& item) {
+			return item.first.kind == PIECE_LINES;
+		};
+
+		if (items.size() == 1 && isRun(items[0]) && items[0].second.size() > 3 && items[0].second.front() == items[0].second.back()) {
+			// one closed run of lines
+			polygon_t& ring = items[0].second;
+			ring.pop_back();
+			ring = simplifyRing(ring, tolerance);
+			ring.push_back(ring.front());
+		}
+		else {
+			// a run which goes on across the start of the loop is simplified as one
+			if (items.size() > 1 && isRun(items.front()) && isRun(items.back()) && items.back().second.back() == items.front().second.front()) {
+				items.back().second.insert(items.back().second.end(), items.front().second.begin() + 1, items.front().second.end());
+				items.erase(items.begin());
+			}
+			for (auto& item : items) {
+				if (isRun(item)) {
+					item.second = simplifyPolyline(item.second, tolerance);
+				}
+			}
+		}
+
+		// the curves stay where they are in their arrays
+		x.clear();
+		y.clear();
+		pieces.clear();
+		for (const auto& item : items) {
+			if (isRun(item)) {
+				addLines(item.second);
+			}
+			else {
+				pieces.push_back(item.first);
+			}
+		}
+		measure();
 	}
 
 	void NesterPart::setOuterRing(NesterRing_p ring) {
 		outer_ring = ring;
+		bounds = ring->getBoundingBox();
+		for (NesterRing_p r : inner_rings) {
+			bounds.join(r->getBoundingBox());
+		}
+		lock_guard<mutex> lock(treeLock);
+		tree.reset();
 	}
 
 	void NesterPart::addInnerRing(NesterRing_p ring) {
 		inner_rings.push_back(ring);
+		bounds.join(ring->getBoundingBox());
+		lock_guard<mutex> lock(treeLock);
+		tree.reset();
 	}
 
 	void NesterPart::write(shared_ptr<FileWriter> writer, transformer_t& transformer) const {
@@ -106,16 +553,75 @@ namespace nester {
 	}
 
 	BoundingBox NesterPart::getBoundingBox() const {
-		BoundingBox bb;
-		bb.join(outer_ring->getBoundingBox());
+		return bounds;
+	}
+
+	polygon_p NesterPart::toPolygon() const {
+		if (!outer_ring) {
+			return polygon_p();
+		}
+		return outer_ring->toPolygon();
+	}
+
+	vector<polygon_p> NesterPart::toHolePolygons() const {
+		vector<polygon_p> holes;
 		for (NesterRing_p r : inner_rings) {
-			bb.join(r->getBoundingBox());
+			holes.push_back(r->toPolygon());
 		}
+		return holes;
+	}
 
-		return bb;
+	PartOffset_p NesterPart::getOffset(double distance, OffsetJoin join, double tolerance) const {
+		if (offset && offset->distance == distance && offset->join == join && offset->tolerance == tolerance) {
+			return offset;
+		}
+		PartOffset_p result = make_shared<PartOffset>();
+		result->distance = distance;
+		result->join = join;
+		result->tolerance = tolerance;
+		// every point of a ring is within tolerance of its simplified version
+		auto simplified = [tolerance](const polygon_t& ring) {
+			return tolerance > 0.0 ? simplifyRing(ring, tolerance) : ring;
+		};
+		polygon_p outline = toPolygon();
+		if (outline) {
+			// growing a connected outline keeps it connected, so there is one counter clockwise ring
+			for (const polygon_t& ring : offsetRing(simplified(*outline), distance + tolerance, join)) {
+				if (signedArea(ring) > signedArea(result->outer)) {
+					result->outer = ring;
+				}
+			}
+		}
+		for (polygon_p hole : toHolePolygons()) {
+			if (!hole) {
+				continue;
+			}
+			for (const polygon_t& ring : offsetRing(simplified(*hole), -distance - tolerance, join)) {
+				if (signedArea(ring) > 0.0) {
+					result->holes.push_back(ring);
+				}
+			}
+		}
+		offset = result;
+		return result;
+	}
+
+	EdgeTree_p NesterPart::getEdgeTree() const {
+		lock_guard<mutex> lock(treeLock);
+		if (!tree) {
+			vector<polygon_t> rings;
+			if (outer_ring) {
+				rings.push_back(*outer_ring->toPolygon());
+			}
+			for (NesterRing_p r : inner_rings) {
+				rings.push_back(*r->toPolygon());
+			}
+			tree = make_shared<EdgeTree>(rings);
+		}
+		return tree;
 	}
 
-	Nester::Nester() {
+	Nester::Nester() : sheetWidth(0.0), spacing(0.5), kerf(0.0), join(JOIN_ROUND), nestingTolerance(0.0), rotations(4), threads(0), strategy(STRATEGY_BOTTOM_LEFT), searchSeconds(0.0), searchSeed(0), rasterResolution(0.0), shelfHeuristic(SHELF_FIRST_FIT), rectangleTolerance(0.01), fillHoles(true) {
 		log = make_shared<NullStream>();
 	}
 
@@ -123,46 +629,577 @@ namespace nester {
 		parts.push_back(part);
 	}
 
-	
-	void Nester::run() {
-		// convert to polygon rings
+	void Nester::setLog(shared_ptr<ostream> log) {
+		this->log = log;
+	}
 
+	void Nester::setSheetWidth(double width) {
+		sheetWidth = width;
 	}
 
-	void Nester::write(shared_ptr<FileWriter> writer) const {
+	void Nester::setSpacing(double spacing) {
+		this->spacing = spacing;
+	}
+
+	void Nester::setKerf(double kerf) {
+		this->kerf = kerf;
+	}
+
+	void Nester::setJoin(OffsetJoin join) {
+		this->join = join;
+	}
+
+	void Nester::setNestingTolerance(double tolerance) {
+		this->nestingTolerance = max(0.0, tolerance);
+	}
+
+	void Nester::setRotations(int rotations) {
+		this->rotations = max(1, rotations);
+	}
+
+	void Nester::setThreads(size_t threads) {
+		this->threads = threads;
+	}
 
-		long double offset = 0.0;
-		const long double spacing = 0.5;
+	void Nester::setStrategy(NestingStrategy strategy) {
+		this->strategy = strategy;
+	}
 
-		//writer.line(point_t(-100.0, 0.0), point_t(100.0, 0.0), DXF_DEBUG_COLOR);
-		//writer.line(point_t(0.0, -100.0), point_t(0.0, 100.0), DXF_DEBUG_COLOR);
+	void Nester::setSearch(double seconds, unsigned seed) {
+		searchSeconds = seconds;
+		searchSeed = seed;
+	}
 
+	void Nester::setRasterResolution(double resolution) {
+		rasterResolution = max(0.0, resolution);
+	}
+
+	void Nester::setShelfHeuristic(ShelfHeuristic heuristic) {
+		shelfHeuristic = heuristic;
+	}
+
+	void Nester::setRectangleTolerance(double tolerance) {
+		rectangleTolerance = tolerance;
+	}
+
+	void Nester::setFillHoles(bool fill) {
+		fillHoles = fill;
+	}
+
+	void Nester::addStockSheet(double width, double height, int quantity) {
+		if (width > 0.0 && height > 0.0 && quantity != 0) {
+			StockSheet sheet;
+			sheet.width = width;
+			sheet.height = height;
+			sheet.quantity = quantity;
+			stock.push_back(sheet);
+		}
+	}
+
+	void Nester::addStockProfile(NesterPart_p profile, int quantity) {
+		polygon_p outline = profile ? profile->toPolygon() : polygon_p();
+		if (!outline || outline->size() < 3 || quantity == 0) {
+			return;
+		}
+
+		// a copy of the profile built from lines, moved to the origin
+		BoundingBox bb = getBoundingBox(*outline);
+		point_t offset((double)bb.minX, (double)bb.minY);
+		auto moved = [&](const polygon_t& ring) {
+			shared_ptr<NesterLoop> loop = make_shared<NesterLoop>();
+			for (size_t k = 0; k < ring.size(); k++) {
+				shared_ptr<NesterLine> line = make_shared<NesterLine>();
+				line->setStartPoint(ring[k] - offset);
+				line->setEndPoint(ring[(k + 1) % ring.size()] - offset);
+				loop->addEdge(line);
+			}
+			return loop;
+		};
+
+		StockSheet sheet;
+		sheet.width = (double)bb.width();
+		sheet.height = (double)bb.height();
+		sheet.quantity = quantity;
+		sheet.profile = make_shared<NesterPart>();
+		sheet.profile->setOuterRing(moved(*outline));
+		for (polygon_p hole : profile->toHolePolygons()) {
+			if (hole && hole->size() >= 3) {
+				sheet.profile->addInnerRing(moved(*hole));
+			}
+		}
+		if (sheet.width > 0.0 && sheet.height > 0.0) {
+			stock.push_back(sheet);
+		}
+	}
+
+	const vector<Placement>& Nester::getPlacements() const {
+		return placements;
+	}
+
+	const vector<size_t>& Nester::getSheets() const {
+		return sheets;
+	}
+
+	vector<NesterPart_p> Nester::getUnplaced() const {
+		vector<NesterPart*> placed;
+		for (const Placement& placement : placements) {
+			placed.push_back(placement.part.get());
+		}
+		sort(placed.begin(), placed.end());
+		vector<NesterPart_p> unplaced;
+		for (const NesterPart_p& part : parts) {
+			if (!binary_search(placed.begin(), placed.end(), part.get())) {
+				unplaced.push_back(part);
+			}
+		}
+		return unplaced;
+	}
+
+	double Nester::gap() const {
+		return kerf + spacing;
+	}
+
+	double Nester::autoSheetWidth(const vector<BoundingBox>& boxes) const {
+		// aim for a roughly square layout which still fits every part
+		double area = 0.0;
+		double narrowest = 0.0;
+		for (const BoundingBox& bb : boxes) {
+			double w = (double)bb.width();
+			double h = (double)bb.height();
+			area += (w + gap()) * (h + gap());
+			narrowest = max(narrowest, min(w, h));
+		}
+		return max(narrowest, sqrt(area));
+	}
+
+	vector<Placement> Nester::shelfPlacements() const {
+		// each part is packed by its smallest box, turned upright
+		vector<BoundingBox> boxes;
+		vector<transformer_t> uprights;
 		for (NesterPart_p p : parts) {
-			BoundingBox bb = p->getBoundingBox();
-			long double angle = 0.0;
-			long double width = bb.width();
-			long double xCorrection = -bb.minX;
-			long double yCorrection = -bb.minY;
+			polygon_p outline = p->toPolygon();
+			double angle = outline ? minimumAreaAngle(*outline) : 0.0;
+			uprights.push_back(makeTransformation(angle, 0.0, 0.0));
+			boxes.push_back(angle == 0.0 ? p->getBoundingBox() : getBoundingBox(transformPolygon(*outline, uprights.back())));
+		}
+		double width = sheetWidth > 0.0 ? sheetWidth : autoSheetWidth(boxes);
+		ShelfPacker packer(width, gap(), shelfHeuristic);
+		ShelfLayout layout = packer.pack(boxes);
+
+		vector<Placement> result;
+		for (size_t i = 0; i < parts.size(); i++) {
+			// turn first, then move the turned box to its spot, whichever way the rotation goes
+			transformer_t rotation = makeTransformation(layout.placements[i].rotated ? 90.0 : 0.0, 0.0, 0.0);
+			const BoundingBox& bb = boxes[i];
+			BoundingBox turned = getBoundingBox({
+				transformPoint(rotation, point_t((double)bb.minX, (double)bb.minY)),
+				transformPoint(rotation, point_t((double)bb.maxX, (double)bb.maxY)) });
+			point_t position = layout.placements[i].position;
+
+			Placement placement;
+			placement.part = parts[i];
+			placement.transformer = makeTransformation(0.0, position.x - (double)turned.minX, position.y - (double)turned.minY) * rotation * uprights[i];
+			result.push_back(placement);
+		}
+
+		*log << "shelf packing of " << parts.size() << " parts on a " << width << " wide sheet, length=" << layout.length << endl;
+		return result;
+	}
+
+	void Nester::logNfpTimings(const vector<NfpTiming>& timings, size_t workers, chrono::steady_clock::duration wall) const {
+		double total = 0.0;
+		for (const NfpTiming& t : timings) {
+			total += t.milliseconds;
+		}
+		*log << "precomputed " << timings.size() << " no-fit polygons on " << workers << " threads in "
+			<< chrono::duration<double, milli>(wall).count() << "ms (" << total << "ms of work)" << endl;
+
+		vector<NfpTiming> slowest(timings);
+		size_t shown = min((size_t)5, slowest.size());
+		partial_sort(slowest.begin(), slowest.begin() + shown, slowest.end(), [](const NfpTiming& a, const NfpTiming& b) {
+			return a.milliseconds > b.milliseconds;
+		});
+		for (size_t i = 0; i < shown; i++) {
+			const NfpTiming& t = slowest[i];
+			*log << "  nfp fixed=" << t.fixedShape << " moving=" << t.movingShape << " rotation=" << t.rotation
+				<< " pieces=" << t.pieces << " " << t.milliseconds << "ms" << endl;
+		}
+	}
+
+	NestingResult Nester::packRectangles(const vector<PartShape>& shapes, const vector<bool>& irregular, vector<size_t>& order, double width) const {
+		vector<size_t> boxes, others;
+		for (size_t i : order) {
+			(irregular[i] ? others : boxes).push_back(i);
+		}
+		order.swap(others);
+		if (boxes.empty()) {
+			return NestingResult();
+		}
+		RectanglePacker packer(shapes, width, gap());
+		return packer.pack(boxes);
+	}
 
-			if (bb.width() > bb.height()) {
-				angle = -90.0;
-				width = bb.height();
-				xCorrection = bb.maxY;
-				yCorrection = -bb.minX;
+	NestingResult Nester::nestSheet(const vector<PartShape>& shapes, NfpCache& nfps, InnerFitCache* profile, const vector<bool>& irregular,
+		vector<size_t> order, double width, double seconds, ostream& log) const {
+		if (profile) {
+			// only the bottom-left placer knows how to stay inside a profile
+			BottomLeftPlacer placer(shapes, nfps, width, gap());
+			placer.setStock(profile);
+			return placer.place(order, vector<int>(order.size(), ANY_ORIENTATION));
+		}
+		if (strategy == STRATEGY_RASTER) {
+			RasterPlacer placer(shapes, width, gap(), rasterResolution > 0.0 ? rasterResolution : width / RASTER_AUTO_COLUMNS);
+			return placer.place(order);
+		}
+
+		NestingResult result = packRectangles(shapes, irregular, order, width);
+		if (!order.empty()) {
+			BottomLeftPlacer placer(shapes, nfps, width, gap());
+			result = placer.place(order, vector<int>(order.size(), ANY_ORIENTATION), result);
+		}
+		if (strategy == STRATEGY_ANNEALING && seconds > 0.0) {
+			OverlapAnnealer annealer(shapes, nfps, width, gap(), searchSeed);
+			result = annealer.improve(result, seconds, log);
+		}
+		return result;
+	}
+
+	void Nester::nestSheets(const vector<PartShape>& shapes, const vector<size_t>& order, vector<size_t>& placedShapes) {
+		// the shelf strategy packs every part by its bounding box, the raster strategy none
+		vector<bool> irregular(shapes.size(), strategy != STRATEGY_SHELF);
+		if (strategy == STRATEGY_BOTTOM_LEFT || strategy == STRATEGY_ANNEALING) {
+			for (size_t i = 0; i < shapes.size() && rectangleTolerance >= 0.0; i++) {
+				irregular[i] = !isNearlyRectangular(shapes[i], rectangleTolerance);
+			}
+		}
+
+		ThreadPool pool(threads);
+		NfpCache nfps(shapes);
+		if (strategy == STRATEGY_BOTTOM_LEFT || strategy == STRATEGY_ANNEALING) {
+			auto precomputeStarted = chrono::steady_clock::now();
+			nfps.precompute(pool, strategy == STRATEGY_ANNEALING ? vector<bool>() : irregular);
+			logNfpTimings(nfps.getTimings(), pool.size(), chrono::steady_clock::now() - precomputeStarted);
+		}
+
+		vector<int> remaining;
+		vector<shared_ptr<InnerFitCache> > profiles;
+		for (const StockSheet& s : stock) {
+			remaining.push_back(s.quantity);
+			// the inner-fit polygons of a profile are shared by all of its sheets and every round
+			shared_ptr<InnerFitCache> profile;
+			if (s.profile) {
+				// the parts are grown by half the gap but may touch the stock boundary, so the stock grows too
+				PartOffset_p grown = s.profile->getOffset(gap() / 2.0, join);
+				profile = make_shared<InnerFitCache>(shapes, grown->outer, grown->holes);
+			}
+			profiles.push_back(profile);
+		}
+
+		// parts which end up beyond the end of their sheet are handed to new sheets in the next round
+		vector<size_t> pending(order), unplaced;
+		while (!pending.empty()) {
+			vector<SheetAssignment> assigned = assignSheets(shapes, pending, stock, remaining, gap(), unplaced);
+			pending.clear();
+			if (assigned.empty()) {
+				break;
+			}
+
+			// the sheets are independent once their parts are known, so they are nested side by side. The
+			// genetic search runs its generations on the pool itself instead, one sheet after the other.
+			bool search = strategy == STRATEGY_BOTTOM_LEFT && searchSeconds > 0.0;
+			double seconds = searchSeconds * min(pool.size(), assigned.size()) / assigned.size();
+			vector<NestingResult> results(assigned.size());
+			vector<string> logs(assigned.size());
+			for (size_t k = 0; k < assigned.size() && !search; k++) {
+				pool.submit([&, k]() {
+					ostringstream sheetLog;
+					results[k] = nestSheet(shapes, nfps, profiles[assigned[k].stock].get(), irregular, assigned[k].shapes,
+						stock[assigned[k].stock].width, seconds, sheetLog);
+					logs[k] = sheetLog.str();
+				});
+			}
+			pool.wait();
+
+			for (size_t k = 0; k < assigned.size(); k++) {
+				const StockSheet& size = stock[assigned[k].stock];
+				*log << logs[k];
+				if (search) {
+					vector<size_t> others(assigned[k].shapes);
+					if (!profiles[assigned[k].stock]) {
+						results[k] = packRectangles(shapes, irregular, others, size.width);
+					}
+					if (!others.empty()) {
+						GeneticOrdering ordering(shapes, nfps, pool, size.width, gap(), searchSeed);
+						ordering.setStart(results[k]);
+						ordering.setStock(profiles[assigned[k].stock].get());
+						results[k] = ordering.optimize(others, searchSeconds / assigned.size(), *log);
+					}
+				}
+
+				vector<ShapePlacement> inside;
+				size_t overflowing = pending.size();
+				for (const ShapePlacement& p : results[k].placements) {
+					const BoundingBox& bb = shapes[p.shape].orientations[p.orientation].bounds;
+					if (p.position.x + (double)bb.minX >= -1e-6 && p.position.x + (double)bb.maxX <= size.width + 1e-6 &&
+						p.position.y + (double)bb.minY >= -1e-6 && p.position.y + (double)bb.maxY <= size.height + 1e-6) {
+						inside.push_back(p);
+					}
+					else {
+						pending.push_back(p.shape);
+					}
+				}
+				if (inside.empty()) {
+					// not even the first part fits an empty sheet, trying again would not change that
+					unplaced.insert(unplaced.end(), assigned[k].shapes.begin(), assigned[k].shapes.end());
+					pending.resize(overflowing);
+					if (remaining[assigned[k].stock] >= 0) {
+						remaining[assigned[k].stock]++;
+					}
+					continue;
+				}
+
+				for (const ShapePlacement& p : inside) {
+					const PartShape& shape = shapes[p.shape];
+					Placement placement;
+					placement.part = parts[shape.part];
+					placement.transformer = placementTransformer(shape, p.orientation, p.position);
+					placement.sheet = sheets.size();
+					placements.push_back(placement);
+					placedShapes.push_back(p.shape);
+				}
+				*log << "sheet " << sheets.size() + 1 << " (" << size.width << " x " << size.height << "): " << inside.size()
+					<< " of " << assigned[k].shapes.size() << " parts fit" << endl;
+				sheets.push_back(assigned[k].stock);
+			}
+
+			// largest first again
+			stable_sort(pending.begin(), pending.end(), [&](size_t a, size_t b) {
+				return shapes[a].area > shapes[b].area;
+			});
+		}
+
+		unplaced.insert(unplaced.end(), pending.begin(), pending.end());
+		if (!unplaced.empty()) {
+			*log << unplaced.size() << " parts do not fit on the stock sheets which are left" << endl;
+		}
+	}
+
+	void Nester::addHoleParts(const vector<PartShape>& shapes, const vector<HolePlacement>& inHoles, vector<size_t>& placedShapes) {
+		const size_t NOT_PLACED = numeric_limits<size_t>::max();
+		vector<size_t> placementOf(shapes.size(), NOT_PLACED);
+		for (size_t i = 0; i < placedShapes.size(); i++) {
+			placementOf[placedShapes[i]] = i;
+		}
+
+		// a part in a hole comes after the part with the hole, so parts in holes of parts in holes follow along
+		for (const HolePlacement& h : inHoles) {
+			if (placementOf[h.parent] == NOT_PLACED) {
+				continue;
+			}
+			const Placement& parent = placements[placementOf[h.parent]];
+			Placement placement;
+			placement.part = parts[shapes[h.shape].part];
+			placement.transformer = holeTransformer(shapes[h.parent], parent.transformer, shapes[h.shape], h);
+			placement.sheet = parent.sheet;
+			placementOf[h.shape] = placements.size();
+			placements.push_back(placement);
+			placedShapes.push_back(h.shape);
+		}
+	}
+
+	void Nester::run() {
+		auto started = chrono::steady_clock::now();
+		placements.clear();
+		sheets.clear();
+
+		// makePartShapes() below takes the outlines one part after the other. Spline edges tessellate on
+		// first use and keep their points, so asking for the outlines here once, on all cores, takes that
+		// work out of the serial pass. The polygons are thrown away, only the cached splines matter.
+		{
+			ThreadPool pool(threads);
+			for (const NesterPart_p& part : parts) {
+				pool.submit([part]() {
+					part->toPolygon();
+					part->toHolePolygons();
+				});
+			}
+			for (const StockSheet& sheet : stock) {
+				if (sheet.profile) {
+					NesterPart_p profile = sheet.profile;
+					pool.submit([profile]() {
+						profile->toPolygon();
+						profile->toHolePolygons();
+					});
+				}
 			}
+			pool.wait();
+		}
+
+		if (strategy == STRATEGY_SHELF && stock.empty()) {
+			placements = shelfPlacements();
+			auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started);
+			*log << "nested " << placements.size() << " parts on shelves in " << elapsed.count() << "ms" << endl;
+			return;
+		}
+
+		vector<PartShape> shapes = makePartShapes(parts, rotations, gap() / 2.0, join, nestingTolerance);
+		if (shapes.size() < parts.size()) {
+			*log << (parts.size() - shapes.size()) << " parts without an outline, or too far from the origin to offset, are not nested" << endl;
+		}
+		if (shapes.empty()) {
+			return;
+		}
 
-			
-			transformer_t transformer = makeTransformation(	
-															angle,                // rotate around origin
-															xCorrection + offset, yCorrection);            // move so that new bottom left corner is at y=0 and x=offset
+		// largest parts first
+		vector<size_t> order(shapes.size());
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return shapes[a].area > shapes[b].area;
+		});
 
-			p->write(writer, transformer);
-			
+		vector<HolePlacement> inHoles;
+		if (fillHoles && strategy != STRATEGY_SHELF) {
+			HoleFiller filler(shapes);
+			inHoles = filler.fill(order);
+			vector<bool> inHole(shapes.size(), false);
+			for (const HolePlacement& h : inHoles) {
+				inHole[h.shape] = true;
+				// the raster placer takes holes for free space, so close those of a part which holds others
+				for (OrientedShape& oriented : shapes[h.parent].orientations) {
+					oriented.holes.clear();
+					oriented.shrunkHoles.clear();
+				}
+			}
+			order.erase(remove_if(order.begin(), order.end(), [&](size_t i) { return inHole[i]; }), order.end());
+			if (!inHoles.empty()) {
+				*log << "placed " << inHoles.size() << " parts in the holes of larger parts" << endl;
+			}
+		}
 
-			*log << "offset=" << offset << " bb[x=(" << bb.minX << "," << bb.maxX << ") y=(" << bb.minY << "," << bb.maxY << ") angle=" << angle << " width=" << width << " correction=(" << xCorrection << "," << yCorrection << ")" << endl;
-			offset += spacing + width;
+		vector<size_t> placedShapes;
+		if (!stock.empty()) {
+			nestSheets(shapes, order, placedShapes);
+			addHoleParts(shapes, inHoles, placedShapes);
+			auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started);
+			*log << "nested " << placements.size() << " parts on " << sheets.size() << " sheets in " << elapsed.count() << "ms" << endl;
+			return;
 		}
 
+		double width = sheetWidth;
+		if (width <= 0.0) {
+			vector<BoundingBox> boxes;
+			for (const PartShape& s : shapes) {
+				boxes.push_back(s.orientations[0].bounds);
+			}
+			width = autoSheetWidth(boxes);
+		}
+
+		NestingResult result;
+		if (strategy == STRATEGY_RASTER) {
+			double resolution = rasterResolution > 0.0 ? rasterResolution : width / RASTER_AUTO_COLUMNS;
+			RasterPlacer placer(shapes, width, gap(), resolution);
+			result = placer.place(order);
+			*log << "raster nesting with " << resolution << " cells" << endl;
+		}
+		else {
+			// rectangles are packed exactly and much faster on their own, the rest is fitted around them
+			NestingResult rectangles;
+			vector<bool> irregular(shapes.size(), true);
+			if (rectangleTolerance >= 0.0) {
+				vector<size_t> boxes;
+				for (size_t i : order) {
+					if (isNearlyRectangular(shapes[i], rectangleTolerance)) {
+						irregular[i] = false;
+						boxes.push_back(i);
+					}
+				}
+				if (!boxes.empty()) {
+					RectanglePacker packer(shapes, width, gap());
+					rectangles = packer.pack(boxes);
+					order.erase(remove_if(order.begin(), order.end(), [&](size_t i) { return !irregular[i]; }), order.end());
+					*log << "packed " << boxes.size() << " rectangular parts, length=" << rectangles.length << endl;
+				}
+			}
+
+			ThreadPool pool(threads);
+			NfpCache nfps(shapes);
+			auto precomputeStarted = chrono::steady_clock::now();
+			// the annealer moves the rectangles as well
+			nfps.precompute(pool, strategy == STRATEGY_ANNEALING ? vector<bool>() : irregular);
+			logNfpTimings(nfps.getTimings(), pool.size(), chrono::steady_clock::now() - precomputeStarted);
+
+			if (strategy == STRATEGY_BOTTOM_LEFT && searchSeconds > 0.0 && !order.empty()) {
+				GeneticOrdering search(shapes, nfps, pool, width, gap(), searchSeed);
+				search.setStart(rectangles);
+				result = search.optimize(order, searchSeconds, *log);
+			}
+			else {
+				BottomLeftPlacer placer(shapes, nfps, width, gap());
+				result = placer.place(order, vector<int>(order.size(), ANY_ORIENTATION), rectangles);
+			}
+
+			if (strategy == STRATEGY_ANNEALING && searchSeconds > 0.0) {
+				OverlapAnnealer annealer(shapes, nfps, width, gap(), searchSeed);
+				result = annealer.improve(result, searchSeconds, *log);
+			}
+		}
+
+		for (const ShapePlacement& p : result.placements) {
+			const PartShape& shape = shapes[p.shape];
+			Placement placement;
+			placement.part = parts[shape.part];
+			placement.transformer = placementTransformer(shape, p.orientation, p.position);
+			placements.push_back(placement);
+			placedShapes.push_back(p.shape);
+		}
+		addHoleParts(shapes, inHoles, placedShapes);
+
+		auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started);
+		*log << "nested " << placements.size() << " parts on a " << width << " wide sheet, length=" << result.length
+			<< " in " << elapsed.count() << "ms" << endl;
+	}
+
+	vector<LayoutViolation> Nester::verify() const {
+		auto started = chrono::steady_clock::now();
+		const vector<Placement>& checked = placements.empty() ? shelfPlacements() : placements;
+		vector<LayoutViolation> violations = verifyLayout(checked);
+		for (const LayoutViolation& v : violations) {
+			*log << "  part " << v.first << (v.kind == VIOLATION_CROSSING ? " crosses part " : " lies inside part ") << v.second
+				<< " at (" << v.where.x << ", " << v.where.y << "), overlapping by " << v.area << " cm2" << endl;
+		}
+		auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started);
+		*log << "verified " << checked.size() << " parts in " << elapsed.count() << "ms, " << violations.size() << " overlapping pairs" << endl;
+		return violations;
+	}
+
+	void Nester::write(shared_ptr<FileWriter> writer) const {
+		if (!sheets.empty()) {
+			// one sheet after the other along x, a tenth of a sheet apart
+			double offset = 0.0;
+			for (size_t k = 0; k < sheets.size(); k++) {
+				for (const Placement& p : placements) {
+					if (p.sheet == k) {
+						transformer_t transformer = makeTransformation(0.0, offset, 0.0) * p.transformer;
+						p.part->write(writer, transformer);
+					}
+				}
+				offset += 1.1 * stock[sheets[k]].width;
+			}
+			return;
+		}
+		for (const Placement& p : placements.empty() ? shelfPlacements() : placements) {
+			transformer_t transformer = p.transformer;
+			p.part->write(writer, transformer);
+		}
+	}
+
+	void Nester::writeSheet(shared_ptr<FileWriter> writer, size_t sheet) const {
+		for (const Placement& p : placements) {
+			if (p.sheet == sheet) {
+				transformer_t transformer = p.transformer;
+				p.part->write(writer, transformer);
+			}
+		}
 	}
 
 }
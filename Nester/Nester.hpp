@@ -1,7 +1,10 @@
 #ifndef _NESTER_H
 #define _NESTER_H
 
+#include <chrono>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -9,6 +12,7 @@
 #include <glm/gtx/matrix_transform_2d.hpp>
 
 #include "../XDxfGen/include/xdxfgen.h"
+#include "Arena.hpp"
 
 
 using namespace std;
@@ -25,28 +29,31 @@ namespace nester {
 
 	typedef shared_ptr<polygon_t> polygon_p;
 
+	// how far the tessellation of a curved edge may stray from the curve unless set otherwise (cm)
+	const double CURVE_TOLERANCE = 1e-3;
+
 	typedef glm::dmat3 transformer_t;
 	extern transformer_t makeTransformation(double angle, double x, double y);
 
 	struct BoundingBox {
-		long double minX, minY;
-		long double maxX, maxY;
+		double minX, minY;
+		double maxX, maxY;
 
 		BoundingBox() :
-			minX(std::numeric_limits<long double>::infinity()),
-			minY(std::numeric_limits<long double>::infinity()),
-			maxX(-std::numeric_limits<long double>::infinity()),
-			maxY(-std::numeric_limits<long double>::infinity()) {}
+			minX(std::numeric_limits<double>::infinity()),
+			minY(std::numeric_limits<double>::infinity()),
+			maxX(-std::numeric_limits<double>::infinity()),
+			maxY(-std::numeric_limits<double>::infinity()) {}
 
-		long double width() const {
+		double width() const {
 			return maxX - minX;
 		}
 
-		long double height() const {
+		double height() const {
 			return maxY - minY;
 		}
 
-		void join(BoundingBox other) {
+		void join(const BoundingBox& other) {
 			minX = min(minX, other.minX);
 			maxX = max(maxX, other.maxX);
 			minY = min(minY, other.minY);
@@ -55,38 +62,110 @@ namespace nester {
 	};
 
     class FileWriter {
+        protected:
+          // how far the lines which stand in for arcs and circles may stray from them
+          double curveTolerance;
         public:
+          FileWriter() : curveTolerance(CURVE_TOLERANCE) {}
           virtual void line(point_t p1, point_t p2, int color = 0) = 0;
+          // counter clockwise from startAngle to endAngle (degrees), written as lines unless overridden
+          virtual void arc(point_t center, double radius, double startAngle, double endAngle, int color = 0);
+          virtual void circle(point_t center, double radius, int color = 0);
+          // lines through the points one after the other
+          virtual void polyline(const polygon_t& points, int color = 0);
     };
+
+	// Hands the lines on to another writer and turns arcs and circles into lines on the way, for laser
+	// software which does not understand curves
+	class SegmentWriter : public FileWriter {
+		shared_ptr<FileWriter> target;
+	public:
+		// the lines stray from the curves by at most tolerance (cm)
+		SegmentWriter(shared_ptr<FileWriter> target, double tolerance);
+		virtual void line(point_t p1, point_t p2, color_t color = 0);
+		virtual void polyline(const polygon_t& points, color_t color = 0);
+	};
      
 
 	class NesterEdge {
 	public:
 		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const = 0;
 		virtual BoundingBox getBoundingBox() const = 0;
+		// appends the points along the edge, leaving out the end point which starts the next edge
+		virtual void appendPoints(polygon_t& points) const = 0;
 	};
 
 	typedef shared_ptr<NesterEdge> NesterEdge_p;
 
-	class NesterNurbs : public NesterEdge {
+	// A spline edge, kept as such and only tessellated when its points are first needed
+	class NesterNurbs final : public NesterEdge {
 		vector<point_t> controlPoints;
+		vector<double> weights;
 		vector<double> knots;
+		double tolerance;
+		mutable once_flag tessellated;
+		mutable polygon_t points;
+
+		const polygon_t& getPoints() const;
+		point_t endPoint(bool start) const;
 	public:
-		void addControlPoint(double x, double y);
+		NesterNurbs();
+		void addControlPoint(double x, double y, double weight = 1.0);
+		// the complete knot vector, with degree + 1 more knots than control points
 		void addKnots(vector<double> knobs);
+		// how far the tessellation may stray from the curve (cm)
+		void setTolerance(double tolerance);
+		// the tessellation, both ends included
+		polygon_t toPolyline() const;
+		// the ends of the curve, without tessellating it
+		point_t getStartPoint() const;
+		point_t getEndPoint() const;
+		// the same curve running the other way
+		shared_ptr<NesterNurbs> reversed() const;
 
 		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const;
 		virtual BoundingBox getBoundingBox() const;
+		virtual void appendPoints(polygon_t& points) const;
 	};
 
-	class NesterLine : public NesterEdge {
+	// A circular arc from startAngle, turning by sweep (degrees, clockwise when negative)
+	class NesterArc final : public NesterEdge {
+		point_t center;
+		double radius;
+		double startAngle, sweep;
+		double tolerance;
+	public:
+		NesterArc();
+		void setCenter(point_t p);
+		void setRadius(double r);
+		void setAngles(double start, double sweep);
+		// how far the tessellation may stray from the arc (cm)
+		void setTolerance(double tolerance);
+		point_t getCenter() const;
+		double getRadius() const;
+		double getStartAngle() const;
+		double getSweep() const;
+		point_t getStartPoint() const;
+		point_t getEndPoint() const;
+		// the same arc run the other way
+		shared_ptr<NesterArc> reversed() const;
+
+		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const;
+		virtual BoundingBox getBoundingBox() const;
+		virtual void appendPoints(polygon_t& points) const;
+	};
+
+	class NesterLine final : public NesterEdge {
 		point_t start, end;
 	public:
 		void setStartPoint(point_t p);
 		void setEndPoint(point_t p);
+		point_t getStartPoint() const;
+		point_t getEndPoint() const;
 
 		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const;
 		virtual BoundingBox getBoundingBox() const;
+		virtual void appendPoints(polygon_t& points) const;
 	};
 
 	// A ring is a closed line (either a loop of segments, a circle or an ellipse)
@@ -94,44 +173,262 @@ namespace nester {
 	public:
 		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const = 0;
 		virtual BoundingBox getBoundingBox() const = 0;
+		virtual polygon_p toPolygon() const = 0;
+		// drops points which lie within tolerance of the simplified ring
+		virtual void simplify(double tolerance) = 0;
 	};
 
 	typedef shared_ptr<NesterRing> NesterRing_p;
 
+	class NesterCircle : public NesterRing {
+		point_t center;
+		double radius;
+		double tolerance;
+	public:
+		NesterCircle();
+		void setCenter(point_t p);
+		void setRadius(double r);
+		// how far the tessellation may stray from the circle (cm)
+		void setTolerance(double tolerance);
+		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const;
+		virtual BoundingBox getBoundingBox() const;
+		// counter clockwise
+		virtual polygon_p toPolygon() const;
+		// the tessellation may stray that much further from the circle
+		virtual void simplify(double tolerance);
+	};
+
+	// A loop keeps its edges by kind, each kind in an array of its own: the corners of its straight runs
+	// in flat coordinate arrays, the arcs by value and the splines, which tessellate themselves lazily,
+	// by reference. A run of n corners is n - 1 lines and ends where the next piece starts. The kinds
+	// are closed, so the loop handles each of them in a loop of its own without virtual calls.
 	class NesterLoop : public NesterRing {
-		vector<NesterEdge_p> edges;
+		enum PieceKind {
+			PIECE_LINES,
+			PIECE_ARC,
+			PIECE_NURBS
+		};
+
+		struct Piece {
+			PieceKind kind;
+			size_t first, count;  // the corners of a run, or the index of a curve in its array
+		};
+
+		vector<double, ArenaAllocator<double> > x, y;
+		vector<NesterArc, ArenaAllocator<NesterArc> > arcs;
+		vector<shared_ptr<NesterNurbs>, ArenaAllocator<shared_ptr<NesterNurbs> > > splines;
+		vector<Piece, ArenaAllocator<Piece> > pieces;
+		BoundingBox bounds;  // kept up to date as edges are added
+
+		void measure();
 	public:
-		void addEdge(NesterEdge_p primitive);
+		// the edges in the arena when there is one
+		explicit NesterLoop(Arena_p arena = Arena_p());
+		// lines are taken apart into corners and arcs copied. False for an edge which is no line, arc or
+		// spline, which a loop cannot hold and is not added.
+		bool addEdge(NesterEdge_p primitive);
+		void addLine(point_t from, point_t to);
+		// lines through the points one after the other
+		void addLines(const polygon_t& points);
+		void addArc(const NesterArc& arc);
+		void addNurbs(shared_ptr<NesterNurbs> spline);
 		virtual void write(shared_ptr<FileWriter> writer, color_t color, transformer_t& transformer) const;
 		virtual BoundingBox getBoundingBox() const;
+		virtual polygon_p toPolygon() const;
+		// runs of connected lines become fewer lines, other edges stay as they are
+		virtual void simplify(double tolerance);
+	};
+
+	// How the corners which open up when a ring is offset are closed
+	enum OffsetJoin {
+		JOIN_MITER,  // edges extended until they meet, cut off square where that reaches too far
+		JOIN_ROUND   // arcs around the corner
 	};
 
-	// A part has an outer boundary and zero or more inner boundaries (holes)
+	// The rings of a part offset by a distance: the outer ring grown and the holes shrunk. With a tolerance
+	// the rings are simplified first and offset by that much more, so the result still holds the part.
+	struct PartOffset {
+		double distance;
+		OffsetJoin join;
+		double tolerance;
+		polygon_t outer;          // counter clockwise, anything the grown ring closes off is filled
+		vector<polygon_t> holes;  // counter clockwise, a hole can split up or vanish
+	};
+
+	typedef shared_ptr<PartOffset> PartOffset_p;
+
+	class EdgeTree;
+	typedef shared_ptr<const EdgeTree> EdgeTree_p;
+
+	// A part has an outer boundary and zero or more inner boundaries (holes). Its bounding box is
+	// taken from the rings as they are set, so a ring should be complete before it is handed over.
 	class NesterPart {
 		NesterRing_p outer_ring;
 		vector<NesterRing_p> inner_rings;
+		BoundingBox bounds;
+		mutable PartOffset_p offset;
+		mutable mutex treeLock;
+		mutable EdgeTree_p tree;
 	public:
 		void setOuterRing(NesterRing_p loop);
 		void addInnerRing(NesterRing_p loop);
 
 		polygon_p toPolygon() const;
+		vector<polygon_p> toHolePolygons() const;
+		// the rings offset by distance, kept until a different offset is asked for. Not safe to call from
+		// several threads.
+		PartOffset_p getOffset(double distance, OffsetJoin join, double tolerance = 0.0) const;
+		// the edges of the outline and the holes in a bounding box hierarchy, built when first asked for
+		// and again after the rings change. Safe to call from several threads.
+		EdgeTree_p getEdgeTree() const;
 		virtual void write(shared_ptr<FileWriter> writer, transformer_t& transformer) const;
 		virtual BoundingBox getBoundingBox() const;
 	};
 
 	typedef shared_ptr<NesterPart> NesterPart_p;
 
+	struct NfpTiming;
+	struct NestingResult;
+	struct PartShape;
+	class NfpCache;
+	class InnerFitCache;
+	struct HolePlacement;
+
+	enum NestingStrategy {
+		STRATEGY_BOTTOM_LEFT,  // constructive placement, optionally with a genetic search over the order
+		STRATEGY_ANNEALING,    // bottom-left start, then overlap minimization on ever shorter sheets
+		STRATEGY_RASTER,       // approximate bottom-left on bitmaps, for quick previews of large jobs
+		STRATEGY_SHELF         // bounding boxes in rows, milliseconds even for thousands of parts
+	};
+
+	// Both heuristics handle the boxes tallest first. Next fit only ever adds to the newest shelf,
+	// first fit puts a box on the lowest shelf with enough room left.
+	enum ShelfHeuristic {
+		SHELF_NEXT_FIT,
+		SHELF_FIRST_FIT
+	};
+
+	// A size of stock material, quantity is negative for as many sheets as needed. Stock of any other
+	// shape, like an offcut, has a profile: the outline with its minimum corner at the origin and holes
+	// for the defects. width and height are those of its bounding box then.
+	struct StockSheet {
+		double width, height;
+		int quantity;
+		NesterPart_p profile;
+	};
+
+	// Where a part ends up on the sheet
+	struct Placement {
+		NesterPart_p part;
+		transformer_t transformer;
+		size_t sheet;  // index into getSheets(), 0 without stock sizes
+
+		Placement() : sheet(0) {}
+	};
+
+	enum ViolationKind {
+		VIOLATION_CROSSING,  // the outlines of the two parts cross
+		VIOLATION_INSIDE     // the first part lies inside the material of the second
+	};
+
+	// Two placed parts which overlap, first and second index the placements
+	struct LayoutViolation {
+		size_t first, second;
+		ViolationKind kind;
+		point_t where;  // a point in the overlap
+		double area;    // of the overlap (cm2), 0 when it is thinner than the grid of the boolean operations
+	};
+
 	class Nester {
 		vector<NesterPart_p> parts;
+		vector<Placement> placements;
 		shared_ptr<ostream> log;
+		double sheetWidth;
+		double spacing;
+		double kerf;
+		OffsetJoin join;
+		double nestingTolerance;
+		int rotations;
+		size_t threads;
+		NestingStrategy strategy;
+		double searchSeconds;
+		unsigned searchSeed;
+		double rasterResolution;
+		ShelfHeuristic shelfHeuristic;
+		double rectangleTolerance;
+		bool fillHoles;
+		vector<StockSheet> stock;
+		vector<size_t> sheets;
+
+		double gap() const;
+		double autoSheetWidth(const vector<BoundingBox>& boxes) const;
+		vector<Placement> shelfPlacements() const;
+		NestingResult packRectangles(const vector<PartShape>& shapes, const vector<bool>& irregular, vector<size_t>& order, double width) const;
+		NestingResult nestSheet(const vector<PartShape>& shapes, NfpCache& nfps, InnerFitCache* profile, const vector<bool>& irregular,
+			vector<size_t> order, double width, double seconds, ostream& log) const;
+		void nestSheets(const vector<PartShape>& shapes, const vector<size_t>& order, vector<size_t>& placedShapes);
+		void addHoleParts(const vector<PartShape>& shapes, const vector<HolePlacement>& inHoles, vector<size_t>& placedShapes);
+		void logNfpTimings(const vector<NfpTiming>& timings, size_t workers, chrono::steady_clock::duration wall) const;
 	public:
 		Nester();
 
 		void addPart(NesterPart_p part);
-
+		void setLog(shared_ptr<ostream> log);
+
+		// width of the sheet along x, the layout grows along y. 0 picks a width from the part sizes.
+		void setSheetWidth(double width);
+		// clearance between the cut lines of neighbouring parts
+		void setSpacing(double spacing);
+		// width of the cut. Parts and the holes of parts are kept the kerf plus the spacing apart, by growing
+		// the outlines and shrinking the holes by half of that.
+		void setKerf(double kerf);
+		void setJoin(OffsetJoin join);
+		// how far the outlines the engines work with may stray from the parts. They are simplified and grown
+		// by this much, which saves time on finely tessellated curves. The parts are written as they are.
+		void setNestingTolerance(double tolerance);
+		// number of evenly spaced rotations each part may be placed in, counted from the one which gives
+		// it the smallest bounding box
+		void setRotations(int rotations);
+		// worker threads for the parallel stages, 0 uses all cores
+		void setThreads(size_t threads);
+		void setStrategy(NestingStrategy strategy);
+		// time the strategy may spend improving the first layout. With the bottom-left strategy this
+		// evolves the part order and rotations with a genetic algorithm. 0 keeps the first layout.
+		void setSearch(double seconds, unsigned seed);
+		// cell size of the raster strategy, 0 divides the sheet width into RASTER_AUTO_COLUMNS cells
+		void setRasterResolution(double resolution);
+		void setShelfHeuristic(ShelfHeuristic heuristic);
+		// parts covering all but this fraction of their bounding box are packed as rectangles before the
+		// polygon strategies place the others around them. Negative leaves everything to the polygons.
+		void setRectangleTolerance(double tolerance);
+		// nest small parts into the holes of large ones before the others are nested, on by default.
+		// The shelf strategy leaves holes alone.
+		void setFillHoles(bool fill);
+		// Adds a size of stock material. With stock sizes the parts are distributed over sheets of these
+		// sizes, in the order they were added, instead of one sheet of unbounded length.
+		void addStockSheet(double width, double height, int quantity);
+		// Adds stock of the shape of the given part, whose holes are defects no part may cover. The parts
+		// are placed with the bottom-left strategy on it, and on the sheet the outline is moved so that its
+		// bounding box starts at the origin.
+		void addStockProfile(NesterPart_p profile, int quantity);
+
+		// computes placements with the selected strategy
 		void run();
-
+		const vector<Placement>& getPlacements() const;
+		// the stock size each sheet filled by run() is cut from
+		const vector<size_t>& getSheets() const;
+		// the parts run() left out, those which fit on none of the stock sheets left and those without a
+		// usable outline, in the order they were added
+		vector<NesterPart_p> getUnplaced() const;
+
+		// checks the placements of run() (or the bounding box packing write() falls back to) for parts which
+		// overlap, and logs every pair it finds
+		vector<LayoutViolation> verify() const;
+		// writes the placements of run(), or without those the parts packed by their bounding boxes.
+		// Several sheets are written next to each other.
 		void write(shared_ptr<FileWriter> writer) const;
+		// writes the parts run() placed on one sheet
+		void writeSheet(shared_ptr<FileWriter> writer, size_t sheet) const;
 	};
 
 }
@@ -0,0 +1,314 @@
+#include <chrono>
+#include <cmath>
+#include <set>
+
+#include "Geometry.hpp"
+#include "NoFitPolygon.hpp"
+#include "PolygonBoolean.hpp"
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// a point must be further than this from a piece boundary to count as inside it (cm)
+	const double NFP_TOLERANCE = 1e-7;
+
+	static size_t lowestPoint(const polygon_t& polygon) {
+		size_t lowest = 0;
+		for (size_t i = 1; i < polygon.size(); i++) {
+			if (polygon[i].y < polygon[lowest].y ||
+				(polygon[i].y == polygon[lowest].y && polygon[i].x < polygon[lowest].x)) {
+				lowest = i;
+			}
+		}
+		return lowest;
+	}
+
+	polygon_t minkowskiSum(const polygon_t& a, const polygon_t& b) {
+		polygon_t result;
+		size_t n = a.size();
+		size_t m = b.size();
+		if (n == 0 || m == 0) {
+			return result;
+		}
+		result.reserve(n + m);
+
+		// merge the edges of both polygons by slope, starting from their lowest points
+		size_t ia = lowestPoint(a);
+		size_t ib = lowestPoint(b);
+		size_t i = 0, j = 0;
+		while (i < n || j < m) {
+			result.push_back(a[(ia + i) % n] + b[(ib + j) % m]);
+			point_t ea = a[(ia + i + 1) % n] - a[(ia + i) % n];
+			point_t eb = b[(ib + j + 1) % m] - b[(ib + j) % m];
+			double turn = ea.x * eb.y - ea.y * eb.x;
+			if (j >= m || (i < n && turn > 0.0)) {
+				i++;
+			}
+			else if (i >= n || turn < 0.0) {
+				j++;
+			}
+			else {
+				i++;
+				j++;
+			}
+		}
+		return result;
+	}
+
+	void NoFitPolygon::addPiece(const polygon_t& piece) {
+		polygon_t cleaned;
+		for (const point_t& p : piece) {
+			if (cleaned.empty() || p != cleaned.back()) {
+				cleaned.push_back(p);
+			}
+		}
+		while (cleaned.size() > 1 && cleaned.front() == cleaned.back()) {
+			cleaned.pop_back();
+		}
+		if (cleaned.size() < 3) {
+			return;
+		}
+
+		BoundingBox bb = getBoundingBox(cleaned);
+		pieces.push_back(cleaned);
+		pieceBounds.push_back(bb);
+		bounds.join(bb);
+	}
+
+	// true if p lies further than NFP_TOLERANCE to the left of the edge a->b
+	static bool leftOf(point_t a, point_t b, point_t p) {
+		point_t edge = b - a;
+		double c = cross(a, b, p);
+		return c > 0.0 && c * c > NFP_TOLERANCE * NFP_TOLERANCE * glm::dot(edge, edge);
+	}
+
+	bool NoFitPolygon::containsInterior(point_t p) const {
+		if (p.x <= bounds.minX || p.x >= bounds.maxX || p.y <= bounds.minY || p.y >= bounds.maxY) {
+			return false;
+		}
+
+		for (size_t i = 0; i < pieces.size(); i++) {
+			const BoundingBox& bb = pieceBounds[i];
+			if (p.x <= bb.minX || p.x >= bb.maxX || p.y <= bb.minY || p.y >= bb.maxY) {
+				continue;
+			}
+
+			// binary search for the triangle of the fan around the first vertex which holds p
+			const polygon_t& piece = pieces[i];
+			size_t n = piece.size();
+			if (!leftOf(piece[0], piece[1], p) || !leftOf(piece[n - 1], piece[0], p)) {
+				continue;
+			}
+			size_t low = 1, high = n - 1;
+			while (high - low > 1) {
+				size_t mid = (low + high) / 2;
+				if (orient2d(piece[0], piece[mid], p) >= 0.0) {
+					low = mid;
+				}
+				else {
+					high = mid;
+				}
+			}
+			if (leftOf(piece[low], piece[high], p)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	double NoFitPolygon::penetrationDepth(point_t p) const {
+		return glm::length(penetrationVector(p));
+	}
+
+	point_t NoFitPolygon::penetrationVector(point_t p) const {
+		point_t way(0.0, 0.0);
+		if (p.x <= bounds.minX || p.x >= bounds.maxX || p.y <= bounds.minY || p.y >= bounds.maxY) {
+			return way;
+		}
+
+		double deepest = NFP_TOLERANCE;
+		for (size_t i = 0; i < pieces.size(); i++) {
+			const BoundingBox& bb = pieceBounds[i];
+			if (p.x <= bb.minX || p.x >= bb.maxX || p.y <= bb.minY || p.y >= bb.maxY) {
+				continue;
+			}
+
+			// inside a convex piece the way out is through the nearest edge
+			const polygon_t& piece = pieces[i];
+			double depth = numeric_limits<double>::infinity();
+			point_t out;
+			for (size_t k = 0, l = piece.size() - 1; k < piece.size() && depth > 0.0; l = k++) {
+				point_t edge = piece[k] - piece[l];
+				double length = glm::length(edge);
+				if (length > 0.0) {
+					double distance = cross(piece[l], piece[k], p) / length;
+					if (distance < depth) {
+						depth = distance;
+						out = point_t(edge.y, -edge.x) / length;
+					}
+				}
+			}
+			if (depth > deepest) {
+				deepest = depth;
+				way = out * depth;
+			}
+		}
+		return way;
+	}
+
+	size_t NoFitPolygon::vertexCount() const {
+		size_t count = 0;
+		for (const polygon_t& piece : pieces) {
+			count += piece.size();
+		}
+		return count;
+	}
+
+	vector<polygon_t> NoFitPolygon::region() const {
+		return booleanOperation(pieces, {}, BOOLEAN_UNION);
+	}
+
+	static polygon_t negate(const polygon_t& polygon) {
+		polygon_t result;
+		result.reserve(polygon.size());
+		for (const point_t& p : polygon) {
+			result.push_back(-p);
+		}
+		return result;
+	}
+
+	static NoFitPolygon sumPieces(const ConvexPieces& fixed, const ConvexPieces& reflectedMoving) {
+		NoFitPolygon nfp;
+		MinkowskiKernel kernel;
+		polygon_t sum;
+		for (size_t m = 0; m < reflectedMoving.size(); m++) {
+			for (size_t f = 0; f < fixed.size(); f++) {
+				kernel.sum(fixed, f, reflectedMoving, m, sum);
+				nfp.addPiece(sum);
+			}
+		}
+		return nfp;
+	}
+
+	NoFitPolygon computeNoFitPolygon(const OrientedShape& fixed, const OrientedShape& moving, size_t maxPieces) {
+		if (fixed.pieces.size() * moving.pieces.size() > maxPieces) {
+			return sumPieces(ConvexPieces({ convexHull(fixed.grown) }), ConvexPieces({ negate(convexHull(moving.grown)) }));
+		}
+
+		ConvexPieces reflected;
+		for (const polygon_t& piece : moving.pieces) {
+			reflected.add(negate(piece));
+		}
+		return sumPieces(ConvexPieces(fixed.pieces), reflected);
+	}
+
+	NfpCache::NfpCache(const vector<PartShape>& shapes, size_t maxPieces) :
+		shapes(shapes), maxPieces(maxPieces) {
+
+		// the fixed side is always in its first orientation, the moving side is reflected through its
+		// origin. Prepare both once per shape rather than once per pair.
+		for (const PartShape& shape : shapes) {
+			Operands operands;
+			operands.fixed = ConvexPieces(shape.orientations[0].pieces);
+			operands.fixedHull = ConvexPieces({ convexHull(shape.orientations[0].grown) });
+			for (const OrientedShape& oriented : shape.orientations) {
+				ConvexPieces reflected;
+				for (const polygon_t& piece : oriented.pieces) {
+					reflected.add(negate(piece));
+				}
+				operands.reflected.push_back(reflected);
+				operands.reflectedHull.push_back(ConvexPieces({ negate(convexHull(oriented.grown)) }));
+			}
+			operands.pieces = shape.orientations[0].pieces.size();
+			this->operands.push_back(operands);
+		}
+	}
+
+	NoFitPolygon NfpCache::compute(size_t fixed, size_t moving, size_t rotation) const {
+		const Operands& f = operands[fixed];
+		const Operands& m = operands[moving];
+		if (f.pieces * m.pieces > maxPieces) {
+			return sumPieces(f.fixedHull, m.reflectedHull[rotation]);
+		}
+		return sumPieces(f.fixed, m.reflected[rotation]);
+	}
+
+	size_t NfpCache::rotationBetween(size_t fixedOrientation, size_t movingOrientation) const {
+		size_t rotations = shapes.empty() ? 1 : shapes[0].orientations.size();
+		return (movingOrientation + rotations - fixedOrientation) % rotations;
+	}
+
+	void NfpCache::precompute(ThreadPool& pool, const vector<bool>& moving) {
+		// one representative shape per outline, and whether the outline occurs more than once
+		map<size_t, size_t> representative;
+		map<size_t, size_t> occurrences;
+		set<size_t> movingIds;
+		for (size_t i = 0; i < shapes.size(); i++) {
+			representative.insert(make_pair(shapes[i].shapeId, i));
+			occurrences[shapes[i].shapeId]++;
+			if (moving.empty() || moving[i]) {
+				movingIds.insert(shapes[i].shapeId);
+			}
+		}
+		size_t rotations = shapes.empty() ? 1 : shapes[0].orientations.size();
+
+		vector<NfpTiming> tasks;
+		shared_lock<shared_timed_mutex> known(lock);
+		for (auto fixed : representative) {
+			for (auto other : representative) {
+				if ((fixed.first == other.first && occurrences[fixed.first] < 2) || movingIds.count(other.first) == 0) {
+					continue;
+				}
+				for (size_t r = 0; r < rotations; r++) {
+					if (nfps.count(key_t(fixed.first, other.first, r)) == 0) {
+						NfpTiming task = { fixed.second, other.second, r, 0, 0.0 };
+						tasks.push_back(task);
+					}
+				}
+			}
+		}
+
+		known.unlock();
+
+		vector<shared_ptr<NoFitPolygon> > results(tasks.size());
+		for (size_t i = 0; i < tasks.size(); i++) {
+			pool.submit([this, i, &tasks, &results]() {
+				auto started = chrono::steady_clock::now();
+				NfpTiming& task = tasks[i];
+				results[i] = make_shared<NoFitPolygon>(compute(task.fixedShape, task.movingShape, task.rotation));
+				task.pieces = results[i]->pieces.size();
+				task.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+			});
+		}
+		pool.wait();
+
+		lock_guard<shared_timed_mutex> guard(lock);
+		for (size_t i = 0; i < tasks.size(); i++) {
+			nfps[key_t(shapes[tasks[i].fixedShape].shapeId, shapes[tasks[i].movingShape].shapeId, tasks[i].rotation)] = results[i];
+		}
+		timings.insert(timings.end(), tasks.begin(), tasks.end());
+	}
+
+	const vector<NfpTiming>& NfpCache::getTimings() const {
+		return timings;
+	}
+
+	const NoFitPolygon& NfpCache::get(size_t fixed, size_t moving, size_t rotation) {
+		key_t key(shapes[fixed].shapeId, shapes[moving].shapeId, rotation);
+		{
+			// entries are never removed, so what is found stays valid after the lock is let go
+			shared_lock<shared_timed_mutex> guard(lock);
+			auto known = nfps.find(key);
+			if (known != nfps.end()) {
+				return *known->second;
+			}
+		}
+
+		// computed without the lock, so the other threads keep finding theirs. When two threads compute
+		// the same one the first to put it in wins.
+		shared_ptr<NoFitPolygon> nfp = make_shared<NoFitPolygon>(compute(fixed, moving, rotation));
+		lock_guard<shared_timed_mutex> guard(lock);
+		return *nfps.emplace(key, nfp).first->second;
+	}
+
+}
@@ -0,0 +1,85 @@
+#ifndef _NO_FIT_POLYGON_H_
+#define _NO_FIT_POLYGON_H_
+
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+
+#include "MinkowskiKernel.hpp"
+#include "Nester.hpp"
+#include "PartShape.hpp"
+#include "ThreadPool.hpp"
+
+namespace nester {
+
+	// Minkowski sum of two convex counter clockwise polygons
+	polygon_t minkowskiSum(const polygon_t& a, const polygon_t& b);
+
+	// The no-fit polygon of a moving shape around a fixed shape: the moving shape overlaps the
+	// fixed one exactly when its reference point lies in the interior of the union of the pieces.
+	class NoFitPolygon {
+	public:
+		vector<polygon_t> pieces;         // convex, counter clockwise
+		vector<BoundingBox> pieceBounds;
+		BoundingBox bounds;
+
+		void addPiece(const polygon_t& piece);
+		bool containsInterior(point_t p) const;
+		// how far p has to move to leave the piece it is deepest inside, 0 when outside
+		double penetrationDepth(point_t p) const;
+		// the shortest move which takes p out of the piece it is deepest inside
+		point_t penetrationVector(point_t p) const;
+		size_t vertexCount() const;
+		// the union of the pieces: counter clockwise outlines and clockwise holes
+		vector<polygon_t> region() const;
+	};
+
+	// NFP of the grown outline of moving around that of fixed, so the parts keep the margins they were
+	// grown by. If the pair would produce more than maxPieces convex pieces the convex hulls are used instead.
+	NoFitPolygon computeNoFitPolygon(const OrientedShape& fixed, const OrientedShape& moving, size_t maxPieces);
+
+	struct NfpTiming {
+		size_t fixedShape, movingShape, rotation;
+		size_t pieces;
+		double milliseconds;
+	};
+
+	// No-fit polygons are computed with the fixed shape in its first orientation. A fixed shape in
+	// orientation a and a moving shape in orientation b uses the NFP for rotation b - a turned by angle a.
+	class NfpCache {
+		typedef tuple<size_t, size_t, size_t> key_t;
+
+		struct Operands {
+			size_t pieces;
+			ConvexPieces fixed;              // first orientation
+			ConvexPieces fixedHull;
+			vector<ConvexPieces> reflected;  // per orientation, mirrored through the origin
+			vector<ConvexPieces> reflectedHull;
+		};
+
+		const vector<PartShape>& shapes;
+		vector<Operands> operands;
+		size_t maxPieces;
+		map<key_t, shared_ptr<NoFitPolygon> > nfps;
+		shared_timed_mutex lock;  // shared for lookups, exclusive while an NFP is added
+		vector<NfpTiming> timings;
+
+		NoFitPolygon compute(size_t fixed, size_t moving, size_t rotation) const;
+	public:
+		NfpCache(const vector<PartShape>& shapes, size_t maxPieces = 4096);
+
+		// Computes the NFP of every pair of shapes in every relative rotation on the pool. Afterwards
+		// get() only looks them up, which threads do side by side. With moving given, only the pairs
+		// whose moving shape is flagged there are computed and anything else is computed when it is
+		// asked for, holding up the other threads meanwhile.
+		void precompute(ThreadPool& pool, const vector<bool>& moving = vector<bool>());
+		const vector<NfpTiming>& getTimings() const;
+
+		const NoFitPolygon& get(size_t fixed, size_t moving, size_t rotation);
+		size_t rotationBetween(size_t fixedOrientation, size_t movingOrientation) const;
+	};
+
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Nurbs.hpp"
+#include "Simd.hpp"
+
+namespace nester {
+
+	// chords per knot span before any are halved
+	const int NURBS_SPAN_CHORDS = 4;
+	// a chord is halved at most this often
+	const int NURBS_MAX_HALVINGS = 24;
+
+	int NurbsCurve::degree() const {
+		return (int)knots.size() - (int)controlPoints.size() - 1;
+	}
+
+	bool NurbsCurve::isValid() const {
+		int p = degree();
+		if (p < 1 || controlPoints.size() < (size_t)p + 1) {
+			return false;
+		}
+		if (!weights.empty() && weights.size() != controlPoints.size()) {
+			return false;
+		}
+		for (double w : weights) {
+			if (!(w > 0.0)) {
+				return false;
+			}
+		}
+		for (size_t k = 0; k + 1 < knots.size(); k++) {
+			if (!(knots[k] <= knots[k + 1])) {
+				return false;
+			}
+		}
+		return startParameter() < endParameter();
+	}
+
+	double NurbsCurve::startParameter() const {
+		return knots[degree()];
+	}
+
+	double NurbsCurve::endParameter() const {
+		return knots[controlPoints.size()];
+	}
+
+	// one step of de Boor's algorithm for a batch: to = from + alpha * (to - from)
+	static void blendRows(const double* alpha, const double* from, double* to, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			to[i] = from[i] + alpha[i] * (to[i] - from[i]);
+		}
+	}
+
+#ifdef NESTER_AVX2
+	// four parameters at a time
+	AVX2_TARGET static void blendRowsAvx2(const double* alpha, const double* from, double* to, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m256d a = _mm256_loadu_pd(alpha + i);
+			__m256d f = _mm256_loadu_pd(from + i);
+			__m256d t = _mm256_loadu_pd(to + i);
+			_mm256_storeu_pd(to + i, _mm256_add_pd(f, _mm256_mul_pd(a, _mm256_sub_pd(t, f))));
+		}
+		blendRows(alpha + i, from + i, to + i, count - i);
+	}
+#endif
+
+	static void blend(const double* alpha, const double* from, double* to, size_t count) {
+#ifdef NESTER_AVX2
+		if (hasAvx2()) {
+			blendRowsAvx2(alpha, from, to, count);
+			return;
+		}
+#endif
+		blendRows(alpha, from, to, count);
+	}
+
+	void evaluateNurbs(const NurbsCurve& curve, const vector<double>& parameters, polygon_t& points) {
+		points.clear();
+		points.reserve(parameters.size());
+		size_t p = (size_t)curve.degree();
+		size_t n = curve.controlPoints.size();
+		const vector<double>& knots = curve.knots;
+
+		// the knot span of each parameter, the last span which is not empty for the end of the curve
+		vector<double> t(parameters.size());
+		vector<size_t> spans(parameters.size());
+		size_t k = p;
+		for (size_t i = 0; i < parameters.size(); i++) {
+			t[i] = min(max(parameters[i], curve.startParameter()), curve.endParameter());
+			while (k + 1 < n && knots[k + 1] <= t[i]) {
+				k++;
+			}
+			spans[i] = k;
+			while (spans[i] > p && knots[spans[i]] == knots[spans[i] + 1]) {
+				spans[i]--;
+			}
+		}
+
+		// homogeneous coordinates, a row of the batch for each control point of the span
+		vector<double> x, y, w, alpha;
+		size_t first = 0;
+		while (first < t.size()) {
+			size_t span = spans[first];
+			size_t last = first;
+			while (last < t.size() && spans[last] == span) {
+				last++;
+			}
+			size_t m = last - first;
+
+			x.resize((p + 1) * m);
+			y.resize((p + 1) * m);
+			w.resize((p + 1) * m);
+			alpha.resize(m);
+			for (size_t j = 0; j <= p; j++) {
+				size_t c = span - p + j;
+				double weight = curve.weights.empty() ? 1.0 : curve.weights[c];
+				fill(x.begin() + j * m, x.begin() + (j + 1) * m, curve.controlPoints[c].x * weight);
+				fill(y.begin() + j * m, y.begin() + (j + 1) * m, curve.controlPoints[c].y * weight);
+				fill(w.begin() + j * m, w.begin() + (j + 1) * m, weight);
+			}
+
+			for (size_t r = 1; r <= p; r++) {
+				for (size_t j = p; j >= r; j--) {
+					double low = knots[span - p + j];
+					double scale = 1.0 / (knots[span + 1 + j - r] - low);
+					for (size_t i = 0; i < m; i++) {
+						alpha[i] = (t[first + i] - low) * scale;
+					}
+					blend(alpha.data(), x.data() + (j - 1) * m, x.data() + j * m, m);
+					blend(alpha.data(), y.data() + (j - 1) * m, y.data() + j * m, m);
+					blend(alpha.data(), w.data() + (j - 1) * m, w.data() + j * m, m);
+				}
+			}
+
+			for (size_t i = 0; i < m; i++) {
+				points.push_back(point_t(x[p * m + i] / w[p * m + i], y[p * m + i] / w[p * m + i]));
+			}
+			first = last;
+		}
+	}
+
+	static double chordDistance(point_t p, point_t a, point_t b) {
+		point_t ab = b - a;
+		double length2 = glm::dot(ab, ab);
+		if (length2 == 0.0) {
+			return glm::distance(p, a);
+		}
+		double s = min(max(glm::dot(p - a, ab) / length2, 0.0), 1.0);
+		return glm::distance(p, a + ab * s);
+	}
+
+	polygon_t tessellateNurbs(const NurbsCurve& curve, double tolerance) {
+		size_t p = (size_t)curve.degree();
+		size_t n = curve.controlPoints.size();
+		const vector<double>& knots = curve.knots;
+
+		vector<double> t;
+		for (size_t k = p; k < n; k++) {
+			if (knots[k] < knots[k + 1]) {
+				for (int s = 0; s < NURBS_SPAN_CHORDS; s++) {
+					t.push_back(knots[k] + (knots[k + 1] - knots[k]) * s / NURBS_SPAN_CHORDS);
+				}
+			}
+		}
+		t.push_back(curve.endParameter());
+		polygon_t points;
+		evaluateNurbs(curve, t, points);
+
+		// open[i] while the chord from point i to i + 1 still has to be checked
+		vector<unsigned char> open(t.size() - 1, 1);
+		vector<double> middles, nextT;
+		polygon_t middlePoints, nextPoints;
+		vector<unsigned char> nextOpen;
+		for (int round = 0; round <= NURBS_MAX_HALVINGS; round++) {
+			middles.clear();
+			for (size_t i = 0; i + 1 < t.size(); i++) {
+				if (open[i]) {
+					middles.push_back((t[i] + t[i + 1]) / 2.0);
+				}
+			}
+			if (middles.empty()) {
+				break;
+			}
+			evaluateNurbs(curve, middles, middlePoints);
+
+			nextT.clear();
+			nextPoints.clear();
+			nextOpen.clear();
+			size_t m = 0;
+			for (size_t i = 0; i + 1 < t.size(); i++) {
+				nextT.push_back(t[i]);
+				nextPoints.push_back(points[i]);
+				bool halve = open[i] && chordDistance(middlePoints[m], points[i], points[i + 1]) > tolerance;
+				if (halve) {
+					nextT.push_back(middles[m]);
+					nextPoints.push_back(middlePoints[m]);
+				}
+				m += open[i];
+				// the halves are checked again, unless this was the last round
+				unsigned char again = halve && round < NURBS_MAX_HALVINGS ? 1 : 0;
+				nextOpen.push_back(again);
+				if (halve) {
+					nextOpen.push_back(again);
+				}
+			}
+			nextT.push_back(t.back());
+			nextPoints.push_back(points.back());
+			t.swap(nextT);
+			points.swap(nextPoints);
+			open.swap(nextOpen);
+		}
+		return points;
+	}
+
+}
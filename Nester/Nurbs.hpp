@@ -0,0 +1,33 @@
+#ifndef _NURBS_H_
+#define _NURBS_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// A rational B-spline in the plane. The knot vector is complete, with degree + 1 more knots than
+	// control points. Without weights the spline is polynomial.
+	struct NurbsCurve {
+		vector<point_t> controlPoints;
+		vector<double> weights;  // empty or positive, one per control point
+		vector<double> knots;
+
+		int degree() const;
+		// at least degree 1, knots which never fall, and a parameter range which is not empty
+		bool isValid() const;
+		double startParameter() const;
+		double endParameter() const;
+	};
+
+	// Points of a valid curve at the sorted parameters, which are clamped to its range. All the
+	// parameters of a knot span go through de Boor's algorithm together, each step for the whole batch.
+	void evaluateNurbs(const NurbsCurve& curve, const vector<double>& parameters, polygon_t& points);
+
+	// Points along a valid curve, both ends included, with the chords within tolerance of the curve.
+	// Each knot span starts out with a few chords, then every chord whose middle on the curve lies
+	// further than tolerance from it is halved, one batch of evaluations per round.
+	polygon_t tessellateNurbs(const NurbsCurve& curve, double tolerance);
+
+}
+
+#endif
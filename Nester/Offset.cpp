@@ -0,0 +1,84 @@
+#include <cmath>
+
+#include "Geometry.hpp"
+#include "Offset.hpp"
+#include "PolygonBoolean.hpp"
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// points closer than this are merged before offsetting (cm)
+	const double OFFSET_TOLERANCE = 1e-9;
+
+	static point_t direction(point_t a, point_t b) {
+		return glm::normalize(b - a);
+	}
+
+	vector<polygon_t> offsetRing(const polygon_t& ring, double distance, OffsetJoin join) {
+		polygon_t points = ring;
+		cleanPolygon(points, OFFSET_TOLERANCE);
+		if (points.size() < 3) {
+			return vector<polygon_t>();
+		}
+		makeCounterClockwise(points);
+		if (distance == 0.0) {
+			return { points };
+		}
+
+		// edge i runs from point i to i + 1, the side it moves to is right of it when growing
+		size_t n = points.size();
+		double r = fabs(distance);
+		vector<point_t> edges(n), sides(n);
+		for (size_t i = 0; i < n; i++) {
+			edges[i] = direction(points[i], points[(i + 1) % n]);
+			sides[i] = point_t(edges[i].y, -edges[i].x) * (distance > 0.0 ? 1.0 : -1.0);
+		}
+		// the largest angle one segment of a round join may cover
+		double step = 2.0 * acos(r / (r + OFFSET_ARC_TOLERANCE));
+
+		polygon_t raw;
+		for (size_t i = 0; i < n; i++) {
+			point_t p = points[i];
+			point_t d1 = edges[(i + n - 1) % n], d2 = edges[i];
+			point_t u1 = sides[(i + n - 1) % n], u2 = sides[i];
+			point_t q1 = p + r * u1, q2 = p + r * u2;
+			// the angle from the one moved edge to the other as seen from the corner
+			double angle = atan2(u1.x * u2.y - u1.y * u2.x, glm::dot(u1, u2));
+			bool opens = (distance > 0.0) == (orient2d(points[(i + n - 1) % n], p, points[(i + 1) % n]) > 0.0);
+			if (!opens || fabs(angle) < 1e-12) {
+				// the moved edges overlap here, the union removes the loop going round the corner
+				raw.push_back(q1);
+				raw.push_back(p);
+				raw.push_back(q2);
+				continue;
+			}
+
+			double half = fabs(angle) / 2.0;
+			if (join == JOIN_ROUND) {
+				// the corners of a polygon around the arc, which touches it at q1, q2 and in between
+				int segments = max(1, (int)ceil(fabs(angle) / step));
+				double spanned = angle / segments;
+				double radius = r / cos(spanned / 2.0);
+				double start = atan2(u1.y, u1.x);
+				raw.push_back(q1);
+				for (int k = 0; k < segments; k++) {
+					double a = start + (k + 0.5) * spanned;
+					raw.push_back(p + radius * point_t(cos(a), sin(a)));
+				}
+				raw.push_back(q2);
+			}
+			else if (1.0 / cos(half) <= OFFSET_MITER_LIMIT) {
+				raw.push_back(p + glm::normalize(u1 + u2) * (r / cos(half)));
+			}
+			else {
+				// both moved edges end where they cross the line square to the bisector at the limit
+				point_t bisector = glm::length(u1 + u2) > 1e-12 ? glm::normalize(u1 + u2) : d1;
+				double limit = OFFSET_MITER_LIMIT * r;
+				raw.push_back(q1 + d1 * ((limit - glm::dot(q1 - p, bisector)) / glm::dot(d1, bisector)));
+				raw.push_back(q2 + d2 * ((limit - glm::dot(q2 - p, bisector)) / glm::dot(d2, bisector)));
+			}
+		}
+		return booleanOperation({ raw }, vector<polygon_t>(), BOOLEAN_UNION, FILL_POSITIVE);
+	}
+
+}
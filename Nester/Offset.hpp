@@ -0,0 +1,22 @@
+#ifndef _OFFSET_H_
+#define _OFFSET_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// miter joins reaching further than this many times the distance from their corner are cut off square
+	const double OFFSET_MITER_LIMIT = 2.0;
+	// how far round joins may stick out beyond the true arc (cm). They are approximated from outside,
+	// so the offset never comes closer than the distance.
+	const double OFFSET_ARC_TOLERANCE = 0.01;
+
+	// Moves the boundary of the area a ring encloses outwards by distance, inwards for a negative one.
+	// Every edge is moved along its normal, the corners which open up are joined as asked and the
+	// loops where the moved edges cross are removed with a union. The result has counter clockwise
+	// outlines and clockwise holes; shrinking can split the area or make it vanish.
+	vector<polygon_t> offsetRing(const polygon_t& ring, double distance, OffsetJoin join);
+
+}
+
+#endif
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Geometry.hpp"
+#include "OverlapAnnealer.hpp"
+
+namespace nester {
+
+	// the fraction of the sheet length each squeeze tries to remove, and the smallest one worth trying
+	const double INITIAL_SQUEEZE = 0.02;
+	const double MINIMUM_SQUEEZE = 0.001;
+	// moves per part before a squeeze is given up
+	const size_t MOVES_PER_PART = 2000;
+	const double ROTATION_MOVE_CHANCE = 0.1;
+	const double SEPARATION_MOVE_CHANCE = 0.5;
+	// below this the running total is recounted from scratch, since the increments accumulate rounding errors
+	const double RECOUNT_COST = 1e-6;
+
+	OverlapAnnealer::PartGrid::PartGrid(double cellSize, size_t parts) : cellSize(cellSize), stamps(parts, 0), stamp(0) {}
+
+	long long OverlapAnnealer::PartGrid::key(long long column, long long row) const {
+		return (column << 32) ^ (row & 0xffffffffLL);
+	}
+
+	void OverlapAnnealer::PartGrid::insert(size_t part, const BoundingBox& bb) {
+		for (long long r = (long long)floor(bb.minY / cellSize); r <= (long long)floor(bb.maxY / cellSize); r++) {
+			for (long long c = (long long)floor(bb.minX / cellSize); c <= (long long)floor(bb.maxX / cellSize); c++) {
+				cells[key(c, r)].push_back(part);
+			}
+		}
+	}
+
+	void OverlapAnnealer::PartGrid::remove(size_t part, const BoundingBox& bb) {
+		for (long long r = (long long)floor(bb.minY / cellSize); r <= (long long)floor(bb.maxY / cellSize); r++) {
+			for (long long c = (long long)floor(bb.minX / cellSize); c <= (long long)floor(bb.maxX / cellSize); c++) {
+				vector<size_t>& cell = cells[key(c, r)];
+				auto found = find(cell.begin(), cell.end(), part);
+				if (found != cell.end()) {
+					*found = cell.back();
+					cell.pop_back();
+				}
+			}
+		}
+	}
+
+	void OverlapAnnealer::PartGrid::query(const BoundingBox& bb, vector<size_t>& found) {
+		found.clear();
+		stamp++;
+		for (long long r = (long long)floor(bb.minY / cellSize); r <= (long long)floor(bb.maxY / cellSize); r++) {
+			for (long long c = (long long)floor(bb.minX / cellSize); c <= (long long)floor(bb.maxX / cellSize); c++) {
+				auto cell = cells.find(key(c, r));
+				if (cell == cells.end()) {
+					continue;
+				}
+				for (size_t part : cell->second) {
+					if (stamps[part] != stamp) {
+						stamps[part] = stamp;
+						found.push_back(part);
+					}
+				}
+			}
+		}
+	}
+
+	OverlapAnnealer::OverlapAnnealer(const vector<PartShape>& shapes, NfpCache& nfps, double sheetWidth, double spacing, unsigned seed) :
+		shapes(shapes), nfps(nfps), sheetWidth(sheetWidth), spacing(spacing), random(seed), totalCost(0.0) {
+		// the NFPs hold the fixed shape in its first orientation, so only the turn from there is applied
+		for (const PartShape& shape : shapes) {
+			rotate.push_back(vector<transformer_t>());
+			unrotate.push_back(vector<transformer_t>());
+			for (const OrientedShape& oriented : shape.orientations) {
+				double turn = oriented.angle - shape.orientations[0].angle;
+				rotate.back().push_back(makeTransformation(turn, 0.0, 0.0));
+				unrotate.back().push_back(makeTransformation(-turn, 0.0, 0.0));
+			}
+		}
+	}
+
+	BoundingBox OverlapAnnealer::boundsAt(size_t part, size_t orientation, point_t position) const {
+		BoundingBox bb = shapes[partShapes[part]].orientations[orientation].bounds;
+		bb.minX += position.x;
+		bb.maxX += position.x;
+		bb.minY += position.y;
+		bb.maxY += position.y;
+		return bb;
+	}
+
+	point_t OverlapAnnealer::pairSeparation(size_t a, const PartState& as, size_t b, const PartState& bs) const {
+		// the lower index is always the fixed side so that a pair gets the same answer from both ends
+		if (b < a) {
+			return -pairSeparation(b, bs, a, as);
+		}
+		const NoFitPolygon& nfp = nfps.get(partShapes[a], partShapes[b], nfps.rotationBetween(as.orientation, bs.orientation));
+		point_t way = nfp.penetrationVector(transformPoint(unrotate[partShapes[a]][as.orientation], bs.position - as.position));
+		return transformPoint(rotate[partShapes[a]][as.orientation], way);
+	}
+
+	double OverlapAnnealer::pairCost(size_t a, const PartState& as, size_t b, const PartState& bs) const {
+		return glm::length(pairSeparation(a, as, b, bs));
+	}
+
+	double OverlapAnnealer::contributions(size_t part, const PartState& state, PartGrid& grid, vector<pair<size_t, double> >& pairs) {
+		BoundingBox reach = state.bounds;
+		reach.minX -= spacing;
+		reach.minY -= spacing;
+		reach.maxX += spacing;
+		reach.maxY += spacing;
+		grid.query(reach, neighbours);
+
+		pairs.clear();
+		double sum = 0.0;
+		for (size_t other : neighbours) {
+			if (other == part) {
+				continue;
+			}
+			double cost = pairCost(part, state, other, states[other]);
+			if (cost > 0.0) {
+				pairs.push_back(make_pair(other, cost));
+				sum += cost;
+			}
+		}
+		return sum;
+	}
+
+	void OverlapAnnealer::load(const NestingResult& layout, PartGrid& grid) {
+		partShapes.clear();
+		states.clear();
+		for (const ShapePlacement& p : layout.placements) {
+			partShapes.push_back(p.shape);
+		}
+		for (size_t k = 0; k < layout.placements.size(); k++) {
+			PartState state;
+			state.orientation = layout.placements[k].orientation;
+			state.position = layout.placements[k].position;
+			state.bounds = boundsAt(k, state.orientation, state.position);
+			state.cost = 0.0;
+			states.push_back(state);
+			grid.insert(k, state.bounds);
+		}
+
+		recount(grid);
+	}
+
+	void OverlapAnnealer::recount(PartGrid& grid) {
+		totalCost = 0.0;
+		vector<pair<size_t, double> > pairs;
+		for (size_t k = 0; k < states.size(); k++) {
+			states[k].cost = contributions(k, states[k], grid, pairs);
+			totalCost += states[k].cost;
+		}
+		totalCost /= 2.0;
+	}
+
+	NestingResult OverlapAnnealer::save() const {
+		NestingResult result;
+		for (size_t k = 0; k < states.size(); k++) {
+			ShapePlacement p;
+			p.shape = partShapes[k];
+			p.orientation = states[k].orientation;
+			p.position = states[k].position;
+			result.placements.push_back(p);
+			result.length = max(result.length, (double)states[k].bounds.maxY);
+		}
+		return result;
+	}
+
+	NestingResult OverlapAnnealer::improve(const NestingResult& start, double seconds, ostream& log) {
+		auto started = chrono::steady_clock::now();
+		auto elapsed = [&]() {
+			return chrono::duration<double>(chrono::steady_clock::now() - started).count();
+		};
+
+		NestingResult best = start;
+		size_t n = start.placements.size();
+		if (n < 2) {
+			return best;
+		}
+
+		double cellSize = 0.0;
+		for (const ShapePlacement& p : start.placements) {
+			const BoundingBox& bb = shapes[p.shape].orientations[p.orientation].bounds;
+			cellSize += max(bb.width(), bb.height()) + spacing;
+		}
+		cellSize /= n;
+
+		uniform_real_distribution<double> chance(0.0, 1.0);
+		uniform_int_distribution<size_t> anyPart(0, n - 1);
+		vector<pair<size_t, double> > before, after;
+
+		double squeeze = INITIAL_SQUEEZE;
+		size_t rounds = 0, successes = 0;
+		while (elapsed() < seconds) {
+			rounds++;
+			double length = best.length * (1.0 - squeeze);
+
+			PartGrid grid(cellSize, n);
+			load(best, grid);
+
+			// push everything sticking out of the shorter sheet back in at a random height
+			bool fits = true;
+			for (size_t k = 0; k < n && fits; k++) {
+				const BoundingBox& local = shapes[partShapes[k]].orientations[states[k].orientation].bounds;
+				if (states[k].bounds.maxY <= length) {
+					continue;
+				}
+				double low = -(double)local.minY, high = length - (double)local.maxY;
+				if (high < low) {
+					fits = false;
+					break;
+				}
+				PartState moved = states[k];
+				moved.position.y = low + chance(random) * (high - low);
+				moved.bounds = boundsAt(k, moved.orientation, moved.position);
+
+				contributions(k, states[k], grid, before);
+				moved.cost = contributions(k, moved, grid, after);
+				for (auto& c : before) {
+					states[c.first].cost -= c.second;
+					totalCost -= c.second;
+				}
+				for (auto& c : after) {
+					states[c.first].cost += c.second;
+					totalCost += c.second;
+				}
+				grid.remove(k, states[k].bounds);
+				grid.insert(k, moved.bounds);
+				states[k] = moved;
+			}
+			if (!fits) {
+				if (squeeze <= MINIMUM_SQUEEZE) {
+					break;
+				}
+				squeeze = max(squeeze / 2.0, MINIMUM_SQUEEZE);
+				continue;
+			}
+
+			double temperature = max(totalCost / n, 1e-6);
+			size_t moves = MOVES_PER_PART * n;
+			double cooling = pow(1e-3, 1.0 / moves);
+
+			for (size_t move = 0; move < moves; move++) {
+				if (totalCost < RECOUNT_COST) {
+					recount(grid);
+					if (totalCost <= 0.0) {
+						break;
+					}
+				}
+				if ((move & 255) == 0 && elapsed() >= seconds) {
+					break;
+				}
+
+				// mostly work on parts which overlap something
+				size_t k = anyPart(random);
+				for (int tries = 0; tries < 8 && states[k].cost <= 0.0; tries++) {
+					k = anyPart(random);
+				}
+
+				const PartShape& shape = shapes[partShapes[k]];
+				PartState moved = states[k];
+				double size = max((double)max(shape.orientations[0].bounds.width(), shape.orientations[0].bounds.height()), spacing);
+				double progress = (double)move / moves;
+				double choice = chance(random);
+				if (states[k].cost > 0.0 && choice < SEPARATION_MOVE_CHANCE) {
+					// push the part out of everything it overlaps, with a little jitter
+					before.clear();
+					contributions(k, states[k], grid, before);
+					point_t push(0.0, 0.0);
+					for (auto& c : before) {
+						push += pairSeparation(c.first, states[c.first], k, states[k]);
+					}
+					double jitter = size * 0.05 * (1.0 - progress);
+					moved.position += push + point_t((chance(random) * 2.0 - 1.0) * jitter, (chance(random) * 2.0 - 1.0) * jitter);
+				}
+				else if (shape.orientations.size() > 1 && choice < SEPARATION_MOVE_CHANCE + ROTATION_MOVE_CHANCE) {
+					// turn around the centre of the bounding box
+					uniform_int_distribution<size_t> anyOrientation(0, shape.orientations.size() - 1);
+					moved.orientation = anyOrientation(random);
+					const BoundingBox& from = shape.orientations[states[k].orientation].bounds;
+					const BoundingBox& to = shape.orientations[moved.orientation].bounds;
+					moved.position.x += (double)((from.minX + from.maxX) - (to.minX + to.maxX)) / 2.0;
+					moved.position.y += (double)((from.minY + from.maxY) - (to.minY + to.maxY)) / 2.0;
+				}
+				else {
+					// random step, shrinking as the round goes on
+					double step = size * (0.5 - 0.48 * progress);
+					moved.position.x += (chance(random) * 2.0 - 1.0) * step;
+					moved.position.y += (chance(random) * 2.0 - 1.0) * step;
+				}
+
+				const BoundingBox& local = shape.orientations[moved.orientation].bounds;
+				double xLow = -(double)local.minX, xHigh = sheetWidth - (double)local.maxX;
+				double yLow = -(double)local.minY, yHigh = length - (double)local.maxY;
+				if (xHigh < xLow || yHigh < yLow) {
+					continue;  // this rotation does not fit the sheet
+				}
+				moved.position.x = min(max(moved.position.x, xLow), xHigh);
+				moved.position.y = min(max(moved.position.y, yLow), yHigh);
+				moved.bounds = boundsAt(k, moved.orientation, moved.position);
+
+				double oldCost = contributions(k, states[k], grid, before);
+				double newCost = contributions(k, moved, grid, after);
+				double delta = newCost - oldCost;
+
+				if (delta <= 0.0 || chance(random) < exp(-delta / temperature)) {
+					for (auto& c : before) {
+						states[c.first].cost -= c.second;
+					}
+					for (auto& c : after) {
+						states[c.first].cost += c.second;
+					}
+					grid.remove(k, states[k].bounds);
+					grid.insert(k, moved.bounds);
+					moved.cost = newCost;
+					states[k] = moved;
+					totalCost = max(0.0, totalCost + delta);
+				}
+				temperature *= cooling;
+			}
+
+			recount(grid);
+			if (totalCost <= 0.0) {
+				best = save();
+				successes++;
+			}
+			else {
+				squeeze = max(squeeze / 2.0, MINIMUM_SQUEEZE);
+			}
+		}
+
+		log << "overlap annealing: " << successes << " of " << rounds << " squeezes succeeded in " << elapsed()
+			<< "s, length " << start.length << " -> " << best.length << endl;
+		return best;
+	}
+
+}
@@ -0,0 +1,71 @@
+#ifndef _OVERLAP_ANNEALER_H_
+#define _OVERLAP_ANNEALER_H_
+
+#include <random>
+#include <unordered_map>
+
+#include "BottomLeftPlacer.hpp"
+#include "Nester.hpp"
+#include "NoFitPolygon.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// Shortens a feasible layout by squeezing it into a shorter sheet and then moving one part at a time
+	// with simulated annealing until the total penetration depth between the parts is gone again.
+	// The cost is kept up to date incrementally: a move only re-evaluates the pairs of the moved part
+	// and the parts whose bounding boxes it touches before or after the move.
+	class OverlapAnnealer {
+		struct PartState {
+			size_t orientation;
+			point_t position;
+			BoundingBox bounds;  // on the sheet
+			double cost;         // sum of the penetration depths with all other parts
+		};
+
+		// uniform hash grid over the part bounding boxes on the sheet
+		class PartGrid {
+			double cellSize;
+			unordered_map<long long, vector<size_t> > cells;
+			vector<size_t> stamps;
+			size_t stamp;
+
+			long long key(long long column, long long row) const;
+		public:
+			PartGrid(double cellSize, size_t parts);
+			void insert(size_t part, const BoundingBox& bb);
+			void remove(size_t part, const BoundingBox& bb);
+			void query(const BoundingBox& bb, vector<size_t>& found);
+		};
+
+		const vector<PartShape>& shapes;
+		NfpCache& nfps;
+		double sheetWidth;
+		double spacing;
+		mt19937 random;
+
+		vector<size_t> partShapes;
+		vector<PartState> states;
+		vector<vector<transformer_t> > rotate;    // per shape and orientation, from the fixed shape's NFP frame to the sheet
+		vector<vector<transformer_t> > unrotate;  // and back
+		double totalCost;
+		vector<size_t> neighbours;
+
+		BoundingBox boundsAt(size_t part, size_t orientation, point_t position) const;
+		// how far b has to move to get clear of a
+		point_t pairSeparation(size_t a, const PartState& as, size_t b, const PartState& bs) const;
+		double pairCost(size_t a, const PartState& as, size_t b, const PartState& bs) const;
+		// the overlapping pairs the part would have in the given state, returns their summed cost
+		double contributions(size_t part, const PartState& state, PartGrid& grid, vector<pair<size_t, double> >& pairs);
+		void recount(PartGrid& grid);
+		void load(const NestingResult& layout, PartGrid& grid);
+		NestingResult save() const;
+	public:
+		OverlapAnnealer(const vector<PartShape>& shapes, NfpCache& nfps, double sheetWidth, double spacing, unsigned seed);
+
+		NestingResult improve(const NestingResult& start, double seconds, ostream& log);
+	};
+
+}
+
+#endif
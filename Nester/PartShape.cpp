@@ -0,0 +1,152 @@
+#include <cmath>
+#include <map>
+
+#include "Geometry.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// points closer than this are merged when the outlines are converted (cm)
+	const double SHAPE_TOLERANCE = 1e-6;
+	// reflex corners of a grown outline shallower than this are filled in (cm)
+	const double SHAPE_DENT_DEPTH = 1e-3;
+
+	static polygon_t cleaned(polygon_t ring, point_t offset) {
+		cleanPolygon(ring, SHAPE_TOLERANCE);
+		makeCounterClockwise(ring);
+		for (point_t& p : ring) {
+			p -= offset;
+		}
+		return ring;
+	}
+
+	// the offset snaps its corners to a grid, which leaves shallow dents along arcs and straight edges.
+	// Filling them only grows the outline, but keeps it from being cut into many convex pieces.
+	static void fillDents(polygon_t& ring) {
+		bool changed = true;
+		while (changed && ring.size() > 3) {
+			changed = false;
+			for (size_t i = 0; i < ring.size() && ring.size() > 3; i++) {
+				point_t prev = ring[(i + ring.size() - 1) % ring.size()];
+				point_t next = ring[(i + 1) % ring.size()];
+				double turn = cross(prev, ring[i], next);
+				if (turn < 0.0 && -turn <= SHAPE_DENT_DEPTH * glm::length(next - prev)) {
+					ring.erase(ring.begin() + i);
+					changed = true;
+				}
+			}
+		}
+	}
+
+	vector<PartShape> makePartShapes(const vector<NesterPart_p>& parts, int rotations, double margin, OffsetJoin join, double tolerance) {
+		vector<PartShape> shapes;
+		map<vector<pair<long long, long long> >, size_t> knownOutlines;
+
+		if (rotations < 1) {
+			rotations = 1;
+		}
+
+		for (size_t i = 0; i < parts.size(); i++) {
+			polygon_p outline = parts[i]->toPolygon();
+			if (!outline) {
+				continue;
+			}
+
+			polygon_t outer = *outline;
+			cleanPolygon(outer, SHAPE_TOLERANCE);
+			if (outer.size() < 3) {
+				continue;
+			}
+			makeCounterClockwise(outer);
+
+			PartShape shape;
+			shape.part = i;
+			BoundingBox bb = getBoundingBox(outer);
+			shape.offset = point_t((double)bb.minX, (double)bb.minY);
+			for (point_t& p : outer) {
+				p -= shape.offset;
+			}
+			shape.area = signedArea(outer);
+
+			vector<pair<long long, long long> > key;
+			for (const point_t& p : outer) {
+				key.push_back(make_pair(llround(p.x / SHAPE_TOLERANCE), llround(p.y / SHAPE_TOLERANCE)));
+			}
+			auto known = knownOutlines.find(key);
+			if (known != knownOutlines.end()) {
+				shape.shapeId = known->second;
+			}
+			else {
+				shape.shapeId = knownOutlines.size();
+				knownOutlines[key] = shape.shapeId;
+			}
+
+			vector<polygon_t> holes;
+			for (polygon_p hole : parts[i]->toHolePolygons()) {
+				if (!hole) {
+					continue;
+				}
+				polygon_t ring = *hole;
+				cleanPolygon(ring, SHAPE_TOLERANCE);
+				if (ring.size() < 3) {
+					continue;
+				}
+				for (point_t& p : ring) {
+					p -= shape.offset;
+				}
+				holes.push_back(ring);
+			}
+
+			// offset once, turning does not change it
+			polygon_t grown = outer;
+			vector<polygon_t> shrunkHoles = holes;
+			if (margin > 0.0 || tolerance > 0.0) {
+				PartOffset_p offset = parts[i]->getOffset(margin, join, tolerance);
+				grown = cleaned(offset->outer, shape.offset);
+				fillDents(grown);
+				shrunkHoles.clear();
+				for (const polygon_t& ring : offset->holes) {
+					polygon_t hole = cleaned(ring, shape.offset);
+					if (hole.size() >= 3) {
+						shrunkHoles.push_back(hole);
+					}
+				}
+			}
+			if (grown.size() < 3) {
+				grown = outer;
+			}
+
+			vector<polygon_t> pieces = convexDecomposition(grown);
+			shape.upright = minimumAreaAngle(outer);
+			for (int r = 0; r < rotations; r++) {
+				OrientedShape oriented;
+				oriented.angle = shape.upright + r * 360.0 / rotations;
+				transformer_t rotation = makeTransformation(oriented.angle, 0.0, 0.0);
+				oriented.outer = transformPolygon(outer, rotation);
+				for (const polygon_t& hole : holes) {
+					oriented.holes.push_back(transformPolygon(hole, rotation));
+				}
+				oriented.bounds = getBoundingBox(oriented.outer);
+				oriented.grown = transformPolygon(grown, rotation);
+				for (const polygon_t& piece : pieces) {
+					oriented.pieces.push_back(transformPolygon(piece, rotation));
+				}
+				oriented.grownBounds = getBoundingBox(oriented.grown);
+				for (const polygon_t& hole : shrunkHoles) {
+					oriented.shrunkHoles.push_back(transformPolygon(hole, rotation));
+				}
+				shape.orientations.push_back(oriented);
+			}
+
+			shapes.push_back(shape);
+		}
+
+		return shapes;
+	}
+
+	transformer_t placementTransformer(const PartShape& shape, size_t orientation, point_t position) {
+		transformer_t transformer = makeTransformation(shape.orientations[orientation].angle, position.x, position.y);
+		return glm::translate(transformer, -shape.offset);
+	}
+
+}
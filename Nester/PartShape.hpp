@@ -0,0 +1,42 @@
+#ifndef _PART_SHAPE_H_
+#define _PART_SHAPE_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// The outline of a part in one of its allowed rotations, as seen by the nesting engines
+	struct OrientedShape {
+		double angle;
+		polygon_t outer;           // counter clockwise
+		vector<polygon_t> holes;
+		BoundingBox bounds;
+		// Grown by the margin every part keeps, so parts are far enough apart when these do not overlap.
+		// The no-fit polygons are built from them.
+		polygon_t grown;
+		vector<polygon_t> pieces;  // convex decomposition of grown
+		BoundingBox grownBounds;
+		vector<polygon_t> shrunkHoles;  // counter clockwise, the room other parts have inside the holes
+	};
+
+	struct PartShape {
+		size_t part;      // index into the parts handed to makePartShapes
+		size_t shapeId;   // parts with identical outlines share an id and thereby their no-fit polygons
+		point_t offset;   // the outline is translated by -offset so that it starts at the origin
+		double area;
+		double upright;   // the turn which gives the outline its smallest bounding box, the first orientation
+		vector<OrientedShape> orientations;
+	};
+
+	// Parts without a usable outer ring are left out. The outlines are grown and the holes shrunk by
+	// margin, half the distance between parts. With a tolerance the grown outlines are coarser, but still
+	// hold the parts.
+	vector<PartShape> makePartShapes(const vector<NesterPart_p>& parts, int rotations, double margin = 0.0, OffsetJoin join = JOIN_ROUND,
+		double tolerance = 0.0);
+
+	// the transformation which moves the original part geometry to the given orientation and position
+	transformer_t placementTransformer(const PartShape& shape, size_t orientation, point_t position);
+
+}
+
+#endif
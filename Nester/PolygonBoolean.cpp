@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+
+#include "Geometry.hpp"
+#include "PolygonBoolean.hpp"
+
+namespace nester {
+
+	bool toFixed(point_t p, IntPoint& fixed) {
+		double limit = (double)(BOOLEAN_RANGE - 1);
+		double x = p.x * BOOLEAN_SCALE, y = p.y * BOOLEAN_SCALE;
+		bool inRange = fabs(x) <= limit && fabs(y) <= limit;
+		fixed.x = llround(max(-limit, min(limit, x)));
+		fixed.y = llround(max(-limit, min(limit, y)));
+		return inRange;
+	}
+
+	point_t fromFixed(IntPoint p) {
+		return point_t((double)p.x / BOOLEAN_SCALE, (double)p.y / BOOLEAN_SCALE);
+	}
+
+	// z component of (a - o) x (b - o), exact for points within BOOLEAN_RANGE
+	static long long orient(IntPoint o, IntPoint a, IntPoint b) {
+		return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+	}
+
+	static int sign(long long v) {
+		return (v > 0) - (v < 0);
+	}
+
+	namespace {
+
+		// An edge from its smaller to its larger end point in the sweep order. winding is +1 per operand
+		// for edges of rings running in that direction and -1 for those running back, summed when edges
+		// of several rings coincide.
+		struct Segment {
+			IntPoint left, right;
+			int windingA, windingB;
+			int belowA, belowB;  // winding numbers just below the edge
+		};
+
+		// Orders segments which are in the sweep line at the same time by height. Segments only meet at
+		// end points, so checking one end point against the other segment is enough.
+		struct SegmentBelow {
+			const vector<Segment>* segments;
+
+			bool operator()(size_t i, size_t j) const {
+				if (i == j) {
+					return false;
+				}
+				const Segment& e = (*segments)[i];
+				const Segment& f = (*segments)[j];
+				if (!(f.left < e.left)) {
+					int s = sign(orient(e.left, e.right, f.left));
+					if (s == 0) {
+						s = sign(orient(e.left, e.right, f.right));
+					}
+					return s != 0 ? s > 0 : i < j;
+				}
+				int s = sign(orient(f.left, f.right, e.left));
+				if (s == 0) {
+					s = sign(orient(f.left, f.right, e.right));
+				}
+				return s != 0 ? s < 0 : i < j;
+			}
+		};
+
+		struct DirectedEdge {
+			IntPoint from, to;
+		};
+
+	}
+
+	static bool inside(int windingA, int windingB, BooleanOperation operation, FillRule rule) {
+		bool inA = rule == FILL_POSITIVE ? windingA > 0 : windingA != 0;
+		bool inB = rule == FILL_POSITIVE ? windingB > 0 : windingB != 0;
+		switch (operation) {
+		case BOOLEAN_UNION:
+			return inA || inB;
+		case BOOLEAN_INTERSECTION:
+			return inA && inB;
+		default:
+			return inA && !inB;
+		}
+	}
+
+	static void addRings(const vector<int_polygon_t>& rings, bool first, vector<Segment>& segments) {
+		for (const int_polygon_t& ring : rings) {
+			for (size_t i = 0, n = ring.size(); i < n; i++) {
+				IntPoint p = ring[i];
+				IntPoint q = ring[(i + 1) % n];
+				if (p == q) {
+					continue;
+				}
+				int winding = p < q ? 1 : -1;
+				Segment segment = { min(p, q), max(p, q), first ? winding : 0, first ? 0 : winding, 0, 0 };
+				segments.push_back(segment);
+			}
+		}
+	}
+
+	// p lies on the segment between its end points
+	static bool strictlyOn(const Segment& s, IntPoint p) {
+		return s.left < p && p < s.right && orient(s.left, s.right, p) == 0;
+	}
+
+	// Calls visit(i, j) for the pairs of segments whose bounding boxes overlap, sweeping over x with the
+	// segments whose x range covers the sweep position. The segments are sorted by their left end point.
+	template <typename Visitor>
+	static void overlappingPairs(const vector<Segment>& segments, Visitor visit) {
+		vector<size_t> active;
+		for (size_t i = 0; i < segments.size(); i++) {
+			const Segment& s = segments[i];
+			size_t kept = 0;
+			for (size_t j : active) {
+				if (segments[j].right.x >= s.left.x) {
+					active[kept++] = j;
+				}
+			}
+			active.resize(kept);
+			long long minY = min(s.left.y, s.right.y);
+			long long maxY = max(s.left.y, s.right.y);
+			for (size_t j : active) {
+				const Segment& t = segments[j];
+				if (max(t.left.y, t.right.y) >= minY && min(t.left.y, t.right.y) <= maxY) {
+					visit(i, j);
+				}
+			}
+			active.push_back(i);
+		}
+	}
+
+	// where s and t cross away from their end points, rounded to the grid
+	static bool crossing(const Segment& s, const Segment& t, IntPoint& p) {
+		long long o1 = orient(s.left, s.right, t.left);
+		long long o2 = orient(s.left, s.right, t.right);
+		long long o3 = orient(t.left, t.right, s.left);
+		long long o4 = orient(t.left, t.right, s.right);
+		if (sign(o1) * sign(o2) >= 0 || sign(o3) * sign(o4) >= 0) {
+			return false;
+		}
+		double u = (double)o3 / (double)(o3 - o4);
+		p.x = s.left.x + llround(u * (double)(s.right.x - s.left.x));
+		p.y = s.left.y + llround(u * (double)(s.right.y - s.left.y));
+		return true;
+	}
+
+	// Whether s passes through the pixel of the grid point h: the unit square around it, nudged down and
+	// to the left by amounts too small to matter except on its boundary. That makes the pixels tile the
+	// plane without sharing any boundary a segment could run along or through a corner of.
+	static bool passesThrough(const Segment& s, IntPoint h) {
+		// doubled coordinates put the corners of the pixel on the grid
+		IntPoint a = { 2 * s.left.x, 2 * s.left.y };
+		IntPoint b = { 2 * s.right.x, 2 * s.right.y };
+		long long x0 = 2 * h.x - 1, x1 = 2 * h.x + 1;
+		long long y0 = 2 * h.y - 1, y1 = 2 * h.y + 1;
+		if (max(a.x, b.x) < x0 || min(a.x, b.x) >= x1 || max(a.y, b.y) < y0 || min(a.y, b.y) >= y1) {
+			return false;
+		}
+		// the side of the nudged corners: moved by (-e, -e * e) for a vanishing e
+		long long dx = b.x - a.x, dy = b.y - a.y;
+		int tie = dy != 0 ? sign(dy) : -sign(dx);
+		int sides = 0;
+		IntPoint corners[4] = { { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 } };
+		for (const IntPoint& c : corners) {
+			int side = sign(orient(a, b, c));
+			sides += side != 0 ? side : tie;
+		}
+		return sides != 4 && sides != -4;
+	}
+
+	// Snap rounding: the pixels around all end points and all rounded crossings are hot, and every
+	// segment is routed through the centres of the hot pixels it passes. Unlike rounding the crossings
+	// alone, this makes no new crossings.
+	static void snapRound(vector<Segment>& segments) {
+		sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) { return a.left < b.left; });
+		vector<IntPoint> hot;
+		for (const Segment& s : segments) {
+			hot.push_back(s.left);
+			hot.push_back(s.right);
+		}
+		overlappingPairs(segments, [&](size_t i, size_t j) {
+			IntPoint p;
+			if (crossing(segments[i], segments[j], p)) {
+				hot.push_back(p);
+			}
+		});
+		sort(hot.begin(), hot.end());
+		hot.erase(unique(hot.begin(), hot.end()), hot.end());
+
+		vector<Segment> pieces;
+		vector<pair<long long, IntPoint> > passed;
+		for (const Segment& s : segments) {
+			passed.clear();
+			long long minY = min(s.left.y, s.right.y);
+			long long maxY = max(s.left.y, s.right.y);
+			IntPoint from = { s.left.x - 1, numeric_limits<long long>::min() };
+			for (auto it = lower_bound(hot.begin(), hot.end(), from); it != hot.end() && it->x <= s.right.x + 1; ++it) {
+				if (it->y >= minY - 1 && it->y <= maxY + 1 && passesThrough(s, *it)) {
+					long long along = (it->x - s.left.x) * (s.right.x - s.left.x) + (it->y - s.left.y) * (s.right.y - s.left.y);
+					passed.push_back(make_pair(along, *it));
+				}
+			}
+			sort(passed.begin(), passed.end(), [](const pair<long long, IntPoint>& a, const pair<long long, IntPoint>& b) {
+				return a.first < b.first;
+			});
+			for (size_t k = 0; k + 1 < passed.size(); k++) {
+				IntPoint p = passed[k].second;
+				IntPoint q = passed[k + 1].second;
+				Segment piece = s;
+				piece.left = min(p, q);
+				piece.right = max(p, q);
+				if (!(p < q)) {
+					piece.windingA = -s.windingA;
+					piece.windingB = -s.windingB;
+				}
+				pieces.push_back(piece);
+			}
+		}
+		segments.swap(pieces);
+	}
+
+	// Cuts the segments at the end points of others lying on them, which also splits up collinear
+	// overlaps. Returns false when there was nothing to cut.
+	static bool cutAtEndPoints(vector<Segment>& segments) {
+		sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) { return a.left < b.left; });
+		vector<vector<IntPoint> > cuts(segments.size());
+		bool cut = false;
+		overlappingPairs(segments, [&](size_t i, size_t j) {
+			const Segment& s = segments[i];
+			const Segment& t = segments[j];
+			for (IntPoint p : { t.left, t.right }) {
+				if (strictlyOn(s, p)) {
+					cuts[i].push_back(p);
+					cut = true;
+				}
+			}
+			for (IntPoint p : { s.left, s.right }) {
+				if (strictlyOn(t, p)) {
+					cuts[j].push_back(p);
+					cut = true;
+				}
+			}
+		});
+		if (!cut) {
+			return false;
+		}
+
+		vector<Segment> pieces;
+		for (size_t i = 0; i < segments.size(); i++) {
+			vector<IntPoint>& points = cuts[i];
+			points.push_back(segments[i].left);
+			points.push_back(segments[i].right);
+			sort(points.begin(), points.end());
+			points.erase(unique(points.begin(), points.end()), points.end());
+			for (size_t k = 0; k + 1 < points.size(); k++) {
+				Segment piece = segments[i];
+				piece.left = points[k];
+				piece.right = points[k + 1];
+				pieces.push_back(piece);
+			}
+		}
+		segments.swap(pieces);
+		return true;
+	}
+
+	// sums the windings of coincident segments and drops those which cancel out
+	static void mergeSegments(vector<Segment>& segments) {
+		sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+			return a.left < b.left || (a.left == b.left && a.right < b.right);
+		});
+		vector<Segment> merged;
+		for (const Segment& s : segments) {
+			if (!merged.empty() && merged.back().left == s.left && merged.back().right == s.right) {
+				merged.back().windingA += s.windingA;
+				merged.back().windingB += s.windingB;
+			}
+			else {
+				merged.push_back(s);
+			}
+		}
+		segments.clear();
+		for (const Segment& s : merged) {
+			if (s.windingA != 0 || s.windingB != 0) {
+				segments.push_back(s);
+			}
+		}
+	}
+
+	// the winding numbers below each segment from the segment below it in the sweep line
+	static void sweepWindings(vector<Segment>& segments) {
+		// segments come sorted by their left end point
+		vector<size_t> byRight(segments.size());
+		for (size_t i = 0; i < segments.size(); i++) {
+			byRight[i] = i;
+		}
+		sort(byRight.begin(), byRight.end(), [&](size_t a, size_t b) { return segments[a].right < segments[b].right; });
+
+		SegmentBelow below = { &segments };
+		set<size_t, SegmentBelow> line(below);
+		vector<set<size_t, SegmentBelow>::iterator> positions(segments.size());
+		size_t next = 0, removed = 0;
+		while (next < segments.size()) {
+			IntPoint p = segments[next].left;
+			while (removed < byRight.size() && !(p < segments[byRight[removed]].right)) {
+				line.erase(positions[byRight[removed]]);
+				removed++;
+			}
+
+			size_t first = next;
+			while (next < segments.size() && segments[next].left == p) {
+				next++;
+			}
+			vector<size_t> starting;
+			for (size_t i = first; i < next; i++) {
+				starting.push_back(i);
+			}
+			sort(starting.begin(), starting.end(), below);
+			for (size_t i : starting) {
+				set<size_t, SegmentBelow>::iterator position = line.insert(i).first;
+				positions[i] = position;
+				Segment& s = segments[i];
+				s.belowA = 0;
+				s.belowB = 0;
+				if (position != line.begin()) {
+					const Segment& under = segments[*prev(position)];
+					s.belowA = under.belowA + under.windingA;
+					s.belowB = under.belowB + under.windingB;
+				}
+			}
+		}
+	}
+
+	// the directions leaving a point, sorted clockwise starting from reference
+	static bool clockwiseBefore(IntPoint reference, IntPoint d1, IntPoint d2) {
+		IntPoint origin = { 0, 0 };
+		long long c1 = orient(origin, reference, d1);
+		long long c2 = orient(origin, reference, d2);
+		long long dot1 = reference.x * d1.x + reference.y * d1.y;
+		long long dot2 = reference.x * d2.x + reference.y * d2.y;
+		int half1 = c1 < 0 || (c1 == 0 && dot1 > 0) ? 0 : 1;
+		int half2 = c2 < 0 || (c2 == 0 && dot2 > 0) ? 0 : 1;
+		if (half1 != half2) {
+			return half1 < half2;
+		}
+		return orient(origin, d1, d2) < 0;
+	}
+
+	static void removeCollinear(int_polygon_t& ring) {
+		bool changed = true;
+		while (changed && ring.size() > 2) {
+			changed = false;
+			int_polygon_t kept;
+			size_t n = ring.size();
+			for (size_t i = 0; i < n; i++) {
+				if (orient(ring[(i + n - 1) % n], ring[i], ring[(i + 1) % n]) != 0) {
+					kept.push_back(ring[i]);
+				}
+			}
+			changed = kept.size() != ring.size();
+			ring.swap(kept);
+		}
+	}
+
+	// Links the edges into rings. Where rings touch at a point the one turning left most is followed,
+	// which keeps touching outlines apart.
+	static vector<int_polygon_t> linkEdges(const vector<DirectedEdge>& edges) {
+		multimap<IntPoint, size_t> leaving;
+		for (size_t i = 0; i < edges.size(); i++) {
+			leaving.insert(make_pair(edges[i].from, i));
+		}
+
+		vector<bool> used(edges.size(), false);
+		vector<int_polygon_t> rings;
+		for (size_t start = 0; start < edges.size(); start++) {
+			if (used[start]) {
+				continue;
+			}
+			int_polygon_t ring;
+			size_t current = start;
+			bool closed = false;
+			while (true) {
+				used[current] = true;
+				ring.push_back(edges[current].from);
+				IntPoint at = edges[current].to;
+				if (at == edges[start].from) {
+					closed = true;
+					break;
+				}
+				IntPoint back = { edges[current].from.x - at.x, edges[current].from.y - at.y };
+				size_t best = numeric_limits<size_t>::max();
+				IntPoint bestDirection = { 0, 0 };
+				auto range = leaving.equal_range(at);
+				for (auto it = range.first; it != range.second; ++it) {
+					if (used[it->second]) {
+						continue;
+					}
+					IntPoint direction = { edges[it->second].to.x - at.x, edges[it->second].to.y - at.y };
+					if (best == numeric_limits<size_t>::max() || clockwiseBefore(back, direction, bestDirection)) {
+						best = it->second;
+						bestDirection = direction;
+					}
+				}
+				if (best == numeric_limits<size_t>::max()) {
+					break;
+				}
+				current = best;
+			}
+			if (closed) {
+				removeCollinear(ring);
+				if (ring.size() > 2) {
+					rings.push_back(ring);
+				}
+			}
+		}
+		return rings;
+	}
+
+	vector<int_polygon_t> booleanOperation(const vector<int_polygon_t>& a, const vector<int_polygon_t>& b, BooleanOperation operation,
+		FillRule rule) {
+		vector<Segment> segments;
+		addRings(a, true, segments);
+		addRings(b, false, segments);
+		snapRound(segments);
+		// a snapped segment can still run through a vertex without the other segments there crossing it
+		while (cutAtEndPoints(segments)) {
+		}
+		mergeSegments(segments);
+		sweepWindings(segments);
+
+		// the result lies to the left of its edges
+		vector<DirectedEdge> edges;
+		for (const Segment& s : segments) {
+			bool under = inside(s.belowA, s.belowB, operation, rule);
+			bool over = inside(s.belowA + s.windingA, s.belowB + s.windingB, operation, rule);
+			if (under == over) {
+				continue;
+			}
+			DirectedEdge edge = { over ? s.left : s.right, over ? s.right : s.left };
+			edges.push_back(edge);
+		}
+		return linkEdges(edges);
+	}
+
+	static bool toFixed(const vector<polygon_t>& rings, vector<int_polygon_t>& result) {
+		bool inRange = true;
+		for (const polygon_t& ring : rings) {
+			int_polygon_t fixed(ring.size());
+			for (size_t k = 0; k < ring.size(); k++) {
+				inRange = toFixed(ring[k], fixed[k]) && inRange;
+			}
+			result.push_back(fixed);
+		}
+		return inRange;
+	}
+
+	vector<polygon_t> booleanOperation(const vector<polygon_t>& a, const vector<polygon_t>& b, BooleanOperation operation,
+		FillRule rule) {
+		vector<polygon_t> result;
+		vector<int_polygon_t> fixedA, fixedB;
+		if (!toFixed(a, fixedA) || !toFixed(b, fixedB)) {
+			// the cross products would overflow, no answer is better than a wrong one
+			return result;
+		}
+		for (const int_polygon_t& ring : booleanOperation(fixedA, fixedB, operation, rule)) {
+			polygon_t points;
+			for (const IntPoint& p : ring) {
+				points.push_back(fromFixed(p));
+			}
+			result.push_back(points);
+		}
+		return result;
+	}
+
+	double overlapArea(const vector<polygon_t>& a, const vector<polygon_t>& b) {
+		double area = 0.0;
+		for (const polygon_t& ring : booleanOperation(a, b, BOOLEAN_INTERSECTION)) {
+			area += signedArea(ring);
+		}
+		return area;
+	}
+
+}
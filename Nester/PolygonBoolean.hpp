@@ -0,0 +1,67 @@
+#ifndef _POLYGON_BOOLEAN_H_
+#define _POLYGON_BOOLEAN_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// A point on the fixed-point grid the boolean operations work on
+	struct IntPoint {
+		long long x, y;
+
+		bool operator==(const IntPoint& other) const {
+			return x == other.x && y == other.y;
+		}
+
+		bool operator!=(const IntPoint& other) const {
+			return !(*this == other);
+		}
+
+		// the sweep order: by x, then by y
+		bool operator<(const IntPoint& other) const {
+			return x < other.x || (x == other.x && y < other.y);
+		}
+	};
+
+	typedef vector<IntPoint> int_polygon_t;
+
+	// grid points per cm
+	const double BOOLEAN_SCALE = 1e4;
+	// coordinates on the grid must stay below this in magnitude (about 260 m) so cross products fit in 64 bits
+	const long long BOOLEAN_RANGE = 1LL << 28;
+
+	enum BooleanOperation {
+		BOOLEAN_UNION,
+		BOOLEAN_INTERSECTION,
+		BOOLEAN_DIFFERENCE  // the first operand without the second
+	};
+
+	// which winding numbers count as inside an operand
+	enum FillRule {
+		FILL_NONZERO,
+		FILL_POSITIVE  // only counter clockwise winding, what offsetting needs
+	};
+
+	// false when p lies beyond BOOLEAN_RANGE, it is then clamped to the range
+	bool toFixed(point_t p, IntPoint& fixed);
+	point_t fromFixed(IntPoint p);
+
+	// Union, intersection or difference of two sets of rings. The rings of an operand may have any
+	// orientation and overlap each other, a point belongs to the operand when they wind around it a
+	// nonzero number of times, or with FILL_POSITIVE a positive number of times; so counter clockwise
+	// outlines with clockwise holes work as expected.
+	// The edges are snap rounded at all their intersections, and a sweep line over the cut edges finds
+	// the winding numbers of both operands on either side of every edge. The edges where the result
+	// changes are linked into counter clockwise outer rings and clockwise holes. All predicates are
+	// exact on the grid. Rings in cm with a corner beyond BOOLEAN_RANGE give an empty result.
+	vector<int_polygon_t> booleanOperation(const vector<int_polygon_t>& a, const vector<int_polygon_t>& b, BooleanOperation operation,
+		FillRule rule = FILL_NONZERO);
+	vector<polygon_t> booleanOperation(const vector<polygon_t>& a, const vector<polygon_t>& b, BooleanOperation operation,
+		FillRule rule = FILL_NONZERO);
+
+	// the area covered by both sets of rings
+	double overlapArea(const vector<polygon_t>& a, const vector<polygon_t>& b);
+
+}
+
+#endif
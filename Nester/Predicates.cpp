@@ -0,0 +1,212 @@
+#include <cmath>
+
+#include "Predicates.hpp"
+
+namespace nester {
+
+	// half an ulp of 1, the relative rounding error of one operation
+	const double PREDICATE_EPSILON = 1.1102230246251565e-16;
+	// relative error bounds of the floating point determinants
+	const double ORIENT_ERROR_BOUND = (3.0 + 16.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+	const double INCIRCLE_ERROR_BOUND = (10.0 + 96.0 * PREDICATE_EPSILON) * PREDICATE_EPSILON;
+
+	namespace {
+
+		// A number as a sum of doubles which do not overlap, from the smallest magnitude up. Zero components
+		// are left out, so the last one has the sign of the sum.
+		typedef vector<double> Expansion;
+
+		// x + y == a + b exactly
+		void twoSum(double a, double b, double& x, double& y) {
+			x = a + b;
+			double bv = x - a;
+			double av = x - bv;
+			y = (a - av) + (b - bv);
+		}
+
+		// x + y == a * b exactly
+		void twoProduct(double a, double b, double& x, double& y) {
+			x = a * b;
+			y = fma(a, b, -x);
+		}
+
+		Expansion difference(double a, double b) {
+			double x, y;
+			twoSum(a, -b, x, y);
+			Expansion e;
+			if (y != 0.0) {
+				e.push_back(y);
+			}
+			if (x != 0.0) {
+				e.push_back(x);
+			}
+			return e;
+		}
+
+		Expansion product(double a, double b) {
+			double x, y;
+			twoProduct(a, b, x, y);
+			Expansion e;
+			if (y != 0.0) {
+				e.push_back(y);
+			}
+			if (x != 0.0) {
+				e.push_back(x);
+			}
+			return e;
+		}
+
+		// adds one double to an expansion
+		Expansion grow(const Expansion& e, double b) {
+			Expansion h;
+			double q = b;
+			for (double component : e) {
+				double sum, error;
+				twoSum(q, component, sum, error);
+				if (error != 0.0) {
+					h.push_back(error);
+				}
+				q = sum;
+			}
+			if (q != 0.0) {
+				h.push_back(q);
+			}
+			return h;
+		}
+
+		Expansion add(const Expansion& e, const Expansion& f) {
+			Expansion h = e;
+			for (double component : f) {
+				h = grow(h, component);
+			}
+			return h;
+		}
+
+		Expansion negate(Expansion e) {
+			for (double& component : e) {
+				component = -component;
+			}
+			return e;
+		}
+
+		Expansion scale(const Expansion& e, double b) {
+			Expansion h;
+			for (double component : e) {
+				h = add(h, product(component, b));
+			}
+			return h;
+		}
+
+		Expansion multiply(const Expansion& e, const Expansion& f) {
+			Expansion h;
+			for (double component : f) {
+				h = add(h, scale(e, component));
+			}
+			return h;
+		}
+
+		double estimate(const Expansion& e) {
+			return e.empty() ? 0.0 : e.back();
+		}
+
+		double orient2dExact(point_t a, point_t b, point_t c) {
+			// (ax - cx)(by - cy) - (ay - cy)(bx - cx) multiplied out, cx * cy cancels
+			Expansion det = product(a.x, b.y);
+			det = add(det, product(-a.x, c.y));
+			det = add(det, product(-c.x, b.y));
+			det = add(det, product(-a.y, b.x));
+			det = add(det, product(a.y, c.x));
+			det = add(det, product(c.y, b.x));
+			return estimate(det);
+		}
+
+		double incircleExact(point_t a, point_t b, point_t c, point_t d) {
+			Expansion adx = difference(a.x, d.x), ady = difference(a.y, d.y);
+			Expansion bdx = difference(b.x, d.x), bdy = difference(b.y, d.y);
+			Expansion cdx = difference(c.x, d.x), cdy = difference(c.y, d.y);
+			Expansion alift = add(multiply(adx, adx), multiply(ady, ady));
+			Expansion blift = add(multiply(bdx, bdx), multiply(bdy, bdy));
+			Expansion clift = add(multiply(cdx, cdx), multiply(cdy, cdy));
+			Expansion bc = add(multiply(bdx, cdy), negate(multiply(cdx, bdy)));
+			Expansion ca = add(multiply(cdx, ady), negate(multiply(adx, cdy)));
+			Expansion ab = add(multiply(adx, bdy), negate(multiply(bdx, ady)));
+			Expansion det = add(add(multiply(alift, bc), multiply(blift, ca)), multiply(clift, ab));
+			return estimate(det);
+		}
+
+	}
+
+	double orient2d(point_t a, point_t b, point_t c) {
+		double left = (a.x - c.x) * (b.y - c.y);
+		double right = (a.y - c.y) * (b.x - c.x);
+		double det = left - right;
+
+		// both products with the same sign is the only way to lose the sign to rounding
+		double sum;
+		if (left > 0.0) {
+			if (right <= 0.0) {
+				return det;
+			}
+			sum = left + right;
+		}
+		else if (left < 0.0) {
+			if (right >= 0.0) {
+				return det;
+			}
+			sum = -left - right;
+		}
+		else {
+			return det;
+		}
+
+		double bound = ORIENT_ERROR_BOUND * sum;
+		if (det >= bound || -det >= bound) {
+			return det;
+		}
+		return orient2dExact(a, b, c);
+	}
+
+	double incircle(point_t a, point_t b, point_t c, point_t d) {
+		double adx = a.x - d.x, ady = a.y - d.y;
+		double bdx = b.x - d.x, bdy = b.y - d.y;
+		double cdx = c.x - d.x, cdy = c.y - d.y;
+
+		double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+		double cdxady = cdx * ady, adxcdy = adx * cdy;
+		double adxbdy = adx * bdy, bdxady = bdx * ady;
+		double alift = adx * adx + ady * ady;
+		double blift = bdx * bdx + bdy * bdy;
+		double clift = cdx * cdx + cdy * cdy;
+		double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+
+		double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift + (fabs(cdxady) + fabs(adxcdy)) * blift +
+			(fabs(adxbdy) + fabs(bdxady)) * clift;
+		double bound = INCIRCLE_ERROR_BOUND * permanent;
+		if (det > bound || -det > bound) {
+			return det;
+		}
+		return incircleExact(a, b, c, d);
+	}
+
+	bool segmentsCross(point_t a1, point_t a2, point_t b1, point_t b2) {
+		double c1 = orient2d(a1, a2, b1), c2 = orient2d(a1, a2, b2);
+		double c3 = orient2d(b1, b2, a1), c4 = orient2d(b1, b2, a2);
+		return ((c1 > 0.0 && c2 < 0.0) || (c1 < 0.0 && c2 > 0.0)) && ((c3 > 0.0 && c4 < 0.0) || (c3 < 0.0 && c4 > 0.0));
+	}
+
+	// p is known to lie on the line through a and b
+	static bool withinBox(point_t a, point_t b, point_t p) {
+		return min(a.x, b.x) <= p.x && p.x <= max(a.x, b.x) && min(a.y, b.y) <= p.y && p.y <= max(a.y, b.y);
+	}
+
+	bool segmentsIntersect(point_t a1, point_t a2, point_t b1, point_t b2) {
+		double c1 = orient2d(a1, a2, b1), c2 = orient2d(a1, a2, b2);
+		double c3 = orient2d(b1, b2, a1), c4 = orient2d(b1, b2, a2);
+		if (((c1 > 0.0 && c2 < 0.0) || (c1 < 0.0 && c2 > 0.0)) && ((c3 > 0.0 && c4 < 0.0) || (c3 < 0.0 && c4 > 0.0))) {
+			return true;
+		}
+		return (c1 == 0.0 && withinBox(a1, a2, b1)) || (c2 == 0.0 && withinBox(a1, a2, b2)) ||
+			(c3 == 0.0 && withinBox(b1, b2, a1)) || (c4 == 0.0 && withinBox(b1, b2, a2));
+	}
+
+}
@@ -0,0 +1,24 @@
+#ifndef _PREDICATES_H_
+#define _PREDICATES_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// Shewchuk's adaptive predicates: the sign of the result is always exact, the value only roughly
+	// the determinant. Plain floating point decides unless the result is within its rounding error of
+	// zero, only then the determinant is summed up exactly from error free products.
+
+	// positive when a, b, c turn counter clockwise, 0 when they are collinear
+	double orient2d(point_t a, point_t b, point_t c);
+	// positive when d lies inside the circle through the counter clockwise a, b, c, 0 when on it
+	double incircle(point_t a, point_t b, point_t c, point_t d);
+
+	// true when the segments cross at a point inside both of them
+	bool segmentsCross(point_t a1, point_t a2, point_t b1, point_t b2);
+	// true when the closed segments share at least one point
+	bool segmentsIntersect(point_t a1, point_t a2, point_t b1, point_t b2);
+
+}
+
+#endif
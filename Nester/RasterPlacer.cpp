@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+
+#include "RasterPlacer.hpp"
+
+namespace nester {
+
+	// keeps exact multiples of the resolution from rounding up to an extra cell
+	const double RASTER_EPSILON = 1e-9;
+
+	static size_t cellsFor(double length, double resolution) {
+		return max((size_t)1, (size_t)ceil(length / resolution - RASTER_EPSILON));
+	}
+
+	RasterPlacer::RasterPlacer(const vector<PartShape>& shapes, double sheetWidth, double spacing, double resolution) :
+		shapes(shapes), sheetWidth(sheetWidth), resolution(resolution) {
+		margin = spacing > 0.0 ? (size_t)ceil(spacing / 2.0 / resolution - RASTER_EPSILON) : 0;
+
+		for (const PartShape& shape : shapes) {
+			masks.push_back(vector<Mask>());
+			for (const OrientedShape& oriented : shape.orientations) {
+				const BoundingBox& bb = oriented.bounds;
+				Mask mask;
+				mask.columns = cellsFor((double)bb.width(), resolution);
+				Bitboard cells = rasterize(oriented.outer, oriented.holes, point_t((double)bb.minX, (double)bb.minY), resolution,
+					mask.columns, cellsFor((double)bb.height(), resolution));
+				mask.cells = cells.dilated(margin);
+
+				for (size_t r = 0; r < mask.cells.height(); r++) {
+					mask.runs.push_back(vector<pair<size_t, size_t> >());
+					mask.widest.push_back(0);
+					size_t c = 0;
+					while (c < mask.cells.width()) {
+						if (!mask.cells.get(c, r)) {
+							c++;
+							continue;
+						}
+						size_t end = c;
+						while (end < mask.cells.width() && mask.cells.get(end, r)) {
+							end++;
+						}
+						mask.runs.back().push_back(make_pair(c, end - c));
+						mask.widest.back() = max(mask.widest.back(), end - c);
+						c = end;
+					}
+				}
+				mask.narrowest = *min_element(mask.widest.begin(), mask.widest.end());
+				masks.back().push_back(mask);
+			}
+		}
+	}
+
+	static size_t longestGap(const Bitboard& cells, size_t r) {
+		const uint64_t* row = cells.row(r);
+		size_t longest = 0, current = 0;
+		for (size_t k = 0; k < cells.rowWords(); k++) {
+			size_t bits = min((size_t)64, cells.width() - k * 64);
+			if (row[k] == 0) {
+				current += bits;
+				continue;
+			}
+			for (size_t b = 0; b < bits; b++) {
+				if ((row[k] >> b) & 1) {
+					longest = max(longest, current);
+					current = 0;
+				}
+				else {
+					current++;
+				}
+			}
+		}
+		return max(longest, current);
+	}
+
+	RasterPlacer::Sheet::Sheet(size_t columns) : levels(1), cells(columns, 0), filled(0) {
+		while (((size_t)1 << levels) <= columns) {
+			levels++;
+		}
+	}
+
+	void RasterPlacer::Sheet::grow(size_t rows) {
+		if (cells.height() >= rows) {
+			return;
+		}
+		// new rows are empty and so are their smears
+		cells.addRows(rows - cells.height());
+		gaps.resize(rows, cells.width());
+		smears.resize(rows * levels * cells.rowWords(), 0);
+		smeared.resize(rows, true);
+	}
+
+	const uint64_t* RasterPlacer::Sheet::smear(size_t r, size_t level) {
+		if (level == 0) {
+			return cells.row(r);
+		}
+		size_t words = cells.rowWords();
+		uint64_t* base = smears.data() + r * levels * words;
+		if (!smeared[r]) {
+			copy(cells.row(r), cells.row(r) + words, base);
+			for (size_t l = 1; l < levels; l++) {
+				copy(base + (l - 1) * words, base + l * words, base + l * words);
+				orShiftedRight(base + l * words, words, base + l * words, words, (size_t)1 << (l - 1));
+			}
+			smeared[r] = true;
+		}
+		return base + level * words;
+	}
+
+	void RasterPlacer::Sheet::stamp(const Mask& mask, size_t column, size_t r, const Bitboard& usable) {
+		grow(r + mask.cells.height());
+		cells.stamp(mask.cells, column, r);
+		for (size_t i = r; i < r + mask.cells.height(); i++) {
+			gaps[i] = longestGap(cells, i);
+			smeared[i] = false;
+		}
+
+		while (filled < cells.height()) {
+			const uint64_t* row = cells.row(filled);
+			for (size_t k = 0; k < cells.rowWords(); k++) {
+				if ((row[k] & usable.row(0)[k]) != usable.row(0)[k]) {
+					return;
+				}
+			}
+			filled++;
+		}
+	}
+
+	bool RasterPlacer::freeColumns(Sheet& sheet, const Mask& mask, size_t r, vector<uint64_t>& free) const {
+		// bit x of free says whether the mask fits with its left edge on column x
+		size_t words = sheet.cells.rowWords();
+		size_t positions = sheet.cells.width() - mask.cells.width() + 1;
+		for (size_t k = 0; k < words; k++) {
+			size_t from = k * 64;
+			if (from + 64 <= positions) {
+				free[k] = ~(uint64_t)0;
+			}
+			else {
+				free[k] = from < positions ? ((uint64_t)1 << (positions - from)) - 1 : 0;
+			}
+		}
+
+		// only the words which still have free positions are worked on
+		size_t first = 0, last = words;
+		for (size_t i = 0; i < mask.runs.size(); i++) {
+			for (const pair<size_t, size_t>& run : mask.runs[i]) {
+				// a run is blocked where the smear over the largest power of two within its length is
+				// set at its start or, shifted, at its end
+				size_t level = 0;
+				while (((size_t)2 << level) <= run.second) {
+					level++;
+				}
+				const uint64_t* smear = sheet.smear(r + i, level) + first;
+				andNotShiftedRight(free.data() + first, last - first, smear, words - first, run.first);
+				if (run.second > ((size_t)1 << level)) {
+					andNotShiftedRight(free.data() + first, last - first, smear, words - first, run.first + run.second - ((size_t)1 << level));
+				}
+			}
+			while (first < last && free[first] == 0) {
+				first++;
+			}
+			while (last > first && free[last - 1] == 0) {
+				last--;
+			}
+			if (first == last) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	NestingResult RasterPlacer::place(const vector<size_t>& order) {
+		NestingResult result;
+		size_t usable = (size_t)floor(sheetWidth / resolution + RASTER_EPSILON);
+		// the margin around the usable columns and below the first row lets the spacing of the parts
+		// at the sheet edges stick out
+		Sheet sheet(usable + 2 * margin);
+		vector<uint64_t> free(sheet.cells.rowWords());
+		Bitboard usableRow(sheet.cells.width(), 1);
+		usableRow.setSpan(0, margin, margin + usable);
+
+		for (size_t s : order) {
+			// a part too wide for the sheet in every orientation ends up above everything
+			bool found = false;
+			size_t bestOrientation = 0, bestColumn = 0, bestRow = sheet.cells.height(), bestTop = 0;
+
+			for (size_t o = 0; o < masks[s].size(); o++) {
+				const Mask& mask = masks[s][o];
+				size_t height = mask.cells.height();
+				if (mask.columns > usable) {
+					continue;
+				}
+
+				for (size_t r = sheet.filled; !found || r + height <= bestTop; r++) {
+					sheet.grow(r + height);
+					size_t blocked = height;
+					for (size_t i = 0; i < height && blocked == height; i++) {
+						if (sheet.gaps[r + i] < mask.widest[i]) {
+							blocked = i;
+						}
+					}
+					if (blocked < height) {
+						// no row of the part fits into that row, so skip every position overlapping it
+						if (sheet.gaps[r + blocked] < mask.narrowest) {
+							r += blocked;
+						}
+						continue;
+					}
+					if (!freeColumns(sheet, mask, r, free)) {
+						continue;
+					}
+
+					size_t k = 0;
+					while (free[k] == 0) {
+						k++;
+					}
+					size_t column = k * 64;
+					while (!((free[k] >> (column % 64)) & 1)) {
+						column++;
+					}
+					// lowest top edge first, then leftmost
+					if (!found || r + height < bestTop || (r + height == bestTop && column < bestColumn)) {
+						found = true;
+						bestOrientation = o;
+						bestColumn = column;
+						bestRow = r;
+						bestTop = r + height;
+					}
+					break;
+				}
+			}
+
+			const Mask& mask = masks[s][bestOrientation];
+			sheet.stamp(mask, bestColumn, bestRow, usableRow);
+
+			const BoundingBox& bb = shapes[s].orientations[bestOrientation].bounds;
+			ShapePlacement placement;
+			placement.shape = s;
+			placement.orientation = bestOrientation;
+			placement.position = point_t(bestColumn * resolution - (double)bb.minX, bestRow * resolution - (double)bb.minY);
+			result.placements.push_back(placement);
+			result.length = max(result.length, placement.position.y + (double)bb.maxY);
+		}
+		return result;
+	}
+
+}
@@ -0,0 +1,60 @@
+#ifndef _RASTER_PLACER_H_
+#define _RASTER_PLACER_H_
+
+#include "Bitboard.hpp"
+#include "BottomLeftPlacer.hpp"
+#include "Nester.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// sheet width in cells when no raster resolution is given
+	const double RASTER_AUTO_COLUMNS = 1024.0;
+
+	// Bottom-left placement on bitmaps instead of polygons, for a quick layout of large jobs.
+	// Every part is rasterized conservatively, grown by half the spacing, and placed at the lowest, then
+	// leftmost, cell where it shares no cell with the parts already on the sheet. For a candidate row
+	// all free columns are found at once with shifts and ands over whole words, after rows whose longest
+	// free gap is too short for the part have been skipped.
+	class RasterPlacer {
+		struct Mask {
+			Bitboard cells;
+			vector<vector<pair<size_t, size_t> > > runs;  // per row, (first column, length) of the set cells
+			vector<size_t> widest;                         // per row, the longest run
+			size_t narrowest;                              // the shortest of those
+			size_t columns;                                // of the part itself, without the spacing
+		};
+
+		// the occupied cells of the sheet plus what is derived from them per row
+		class Sheet {
+			size_t levels;
+			vector<uint64_t> smears;  // per row and level l, a cell is set when one of the 2^l cells from it on is
+			vector<bool> smeared;
+		public:
+			Bitboard cells;
+			vector<size_t> gaps;      // per row, the longest run of free cells
+			size_t filled;            // rows below are completely occupied
+
+			Sheet(size_t columns);
+			void grow(size_t rows);
+			const uint64_t* smear(size_t r, size_t level);
+			void stamp(const Mask& mask, size_t column, size_t r, const Bitboard& usable);
+		};
+
+		const vector<PartShape>& shapes;
+		double sheetWidth;
+		double resolution;
+		size_t margin;                 // cells added around every part for the spacing
+		vector<vector<Mask> > masks;   // per shape and orientation
+
+		bool freeColumns(Sheet& sheet, const Mask& mask, size_t r, vector<uint64_t>& free) const;
+	public:
+		RasterPlacer(const vector<PartShape>& shapes, double sheetWidth, double spacing, double resolution);
+
+		// order holds shape indices, every part is tried in all its orientations
+		NestingResult place(const vector<size_t>& order);
+	};
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "RectanglePacker.hpp"
+
+namespace nester {
+
+	const double RECTANGLE_TOLERANCE = 1e-9;
+
+	bool isNearlyRectangular(const PartShape& shape, double tolerance) {
+		const BoundingBox& bb = shape.orientations[0].bounds;
+		return shape.area >= (1.0 - tolerance) * (double)(bb.width() * bb.height());
+	}
+
+	RectanglePacker::RectanglePacker(const vector<PartShape>& shapes, double sheetWidth, double spacing) :
+		shapes(shapes), sheetWidth(sheetWidth), spacing(spacing) {}
+
+	bool RectanglePacker::contains(const Rectangle& outer, const Rectangle& inner) {
+		return inner.x >= outer.x - RECTANGLE_TOLERANCE && inner.y >= outer.y - RECTANGLE_TOLERANCE &&
+			inner.x + inner.width <= outer.x + outer.width + RECTANGLE_TOLERANCE &&
+			inner.y + inner.height <= outer.y + outer.height + RECTANGLE_TOLERANCE;
+	}
+
+	void RectanglePacker::split(const Rectangle& free, const Rectangle& used, vector<Rectangle>& pieces) {
+		// the up to four maximal rectangles of free which are left around used
+		if (used.x > free.x + RECTANGLE_TOLERANCE) {
+			pieces.push_back({ free.x, free.y, used.x - free.x, free.height });
+		}
+		if (used.x + used.width < free.x + free.width - RECTANGLE_TOLERANCE) {
+			pieces.push_back({ used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height });
+		}
+		if (used.y > free.y + RECTANGLE_TOLERANCE) {
+			pieces.push_back({ free.x, free.y, free.width, used.y - free.y });
+		}
+		if (used.y + used.height < free.y + free.height - RECTANGLE_TOLERANCE) {
+			pieces.push_back({ free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height });
+		}
+	}
+
+	NestingResult RectanglePacker::pack(const vector<size_t>& order) {
+		NestingResult result;
+		// every part claims its box plus the spacing above and to the right, so the sheet is one spacing
+		// wider for the last part of a row
+		vector<Rectangle> freeRectangles = { { 0.0, 0.0, sheetWidth + spacing, numeric_limits<double>::infinity() } };
+		double top = 0.0;
+
+		for (size_t s : order) {
+			const PartShape& shape = shapes[s];
+
+			// upright and turned by 90 degrees are the only distinct boxes
+			vector<size_t> candidates;
+			for (size_t o = 0; o < shape.orientations.size(); o++) {
+				double angle = fmod(shape.orientations[o].angle - shape.upright, 180.0);
+				if ((angle == 0.0 && candidates.empty()) || (fabs(angle - 90.0) < RECTANGLE_TOLERANCE && candidates.size() < 2)) {
+					candidates.push_back(o);
+				}
+			}
+
+			bool found = false;
+			size_t bestOrientation = candidates[0];
+			Rectangle used = { 0.0, top, 0.0, 0.0 };
+			for (size_t o : candidates) {
+				const BoundingBox& bb = shape.orientations[o].bounds;
+				double width = (double)bb.width() + spacing;
+				double height = (double)bb.height() + spacing;
+				for (const Rectangle& free : freeRectangles) {
+					if (free.width + RECTANGLE_TOLERANCE < width || free.height + RECTANGLE_TOLERANCE < height) {
+						continue;
+					}
+					double usedTop = used.y + used.height;
+					if (!found || free.y + height < usedTop - RECTANGLE_TOLERANCE ||
+						(free.y + height < usedTop + RECTANGLE_TOLERANCE && free.x < used.x)) {
+						found = true;
+						bestOrientation = o;
+						used = { free.x, free.y, width, height };
+					}
+				}
+			}
+			if (!found) {
+				// wider than the sheet either way: above everything else
+				const BoundingBox& bb = shape.orientations[bestOrientation].bounds;
+				used = { 0.0, top, (double)bb.width() + spacing, (double)bb.height() + spacing };
+			}
+
+			vector<Rectangle> remaining, pieces;
+			for (const Rectangle& free : freeRectangles) {
+				bool overlaps = used.x < free.x + free.width - RECTANGLE_TOLERANCE && used.x + used.width > free.x + RECTANGLE_TOLERANCE &&
+					used.y < free.y + free.height - RECTANGLE_TOLERANCE && used.y + used.height > free.y + RECTANGLE_TOLERANCE;
+				if (overlaps) {
+					split(free, used, pieces);
+				}
+				else {
+					remaining.push_back(free);
+				}
+			}
+			// the untouched rectangles were maximal before, so only the new pieces can be redundant
+			for (size_t i = 0; i < pieces.size(); i++) {
+				bool redundant = false;
+				for (size_t j = 0; j < remaining.size() && !redundant; j++) {
+					redundant = contains(remaining[j], pieces[i]);
+				}
+				for (size_t j = 0; j < pieces.size() && !redundant; j++) {
+					redundant = j != i && contains(pieces[j], pieces[i]) && (j < i || !contains(pieces[i], pieces[j]));
+				}
+				if (!redundant) {
+					remaining.push_back(pieces[i]);
+				}
+			}
+			freeRectangles.swap(remaining);
+
+			const BoundingBox& bb = shape.orientations[bestOrientation].bounds;
+			ShapePlacement placement;
+			placement.shape = s;
+			placement.orientation = bestOrientation;
+			placement.position = point_t(used.x - (double)bb.minX, used.y - (double)bb.minY);
+			result.placements.push_back(placement);
+			result.length = max(result.length, used.y + (double)bb.height());
+			top = max(top, used.y + used.height);
+		}
+		return result;
+	}
+
+}
@@ -0,0 +1,36 @@
+#ifndef _RECTANGLE_PACKER_H_
+#define _RECTANGLE_PACKER_H_
+
+#include "BottomLeftPlacer.hpp"
+#include "Nester.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// true when the outline covers all but the given fraction of its bounding box
+	bool isNearlyRectangular(const PartShape& shape, double tolerance);
+
+	// Packs parts by their bounding boxes with the MaxRects algorithm: the free space of the sheet is kept
+	// as the list of all maximal free rectangles, and each part goes to the lowest, then leftmost, corner
+	// of one which it fits. The sheet has a fixed width and grows along y. Parts are turned by 90 degrees
+	// when one of their orientations allows it.
+	class RectanglePacker {
+		struct Rectangle {
+			double x, y, width, height;
+		};
+
+		const vector<PartShape>& shapes;
+		double sheetWidth;
+		double spacing;
+
+		static bool contains(const Rectangle& outer, const Rectangle& inner);
+		static void split(const Rectangle& free, const Rectangle& used, vector<Rectangle>& pieces);
+	public:
+		RectanglePacker(const vector<PartShape>& shapes, double sheetWidth, double spacing);
+
+		NestingResult pack(const vector<size_t>& order);
+	};
+
+}
+
+#endif
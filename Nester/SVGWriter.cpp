@@ -1,7 +1,11 @@
+#include <cmath>
+
 #include "SVGWriter.hpp"
 
 namespace nester {
 
+	// user units per cm, path data has no units of its own
+	const double SVG_UNITS_PER_CM = 96.0 / 2.54;
 
 	SVGWriter::SVGWriter(string filename)
 	{
@@ -27,15 +31,48 @@ namespace nester {
 		out.close();
 	}
 
-	void SVGWriter::line(point_t p1, point_t p2, color_t color) {
-		string colorname = "purple";
-
+	string SVGWriter::colorName(color_t color) const {
 		auto search = colormap.find(color);
 		if (search != colormap.end()) {
-			colorname = search->second;
+			return search->second;
+		}
+		return "purple";
+	}
+
+	void SVGWriter::line(point_t p1, point_t p2, color_t color) {
+		out << "<line x1=\"" << p1.x << "cm\" y1=\"" << p1.y << "cm\" x2=\"" << p2.x << "cm\" y2=\"" << p2.y << "cm\" stroke=\"" << colorName(color) << "\" stroke-width=\"1\" />" << endl;
+	}
+
+	void SVGWriter::arc(point_t center, double radius, double startAngle, double endAngle, color_t color) {
+		double sweep = fmod(endAngle - startAngle, 360.0);
+		if (sweep <= 0.0) {
+			sweep += 360.0;
 		}
+		// in halves when longer than half the circle, so the large arc flag is always 0
+		int pieces = sweep > 180.0 ? 2 : 1;
+		auto at = [&](double angle) {
+			return (center + radius * point_t(cos(glm::radians(angle)), sin(glm::radians(angle)))) * SVG_UNITS_PER_CM;
+		};
+		point_t start = at(startAngle);
+		out << "<path d=\"M " << start.x << " " << start.y;
+		for (int k = 1; k <= pieces; k++) {
+			point_t end = at(startAngle + sweep * k / pieces);
+			// the sweep flag 1 turns towards growing angles
+			out << " A " << radius * SVG_UNITS_PER_CM << " " << radius * SVG_UNITS_PER_CM << " 0 0 1 " << end.x << " " << end.y;
+		}
+		out << "\" fill=\"none\" stroke=\"" << colorName(color) << "\" stroke-width=\"1\" />" << endl;
+	}
+
+	void SVGWriter::polyline(const polygon_t& points, color_t color) {
+		out << "<polyline points=\"";
+		for (size_t k = 0; k < points.size(); k++) {
+			out << (k == 0 ? "" : " ") << points[k].x * SVG_UNITS_PER_CM << "," << points[k].y * SVG_UNITS_PER_CM;
+		}
+		out << "\" fill=\"none\" stroke=\"" << colorName(color) << "\" stroke-width=\"1\" />" << endl;
+	}
 
-		out << "<line x1=\"" << p1.x << "cm\" y1=\"" << p1.y << "cm\" x2=\"" << p2.x << "cm\" y2=\"" << p2.y << "cm\" stroke=\"" << colorname << "\" stroke-width=\"1\" />" << endl;
+	void SVGWriter::circle(point_t center, double radius, color_t color) {
+		out << "<circle cx=\"" << center.x << "cm\" cy=\"" << center.y << "cm\" r=\"" << radius << "cm\" fill=\"none\" stroke=\"" << colorName(color) << "\" stroke-width=\"1\" />" << endl;
 	}
 
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ namespace nester {
 	{
 		ofstream out;
 		std::map<color_t, std::string> colormap;
+
+		string colorName(color_t color) const;
 	public:
 		SVGWriter(string filename);
 		virtual ~SVGWriter();
@@ -20,6 +22,9 @@ namespace nester {
 		void end();
 
 		virtual void line(point_t p1, point_t p2, color_t color = 0);
+		virtual void arc(point_t center, double radius, double startAngle, double endAngle, color_t color = 0);
+		virtual void circle(point_t center, double radius, color_t color = 0);
+		virtual void polyline(const polygon_t& points, color_t color = 0);
 	};
 
 }
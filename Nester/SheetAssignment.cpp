@@ -0,0 +1,77 @@
+#include <cmath>
+
+#include "Geometry.hpp"
+#include "SheetAssignment.hpp"
+
+namespace nester {
+
+	const double STOCK_TOLERANCE = 1e-9;
+
+	static bool fitsStock(const PartShape& shape, const StockSheet& sheet) {
+		for (const OrientedShape& o : shape.orientations) {
+			if ((double)o.bounds.width() <= sheet.width + STOCK_TOLERANCE && (double)o.bounds.height() <= sheet.height + STOCK_TOLERANCE) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static double stockArea(const StockSheet& sheet) {
+		if (!sheet.profile || !sheet.profile->toPolygon()) {
+			return sheet.width * sheet.height;
+		}
+		double area = fabs(signedArea(*sheet.profile->toPolygon()));
+		for (polygon_p hole : sheet.profile->toHolePolygons()) {
+			if (hole) {
+				area -= fabs(signedArea(*hole));
+			}
+		}
+		return area;
+	}
+
+	vector<SheetAssignment> assignSheets(const vector<PartShape>& shapes, const vector<size_t>& order, const vector<StockSheet>& stock,
+		vector<int>& remaining, double spacing, vector<size_t>& unassigned) {
+		vector<SheetAssignment> sheets;
+		vector<double> capacity;
+		for (const StockSheet& sheet : stock) {
+			capacity.push_back(STOCK_FILL_FACTOR * stockArea(sheet));
+		}
+
+		for (size_t s : order) {
+			const PartShape& shape = shapes[s];
+			// half the spacing around the outline belongs to the part
+			const BoundingBox& bb = shape.orientations[0].bounds;
+			double width = (double)bb.width();
+			double height = (double)bb.height();
+			double area = width > 0.0 && height > 0.0 ? shape.area * (width + spacing) * (height + spacing) / (width * height) : shape.area;
+
+			bool assigned = false;
+			for (SheetAssignment& sheet : sheets) {
+				if (sheet.area + area <= capacity[sheet.stock] && fitsStock(shape, stock[sheet.stock])) {
+					sheet.shapes.push_back(s);
+					sheet.area += area;
+					assigned = true;
+					break;
+				}
+			}
+			for (size_t k = 0; k < stock.size() && !assigned; k++) {
+				if (remaining[k] != 0 && fitsStock(shape, stock[k])) {
+					if (remaining[k] > 0) {
+						remaining[k]--;
+					}
+					SheetAssignment sheet;
+					sheet.stock = k;
+					sheet.shapes.push_back(s);
+					sheet.area = area;
+					sheets.push_back(sheet);
+					assigned = true;
+				}
+			}
+			if (!assigned) {
+				unassigned.push_back(s);
+			}
+		}
+		return sheets;
+	}
+
+}
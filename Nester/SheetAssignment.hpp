@@ -0,0 +1,28 @@
+#ifndef _SHEET_ASSIGNMENT_H_
+#define _SHEET_ASSIGNMENT_H_
+
+#include "Nester.hpp"
+#include "PartShape.hpp"
+
+namespace nester {
+
+	// share of a sheet's area the parts assigned to it may cover
+	const double STOCK_FILL_FACTOR = 0.85;
+
+	struct SheetAssignment {
+		size_t stock;           // index into the stock sizes
+		vector<size_t> shapes;  // in the order they were assigned
+		double area;            // of the assigned shapes, including their spacing
+	};
+
+	// Distributes shapes over stock sheets with first fit decreasing. Each shape of order, which should
+	// hold the largest first, goes to the first open sheet it fits with room left for its area. Failing
+	// that the next sheet of the first stock size it fits is opened. remaining holds the sheets left of
+	// each size, negative for any number, and is counted down. Shapes which fit no sheet that is left
+	// are appended to unassigned.
+	vector<SheetAssignment> assignSheets(const vector<PartShape>& shapes, const vector<size_t>& order, const vector<StockSheet>& stock,
+		vector<int>& remaining, double spacing, vector<size_t>& unassigned);
+
+}
+
+#endif
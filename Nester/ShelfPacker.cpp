@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <numeric>
+
+#include "ShelfPacker.hpp"
+
+namespace nester {
+
+	const double SHELF_TOLERANCE = 1e-9;
+
+	ShelfPacker::ShelfPacker(double sheetWidth, double spacing, ShelfHeuristic heuristic) :
+		sheetWidth(sheetWidth), spacing(spacing), heuristic(heuristic) {}
+
+	ShelfLayout ShelfPacker::pack(const vector<BoundingBox>& boxes) const {
+		ShelfLayout layout;
+		size_t n = boxes.size();
+		layout.placements.resize(n);
+
+		vector<double> widths(n), heights(n);
+		for (size_t i = 0; i < n; i++) {
+			double w = (double)boxes[i].width();
+			double h = (double)boxes[i].height();
+			// lying flat keeps the shelves low, standing up may be the only way to fit the sheet
+			bool rotated = h <= sheetWidth + SHELF_TOLERANCE && (h > w || w > sheetWidth + SHELF_TOLERANCE);
+			layout.placements[i].rotated = rotated;
+			widths[i] = rotated ? h : w;
+			heights[i] = rotated ? w : h;
+		}
+
+		vector<size_t> order(n);
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return heights[a] > heights[b] || (heights[a] == heights[b] && widths[a] > widths[b]);
+		});
+
+		// room left on each shelf, in a max tree whose leaves are the shelves from the bottom up
+		size_t leaves = 1;
+		while (leaves < n) {
+			leaves <<= 1;
+		}
+		vector<double> room(2 * leaves, -1.0);
+		vector<double> shelfY, shelfUsed;
+		double top = 0.0;
+
+		for (size_t i : order) {
+			double w = widths[i];
+			size_t shelf = shelfY.size();
+			if (heuristic == SHELF_FIRST_FIT) {
+				if (room[1] + SHELF_TOLERANCE >= w) {
+					size_t node = 1;
+					while (node < leaves) {
+						node = room[2 * node] + SHELF_TOLERANCE >= w ? 2 * node : 2 * node + 1;
+					}
+					shelf = node - leaves;
+				}
+			}
+			else if (!shelfY.empty() && room[leaves + shelfY.size() - 1] + SHELF_TOLERANCE >= w) {
+				shelf = shelfY.size() - 1;
+			}
+
+			// sorted by height, so a new shelf is as high as the box which opens it
+			if (shelf == shelfY.size()) {
+				shelfY.push_back(top);
+				shelfUsed.push_back(0.0);
+				top += heights[i] + spacing;
+			}
+
+			layout.placements[i].position = point_t(shelfUsed[shelf], shelfY[shelf]);
+			layout.length = max(layout.length, shelfY[shelf] + heights[i]);
+			shelfUsed[shelf] += w + spacing;
+
+			size_t node = leaves + shelf;
+			room[node] = sheetWidth - shelfUsed[shelf];
+			for (node /= 2; node >= 1; node /= 2) {
+				room[node] = max(room[2 * node], room[2 * node + 1]);
+			}
+		}
+		return layout;
+	}
+
+}
@@ -0,0 +1,35 @@
+#ifndef _SHELF_PACKER_H_
+#define _SHELF_PACKER_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	struct ShelfPlacement {
+		point_t position;  // of the lower left corner of the box on the sheet
+		bool rotated;      // the box is turned by 90 degrees
+	};
+
+	struct ShelfLayout {
+		vector<ShelfPlacement> placements;  // in the order of the boxes
+		double length;
+
+		ShelfLayout() : length(0.0) {}
+	};
+
+	// Packs bounding boxes into rows (shelves) across a sheet of fixed width, each shelf as high as its
+	// first box. Boxes are turned to lie flat when that still fits the sheet. The first fit search uses a
+	// max tree over the room left on each shelf, so both heuristics run in O(n log n).
+	class ShelfPacker {
+		double sheetWidth;
+		double spacing;
+		ShelfHeuristic heuristic;
+	public:
+		ShelfPacker(double sheetWidth, double spacing, ShelfHeuristic heuristic);
+
+		ShelfLayout pack(const vector<BoundingBox>& boxes) const;
+	};
+
+}
+
+#endif
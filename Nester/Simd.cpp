@@ -0,0 +1,35 @@
+#include "Simd.hpp"
+
+#if defined(NESTER_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace nester {
+
+#ifdef NESTER_AVX2
+	static bool detectAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		bool osSaves = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		if (!osSaves) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+#endif
+
+	bool hasAvx2() {
+#ifdef NESTER_AVX2
+		static const bool supported = detectAvx2();
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+}
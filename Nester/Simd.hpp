@@ -0,0 +1,23 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+// AVX2 kernels are compiled on x86-64 unless NESTER_NO_SIMD is defined, and only called when the
+// processor supports them. Functions using AVX2 intrinsics are marked with AVX2_TARGET.
+#if !defined(NESTER_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define NESTER_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace nester {
+
+	// false without NESTER_AVX2
+	bool hasAvx2();
+
+}
+
+#endif
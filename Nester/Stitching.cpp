@@ -0,0 +1,143 @@
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include "Stitching.hpp"
+
+namespace nester {
+
+	// the grid cells of a zero tolerance (cm)
+	const double STITCH_MINIMUM_CELL = 1e-9;
+
+	namespace {
+
+		struct EndGrid {
+			double cell;
+			unordered_map<unsigned long long, vector<size_t> > cells;
+
+			explicit EndGrid(double cell) : cell(cell) {}
+
+			unsigned long long key(long long x, long long y) const {
+				return (unsigned long long)x * 0x9E3779B97F4A7C15ULL ^ (unsigned long long)y;
+			}
+
+			void insert(point_t p, size_t end) {
+				cells[key((long long)floor(p.x / cell), (long long)floor(p.y / cell))].push_back(end);
+			}
+
+			// the ends in the cell of p and the eight around it
+			template<typename F>
+			void near(point_t p, F visit) const {
+				long long x = (long long)floor(p.x / cell), y = (long long)floor(p.y / cell);
+				for (long long dx = -1; dx <= 1; dx++) {
+					for (long long dy = -1; dy <= 1; dy++) {
+						auto found = cells.find(key(x + dx, y + dy));
+						if (found != cells.end()) {
+							for (size_t end : found->second) {
+								visit(end);
+							}
+						}
+					}
+				}
+			}
+		};
+
+		size_t root(vector<size_t>& parent, size_t i) {
+			while (parent[i] != i) {
+				parent[i] = parent[parent[i]];
+				i = parent[i];
+			}
+			return i;
+		}
+
+	}
+
+	StitchedRing stitchStrokes(const vector<polygon_t>& strokes, double tolerance) {
+		StitchedRing result;
+		vector<size_t> used;
+		for (size_t s = 0; s < strokes.size(); s++) {
+			if (strokes[s].size() >= 2) {
+				used.push_back(s);
+			}
+		}
+		if (used.empty()) {
+			return result;
+		}
+
+		// end 2 * k is the first point of stroke used[k], end 2 * k + 1 its last
+		size_t n = used.size();
+		auto endPoint = [&](size_t end) {
+			const polygon_t& stroke = strokes[used[end / 2]];
+			return end % 2 == 0 ? stroke.front() : stroke.back();
+		};
+
+		// ends within tolerance of each other form one point
+		EndGrid grid(max(tolerance, STITCH_MINIMUM_CELL));
+		for (size_t end = 0; end < 2 * n; end++) {
+			grid.insert(endPoint(end), end);
+		}
+		vector<size_t> parent(2 * n);
+		iota(parent.begin(), parent.end(), 0);
+		for (size_t end = 0; end < 2 * n; end++) {
+			point_t p = endPoint(end);
+			grid.near(p, [&](size_t other) {
+				if (glm::distance(p, endPoint(other)) <= tolerance) {
+					parent[root(parent, end)] = root(parent, other);
+				}
+			});
+		}
+		unordered_map<size_t, vector<size_t> > joints;
+		for (size_t end = 0; end < 2 * n; end++) {
+			joints[root(parent, end)].push_back(end);
+		}
+
+		vector<bool> done(n, false);
+		auto append = [&](size_t end, bool skipFirst) {
+			// walks the stroke away from end
+			const polygon_t& stroke = strokes[used[end / 2]];
+			size_t first = skipFirst ? 1 : 0;
+			result.order.push_back({ used[end / 2], end % 2 == 1 });
+			for (size_t k = first; k < stroke.size(); k++) {
+				result.ring.push_back(end % 2 == 0 ? stroke[k] : stroke[stroke.size() - 1 - k]);
+			}
+			done[end / 2] = true;
+			return end ^ 1;
+		};
+
+		size_t cursor = append(0, false);
+		for (size_t remaining = n - 1; remaining > 0; remaining--) {
+			size_t next = numeric_limits<size_t>::max();
+			for (size_t end : joints[root(parent, cursor)]) {
+				if (!done[end / 2]) {
+					next = end;
+					break;
+				}
+			}
+			bool joined = next != numeric_limits<size_t>::max();
+			if (!joined) {
+				// nothing continues here, so jump to the nearest free end
+				point_t from = endPoint(cursor);
+				double nearest = numeric_limits<double>::infinity();
+				for (size_t end = 0; end < 2 * n; end++) {
+					double d = glm::distance(from, endPoint(end));
+					if (!done[end / 2] && d < nearest) {
+						nearest = d;
+						next = end;
+					}
+				}
+				result.gaps.push_back({ from, endPoint(next) });
+			}
+			cursor = append(next, joined);
+		}
+
+		if (root(parent, cursor) == root(parent, 0)) {
+			result.ring.pop_back();
+		}
+		else {
+			result.gaps.push_back({ endPoint(cursor), endPoint(0) });
+		}
+		return result;
+	}
+
+}
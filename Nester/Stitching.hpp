@@ -0,0 +1,33 @@
+#ifndef _STITCHING_H_
+#define _STITCHING_H_
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// Where the strokes of a loop did not meet, and the ring was closed with a straight line
+	struct StitchGap {
+		point_t from, to;
+	};
+
+	// A stroke as it comes in the ring
+	struct StitchedStroke {
+		size_t stroke;
+		bool reversed;
+	};
+
+	struct StitchedRing {
+		polygon_t ring;  // without the first point repeated at the end
+		vector<StitchedStroke> order;
+		vector<StitchGap> gaps;
+	};
+
+	// Joins the strokes of the edges of one loop, given in any order and running either way, into one
+	// ordered ring. Ends closer than tolerance are the same point; they are found through a hash grid
+	// with cells as large as the tolerance. Where no stroke continues, the nearest free end is taken and
+	// the gap is reported, as is a ring which does not close.
+	StitchedRing stitchStrokes(const vector<polygon_t>& strokes, double tolerance);
+
+}
+
+#endif
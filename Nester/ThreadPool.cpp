@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+namespace nester {
+
+	ThreadPool::ThreadPool(size_t threads) : queued(0), unfinished(0), nextQueue(0), sleeping(0), stopping(false) {
+		if (threads == 0) {
+			threads = max(1u, thread::hardware_concurrency());
+		}
+		for (size_t i = 0; i < threads; i++) {
+			queues.push_back(unique_ptr<Queue>(new Queue()));
+		}
+		for (size_t i = 0; i < threads; i++) {
+			workers.push_back(thread(&ThreadPool::work, this, i));
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			lock_guard<mutex> guard(lock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (thread& t : workers) {
+			t.join();
+		}
+	}
+
+	size_t ThreadPool::size() const {
+		return workers.size();
+	}
+
+	void ThreadPool::submit(function<void()> task) {
+		size_t target = nextQueue++ % queues.size();
+		unfinished++;
+		{
+			lock_guard<mutex> guard(queues[target]->lock);
+			queues[target]->tasks.push_back(move(task));
+		}
+		queued++;
+		// a worker which goes to sleep counts itself before it looks at queued, so either it sees the
+		// task or we see it sleeping
+		if (sleeping > 0) {
+			lock_guard<mutex> guard(lock);
+			wake.notify_one();
+		}
+	}
+
+	bool ThreadPool::reserve() {
+		size_t count = queued;
+		while (count > 0) {
+			if (queued.compare_exchange_weak(count, count - 1)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ThreadPool::take(size_t worker, function<void()>& task) {
+		{
+			Queue& own = *queues[worker];
+			lock_guard<mutex> guard(own.lock);
+			if (!own.tasks.empty()) {
+				task = move(own.tasks.back());
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+		for (size_t i = 1; i < queues.size(); i++) {
+			Queue& victim = *queues[(worker + i) % queues.size()];
+			lock_guard<mutex> guard(victim.lock);
+			if (!victim.tasks.empty()) {
+				task = move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::work(size_t worker) {
+		for (;;) {
+			if (!reserve()) {
+				unique_lock<mutex> guard(lock);
+				sleeping++;
+				wake.wait(guard, [this] { return stopping || queued > 0; });
+				sleeping--;
+				if (stopping && queued == 0) {
+					return;
+				}
+				continue;
+			}
+
+			// a task is reserved for us, but while we look the others may take the one we would have found
+			function<void()> task;
+			while (!take(worker, task)) {
+				this_thread::yield();
+			}
+
+			try {
+				task();
+			}
+			catch (...) {
+				lock_guard<mutex> guard(lock);
+				if (!failure) {
+					failure = current_exception();
+				}
+			}
+
+			if (--unfinished == 0) {
+				lock_guard<mutex> guard(lock);
+				done.notify_all();
+			}
+		}
+	}
+
+	void ThreadPool::wait() {
+		unique_lock<mutex> guard(lock);
+		done.wait(guard, [this] { return unfinished == 0; });
+		if (failure) {
+			exception_ptr e = failure;
+			failure = nullptr;
+			rethrow_exception(e);
+		}
+	}
+
+}
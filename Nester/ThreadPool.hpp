@@ -0,0 +1,55 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Nester.hpp"
+
+namespace nester {
+
+	// A fixed set of worker threads with one task queue each. Workers take tasks from the back of
+	// their own queue and steal from the front of the others' when they run dry. The counters are
+	// atomic, the pool's own lock is only taken to put idle workers to sleep, wake them up and wait.
+	class ThreadPool {
+		struct Queue {
+			mutex lock;
+			deque<function<void()> > tasks;
+		};
+
+		vector<unique_ptr<Queue> > queues;
+		vector<thread> workers;
+
+		mutex lock;
+		condition_variable wake;
+		condition_variable done;
+		atomic<size_t> queued;      // submitted but not yet reserved by a worker
+		atomic<size_t> unfinished;  // submitted but not yet finished
+		atomic<size_t> nextQueue;
+		atomic<size_t> sleeping;    // workers waiting for a task
+		bool stopping;
+		exception_ptr failure;
+
+		bool reserve();
+		bool take(size_t worker, function<void()>& task);
+		void work(size_t worker);
+	public:
+		// 0 threads uses one per hardware thread
+		explicit ThreadPool(size_t threads = 0);
+		~ThreadPool();
+
+		size_t size() const;
+		void submit(function<void()> task);
+
+		// blocks until every submitted task has finished, rethrows the first exception a task threw
+		void wait();
+	};
+
+}
+
+#endif